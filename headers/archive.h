@@ -0,0 +1,61 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include "snapshot.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* store for large numbers of snapshots that mostly agree with each other.
+ * Snapshots are cut into ARCHIVE_CHUNK_SIZE byte chunks and every distinct
+ * chunk is kept once. The chunk numbers of a snapshot are chunked and shared
+ * the same way, so a stored state itself is only ARCHIVE_GROUPS chunk
+ * numbers. Not thread safe, give every thread its own archive or lock it */
+typedef struct _m6502_archive m6502_archive_t;
+
+#define ARCHIVE_CHUNK_SIZE 64
+#define ARCHIVE_CHUNKS                                                         \
+  ((sizeof(m6502_snapshot_t) + ARCHIVE_CHUNK_SIZE - 1) / ARCHIVE_CHUNK_SIZE)
+/* chunk numbers that fit in one chunk */
+#define ARCHIVE_GROUP_SIZE (ARCHIVE_CHUNK_SIZE / sizeof(uint32_t))
+#define ARCHIVE_GROUPS                                                         \
+  ((ARCHIVE_CHUNKS + ARCHIVE_GROUP_SIZE - 1) / ARCHIVE_GROUP_SIZE)
+
+/* returned by m6502_archive_insert when it ran out of memory */
+#define ARCHIVE_NONE UINT32_MAX
+
+typedef struct {
+  size_t states;
+  size_t chunks; /* distinct chunks, data and chunk number groups */
+  size_t bytes;  /* everything the archive has allocated */
+} m6502_archive_stats_t;
+
+M6502_API m6502_archive_t *m6502_archive_create(void);
+M6502_API void m6502_archive_destroy(m6502_archive_t *archive);
+
+/**
+   @return id of the stored state, ids of evicted states are handed out
+   again, ARCHIVE_NONE if memory ran out
+*/
+M6502_API uint32_t m6502_archive_insert(m6502_archive_t *archive,
+                                        const m6502_snapshot_t *snapshot);
+
+/**
+   @return false if `id` is not a stored state
+*/
+M6502_API bool m6502_archive_restore(const m6502_archive_t *archive,
+                                     uint32_t id, m6502_snapshot_t *snapshot);
+
+/**
+   @brief drops a state, chunks no other state uses are freed
+*/
+M6502_API void m6502_archive_evict(m6502_archive_t *archive, uint32_t id);
+
+M6502_API void m6502_archive_stats(const m6502_archive_t *archive,
+                                   m6502_archive_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+#endif /* ARCHIVE_H */
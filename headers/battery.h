@@ -0,0 +1,30 @@
+#ifndef BATTERY_H
+#define BATTERY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* battery backed prg ram, lives directly in a shared mapping of the save file
+ * so every write the guest does ends up in the file without a save step */
+typedef struct _battery battery_t;
+
+/**
+   @brief maps the .sav file next to the rom, creating it if it doesn't exist,
+   and starts a thread that periodically flushes it to disk
+   @param rom_path path to the rom the save belongs to
+   @param size size of the prg ram in bytes
+   @return NULL if the save file could not be mapped
+*/
+extern battery_t *open_battery(const char *const rom_path, size_t size);
+
+/**
+   @brief the memory the guest should use as prg ram
+*/
+extern uint8_t *battery_memory(battery_t *battery);
+
+/**
+   @brief stops the flush thread, does a final synchronous flush and unmaps
+   the save file
+*/
+extern void close_battery(battery_t *battery);
+#endif /* BATTERY_H */
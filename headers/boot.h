@@ -0,0 +1,38 @@
+#ifndef BOOT_H
+#define BOOT_H
+
+#include "snapshot.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* runs that all go through the same boot frames can share the state at
+ * their end through a directory of save states. An entry is named after
+ * the rom, the state booted from, the boot input and the build of the core,
+ * so a rebuilt core never picks up states an older one left behind */
+
+/**
+   @brief identifies the build of the core, cmake derives it from the core
+   sources, the compiler and the options that change the core
+*/
+M6502_API const char *m6502_build_id(void);
+
+/**
+   @brief runs `frames` frames, frame i with `input[i]` on the controller (0
+   past `input_size`), or loads the state they end in from `directory` when
+   an earlier run left it there. Otherwise the state is stored there for the
+   next run. Watchpoints are not checked and nothing is logged or frame
+   hashed during the boot, those would only show on the runs that miss
+   @param directory NULL to always run the frames
+   @return SUCCESS, or the error that stopped the boot, nothing is stored
+   then
+*/
+M6502_API int m6502_boot(processor_t *processor, const uint8_t *input,
+                         size_t input_size, size_t frames,
+                         const char *directory);
+
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+#endif /* BOOT_H */
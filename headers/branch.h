@@ -0,0 +1,38 @@
+#ifndef BRANCH_H
+#define BRANCH_H
+
+#include "cpu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   @brief runs in the child of one branch on its own copy of the instance
+   @param branch which of the branches this is
+   @param result result_size bytes sent back to the parent
+   @return false if the branch failed
+*/
+typedef bool (*m6502_branch_task)(processor_t *processor, size_t branch,
+                                  void *context, void *result);
+
+/**
+   @brief forks a child per branch, the children share the instance copy on
+   write with the parent so branching costs no copying up front. Every child
+   is detached (@see m6502_detach) before the task runs so it can't write to
+   the parent's save file or shared memory
+   @param results count * result_size bytes, branch i is written at
+   i * result_size
+   @param ok NULL or one flag per branch, set if that branch succeeded
+   @param max_children most children alive at once, 0 for no limit
+   @return how many branches succeeded
+*/
+M6502_API size_t m6502_branch(processor_t *processor, size_t count,
+                              m6502_branch_task task, void *context,
+                              void *results, size_t result_size, bool *ok,
+                              unsigned max_children);
+
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+#endif /* BRANCH_H */
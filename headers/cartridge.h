@@ -2,6 +2,9 @@
 #define CARTRIDGE_H
 
 #include <stdint.h>
+
+enum cartridge_flags { FLAGS6_BATTERY = 0x2 };
+
 typedef struct {
   _Bool nes2;
   union {
@@ -0,0 +1,29 @@
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+   @brief most bytes compress_bytes can write for `size` input bytes
+*/
+extern size_t compress_bound(size_t size);
+
+/**
+   @brief fast lz77 compression made for emulator state, long zero runs and
+   repeated tables shrink to a few bytes, nothing else is attempted
+   @param destination at least compress_bound(size) bytes
+   @return compressed size
+*/
+extern size_t compress_bytes(const void *source, size_t size,
+                             uint8_t *destination);
+
+/**
+   @brief undoes compress_bytes, the input is checked so a damaged blob is
+   refused instead of overrunning either buffer
+   @return false unless exactly `size` bytes were decoded
+*/
+extern bool decompress_bytes(const uint8_t *source, size_t source_size,
+                             void *destination, size_t size);
+#endif /* COMPRESS_H */
@@ -7,10 +7,23 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "cartridge.h"
+#ifdef M6502_PROFILE
+#include "profile.h"
+#endif
 
+/* everything marked with this is exported from libm6502, the rest of the core
+ * is hidden */
+#if defined(_WIN32) || defined(WIN32)
+#define M6502_API __declspec(dllexport)
+#elif defined(__GNUC__)
+#define M6502_API __attribute__((visibility("default")))
+#else
+#define M6502_API
+#endif
 
 /* this is for editing processor status */
 typedef enum _6502_flags {
@@ -32,10 +45,47 @@ enum m6502constants {
   TEST_REGISTERS_SIZE = 0x8,
   ROM_MEMORY_SIZE = 0xbfe0,
   TOTAL_MEMORY_SIZE = RAM_SIZE + PPU_REGISTERS_SIZE + APU_REGISTERS_SIZE +
-                      TEST_REGISTERS_SIZE + ROM_MEMORY_SIZE
+                      TEST_REGISTERS_SIZE + ROM_MEMORY_SIZE,
+  INTERNAL_RAM_SIZE = 0x800,
+  PPU_REGISTERS_START = 0x2000,
+  PRG_RAM_START = 0x6000,
+  PRG_RAM_SIZE = 0x2000,
+  PRG_ROM_START = 0x8000,
+  PRG_ROM_WINDOW = 0x8000,
+  BUS_PAGE_SIZE = 0x100,
+  BUS_PAGES = 0x100,
+  OAM_ADDR = 0x2003,
+  IO_REGISTERS_START = 0x4000,
+  OAM_DMA = 0x4014,
+  CONTROLLER_1 = 0x4016,
+  OAM_SIZE = 0x100,
+  OAM_DMA_CYCLES = 513,
+  MAX_WATCHPOINTS = 16,
+  FRAME_CYCLES = 29781 /* ntsc, 341 * 262 / 3 rounded */
 };
 
-enum error_codes6502 { SUCCESS, STACK_OVERFLOW, STACK_UNDERFLOW };
+/* bits of the byte given to m6502_set_controller */
+enum controller_buttons {
+  BUTTON_A = 0x1 << 0,
+  BUTTON_B = 0x1 << 1,
+  BUTTON_SELECT = 0x1 << 2,
+  BUTTON_START = 0x1 << 3,
+  BUTTON_UP = 0x1 << 4,
+  BUTTON_DOWN = 0x1 << 5,
+  BUTTON_LEFT = 0x1 << 6,
+  BUTTON_RIGHT = 0x1 << 7
+};
+
+enum error_codes6502 {
+  SUCCESS,
+  STACK_OVERFLOW,
+  STACK_UNDERFLOW,
+  WATCHPOINT_HIT,
+  INVALID_OPCODE,
+  HALTED
+};
+
+enum watch_kind { WATCH_READ = 0x1, WATCH_WRITE = 0x2 };
 
 typedef struct _processor_registers {
   uint16_t pc;
@@ -57,20 +107,201 @@ typedef struct _processor_registers {
   };
 } registers_t;
 
+typedef struct {
+  uint16_t address; /* the address that was accessed */
+  uint16_t pc;      /* start of the instruction that did the access */
+  uint8_t kind;     /* WATCH_READ or WATCH_WRITE */
+  uint8_t value;    /* the value read or the value being written */
+  unsigned long long clock_ticks; /* clock at the start of the instruction */
+} watch_hit_t;
+
+typedef struct {
+  uint16_t address;
+  uint8_t kind;
+} watchpoint_t;
+
+/* one emulator instance, everything the core needs lives in here so any number
+ * of them can be run side by side */
 typedef struct __processor {
   uint8_t memory[TOTAL_MEMORY_SIZE + 1];
+  /* one pointer per 256 byte page of the address space, mirrors and prg ram
+   * are resolved when the table is built so an access is a single lookup */
+  uint8_t *pages[BUS_PAGES];
+  /* what the cpu actually reads and writes through, the same as `pages`
+   * except that pages with a watchpoint in them and the io registers are NULL
+   * which sends the access down the slow path */
+  uint8_t *read_pages[BUS_PAGES];
+  uint8_t *write_pages[BUS_PAGES];
+  uint8_t oam[OAM_SIZE]; /* ppu sprite memory, filled through $4014 */
   registers_t registers;
   unsigned long long clock_ticks;
+  unsigned long long frame;     /* frames completed since the reset */
+  unsigned long long frame_end; /* clock_ticks the current frame ends at */
+
+  int error; /* error_codes6502, anything but SUCCESS stops m6502_run */
+  size_t rom_size;
+
+  /* where the instruction being executed started, for reporting */
+  uint16_t instruction_pc;
+  unsigned long long instruction_ticks;
+
+  uint8_t controller;       /* buttons currently held, controller_buttons */
+  uint8_t controller_shift; /* what $4016 reads next, bit 0 first */
+  bool controller_strobe;
+  bool controller_polled; /* $4016 was read during the current frame */
+  bool lag_frame;         /* the last completed frame never read it */
+
+  watchpoint_t watchpoints[MAX_WATCHPOINTS];
+  size_t watchpoint_count;
+  watch_hit_t watch_hit;
+
+  struct _battery *battery; /* NULL unless the cart has battery backed ram */
+  FILE *log;                /* instruction trace, NULL when not logging */
+  struct _shared_export *shared; /* @see shared.h, NULL when not exported */
+  struct _frame_hasher *hasher;  /* @see framehash.h, NULL when not hashing */
+  struct _persist *persist;      /* @see persist.h, NULL when not persisting */
+
+#ifdef M6502_UNINIT_CHECK
+  /* one bit per byte of internal ram followed by prg ram, set once the byte
+   * has been written, 1.25k so it stays in l1 next to the ram itself */
+  uint8_t written[(INTERNAL_RAM_SIZE + PRG_RAM_SIZE) / 8];
+  bool uninitialised_read;
+  uint16_t uninitialised_address;
+  uint16_t uninitialised_pc;
+#endif
+#ifdef M6502_PROFILE
+  access_profile_t profile;
+#endif
 } processor_t;
 
-extern void interpret_opcode(void);
+/**
+   @brief loads the rom at `rom_path` into a new instance and resets it, a
+   battery backed cart gets its save file mapped
+   @return NULL if the rom could not be loaded
+*/
+M6502_API processor_t *m6502_create(const char *rom_path);
+
+/**
+   @brief like m6502_create but a battery backed cart gets plain prg ram, its
+   save file is neither created, read nor written. For batch jobs and other
+   instances that run side by side and must not share or depend on the save
+   @return NULL if the rom could not be loaded
+*/
+M6502_API processor_t *m6502_create_headless(const char *rom_path);
+
+/**
+   @brief flushes the save file and the trace log and frees the instance
+*/
+M6502_API void m6502_destroy(processor_t *processor);
+
+/**
+   @brief puts the instance back in its power on state, the rom and battery
+   backed ram are kept
+*/
+M6502_API void m6502_reset(processor_t *processor);
+
+/**
+   @brief cuts the instance loose from everything it shares with other
+   processes, battery backed ram becomes private memory with the same
+   contents and the shared memory export, the log, the frame hashing and the
+   persisted state file are dropped without closing them. For forked copies
+   that must not touch the parent's files
+*/
+M6502_API void m6502_detach(processor_t *processor);
+
+/**
+   @brief a copy of the instance in its current state that shares nothing
+   with it, detached like m6502_detach, free it with m6502_destroy
+   @return NULL if out of memory
+*/
+M6502_API processor_t *m6502_clone(const processor_t *processor);
+
+/**
+   @brief runs instructions until `cycles` cycles have passed or something
+   stops it, the instruction that stopped it is completed
+   @return SUCCESS if the cycles ran out, otherwise one of error_codes6502,
+   WATCHPOINT_HIT can be resumed by calling m6502_run again
+*/
+M6502_API int m6502_run(processor_t *processor, unsigned long long cycles);
+
+/**
+   @brief runs until `frames` more frames have ended
+   @return same as m6502_run
+*/
+M6502_API int m6502_run_frames(processor_t *processor, unsigned frames);
+
+/**
+   @brief runs a single instruction
+   @return same as m6502_run
+*/
+M6502_API int m6502_step(processor_t *processor);
+
+M6502_API const char *m6502_strerror(int error);
+
+/**
+   @brief reads `address` without any side effects, watchpoints, profiling or
+   io registers, for observers of a running instance
+*/
+M6502_API uint8_t m6502_peek(const processor_t *processor, uint16_t address);
+
+/**
+   @brief sets the buttons held on the first controller, the game sees them
+   the next time it strobes $4016
+   @param buttons or'd controller_buttons
+*/
+M6502_API void m6502_set_controller(processor_t *processor, uint8_t buttons);
+
+/**
+   @return true if the last completed frame never read $4016, a lag frame
+   in which the game did not look at the buttons
+*/
+M6502_API bool m6502_lag_frame(const processor_t *processor);
+
+/**
+   @brief starts writing a trace line per instruction to `path`, NULL picks
+   m6502.log for debug builds and a timestamped name otherwise
+*/
+M6502_API bool m6502_open_log(processor_t *processor, const char *path);
 
 /**
-   @brief initializes the cpu, sets all of the memory addresses to 0xff
-   @param cart the cartridge 
+   @brief stops m6502_run when `address` (or any of its mirrors) is accessed
+   @param kind WATCH_READ, WATCH_WRITE or both
+   @return false if all MAX_WATCHPOINTS are in use
 */
-extern void initialize_cpu(cartridge_t *cart);
-extern bool initialize_cpu_filename(char *path);
+M6502_API bool m6502_add_watchpoint(processor_t *processor, uint16_t address,
+                                    int kind);
+M6502_API void m6502_remove_watchpoint(processor_t *processor,
+                                       uint16_t address);
+
+/**
+   @brief the watchpoint hit that stopped the last m6502_run
+   @return false if the last run wasn't stopped by a watchpoint
+*/
+M6502_API bool m6502_get_watch_hit(const processor_t *processor,
+                                   watch_hit_t *hit);
+
+#ifdef M6502_UNINIT_CHECK
+/**
+   @brief the first read of internal ram or prg ram that was never written,
+   every such byte is also reported on stderr the first time it's read
+   @return false if there hasn't been one
+*/
+M6502_API bool m6502_first_uninitialised_read(const processor_t *processor,
+                                              uint16_t *address, uint16_t *pc);
+#endif
+
+#ifdef M6502_PROFILE
+/* only in the profiling bus (cpu_profile), @see profile.h */
+M6502_API void m6502_reset_access_profile(processor_t *processor);
+
+/**
+   @brief writes the access counters to `path`, as a binary heatmap if the name
+   ends in .bin otherwise as csv. Call it once per frame followed by
+   m6502_reset_access_profile() for per frame heatmaps
+*/
+M6502_API bool m6502_dump_access_profile(const processor_t *processor,
+                                         const char *path);
+#endif
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,29 @@
+#ifndef DELTA_H
+#define DELTA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* a state stored as its xor against another one, 8 bytes at a time: pairs
+ * of varints, unchanged words to skip and changed words to follow, then the
+ * changed words xored. Working on whole words keeps the xor and the zero
+ * test in loops the compiler vectorizes */
+
+/* most bytes delta_encode can write for `words` words */
+#define DELTA_BOUND(words) ((words) * (sizeof(uint64_t) + 2 * 3))
+
+/**
+   @param base NULL to store `state` against all zeros
+   @param out at least DELTA_BOUND(words) bytes
+   @return bytes written
+*/
+extern size_t delta_encode(const uint64_t *state, const uint64_t *base,
+                           size_t words, uint8_t *out);
+
+/**
+   @brief xors a delta into `state`, turning the base into the state it was
+   made from and back
+*/
+extern void delta_apply(uint64_t *state, size_t words, const uint8_t *in,
+                        size_t size);
+#endif /* DELTA_H */
@@ -0,0 +1,74 @@
+#ifndef ENV_H
+#define ENV_H
+
+#include "cpu.h"
+#include "memo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* a batch of instances of the same rom stepped together, for driving the
+ * emulator as a reinforcement learning environment. Every step runs all the
+ * instances across a pool of worker threads and returns once all of them are
+ * done */
+typedef struct _m6502_env m6502_env_t;
+
+typedef struct {
+  /* little endian counter, the reward of a step is how much it changed,
+   * reward_bytes 0 gives no rewards */
+  uint16_t reward_address;
+  uint8_t reward_bytes; /* 1 to 4 */
+
+  /* an instance is done once (ram[done_address] & done_mask) == done_value,
+   * or when the cpu stops on an error. done_mask 0 only ends on errors */
+  uint16_t done_address;
+  uint8_t done_mask;
+  uint8_t done_value;
+
+  bool auto_reset; /* reset done instances at the end of the step */
+} m6502_env_config_t;
+
+/**
+   @brief creates `count` headless instances of the rom, see
+   m6502_create_headless
+   @param workers threads to step them on, 0 for one per core
+   @return NULL if the rom could not be loaded
+*/
+M6502_API m6502_env_t *m6502_env_create(const char *rom_path, size_t count,
+                                        const m6502_env_config_t *config,
+                                        unsigned workers);
+M6502_API void m6502_env_destroy(m6502_env_t *env);
+
+M6502_API size_t m6502_env_count(const m6502_env_t *env);
+
+/**
+   @brief runs the frames of every step through `memo`, for rollouts that
+   keep going over the same states. The caller owns it and reads the hit
+   rate from it, NULL goes back to emulating every frame
+*/
+M6502_API void m6502_env_set_memo(m6502_env_t *env, m6502_memo_t *memo);
+
+/**
+   @brief resets every instance
+   @param ram NULL or count * INTERNAL_RAM_SIZE bytes to copy the internal ram
+   of every instance into
+*/
+M6502_API void m6502_env_reset(m6502_env_t *env, uint8_t *ram);
+
+/**
+   @brief holds actions[i] (controller_buttons) on instance i for `frames`
+   frames, an instance that finishes stops early. Any of the output arrays can
+   be NULL, otherwise they hold one entry per instance
+   @param actions NULL for no buttons
+   @param ram count * INTERNAL_RAM_SIZE bytes, the internal ram after the step
+   (after the reset for instances that were auto reset)
+*/
+M6502_API void m6502_env_step(m6502_env_t *env, const uint8_t *actions,
+                              unsigned frames, float *rewards, uint8_t *dones,
+                              uint8_t *ram);
+
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+#endif /* ENV_H */
@@ -0,0 +1,47 @@
+#ifndef FRAMEHASH_H
+#define FRAMEHASH_H
+
+#include <stdio.h>
+
+#include "cpu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* a fingerprint of the machine state taken at the end of every frame, for
+ * finding where two runs of the same inputs went apart. It covers the cpu
+ * registers, internal ram, prg ram, ppu and io registers, oam and the
+ * controller, the same bytes as m6502_snapshot_hash but hashed in 256 byte
+ * blocks: only blocks that changed since the last frame are hashed again
+ * and the frame hash is made from the block hashes. It depends on nothing
+ * but the state, so it can be compared between builds, threads and hosts
+ * of the same byte order. Costs about half a percent of a frame */
+
+/**
+   @brief starts hashing every frame of `processor`, the current state is
+   hashed right away
+   @param log NULL or where to write a `frame <n> <hash>` line per frame,
+   left open by the instance
+   @return false if out of memory
+*/
+M6502_API bool m6502_hash_frames(processor_t *processor, FILE *log);
+M6502_API void m6502_stop_hashing(processor_t *processor);
+
+/**
+   @brief the hash of the state at the end of the last frame
+   @return false if `processor` isn't hashing frames
+*/
+M6502_API bool m6502_frame_hash(const processor_t *processor, uint64_t *hash);
+
+/* the core side, called at the end of every frame */
+typedef struct _frame_hasher frame_hasher_t;
+
+extern void update_frame_hash(frame_hasher_t *hasher,
+                              const processor_t *processor);
+extern void close_frame_hasher(frame_hasher_t *hasher);
+
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+#endif /* FRAMEHASH_H */
@@ -0,0 +1,19 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+   @brief a fast non cryptographic 64 bit hash, 8 bytes per step, only meant
+   for telling states apart inside one process
+*/
+extern uint64_t hash_bytes(const void *data, size_t size, uint64_t seed);
+
+/**
+   @brief like hash_bytes but 32 bytes a step in four independent lanes,
+   several times faster on inputs of a few hundred bytes and up. The two
+   give different hashes for the same bytes
+*/
+extern uint64_t hash_lanes(const void *data, size_t size, uint64_t seed);
+#endif /* HASH_H */
@@ -0,0 +1,14 @@
+#ifndef INPUTS_H
+#define INPUTS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+   @brief reads a controller input file, one controller_buttons byte per
+   frame
+   @param frames set to how many frames the file holds
+   @return NULL if the file could not be read, free() it
+*/
+extern uint8_t *read_inputs(const char *path, size_t *frames);
+#endif /* INPUTS_H */
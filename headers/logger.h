@@ -3,9 +3,14 @@
 
 #include "cpu.h"
 
-void log_cpu(processor_t p);
-void init_log(void);
-void close_log(void);
+/**
+   @brief opens the instruction log of `processor`
+   @param path file to log to, NULL picks a name from the current time
+   @return false if the file could not be opened
+*/
+bool init_log(processor_t *processor, const char *path);
+void log_cpu(const processor_t *processor);
+void close_log(processor_t *processor);
 
 
 #endif /* LOGGER_H */
@@ -0,0 +1,52 @@
+#ifndef MEMO_H
+#define MEMO_H
+
+#include "snapshot.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* cache of frames already emulated, for search and replay workloads that run
+ * the same frames from the same state again and again. An entry is keyed by
+ * the hash of the state with the buttons held (the clock and frame count
+ * left out, where the clock is in its frame and its parity kept in) and
+ * stores what the frames changed, xored over the start state, so a hit costs
+ * a hash and a few copies instead of the emulation. The least recently used
+ * entries go once the memory is used up. One cache can be shared by
+ * instances on any number of threads, lookups and inserts are serialised by
+ * a lock.
+ *
+ * Only frames that end without an error are stored. Instances with a log,
+ * frame hasher, persistent file, shared export or watchpoints always run for
+ * real, as do the profiling and uninit check builds, a hit would skip what
+ * they observe */
+typedef struct _m6502_memo m6502_memo_t;
+
+typedef struct {
+  unsigned long long hits;
+  unsigned long long misses; /* of those that could be cached */
+  unsigned long long evictions;
+  size_t entries;
+  size_t memory; /* bytes in use, entries and the table */
+} m6502_memo_stats_t;
+
+/**
+   @param memory most bytes to keep entries in
+*/
+M6502_API m6502_memo_t *m6502_memo_create(size_t memory);
+M6502_API void m6502_memo_destroy(m6502_memo_t *memo);
+
+/**
+   @brief m6502_set_controller then m6502_run_frames, from the cache when the
+   same frames were run from the same state before
+*/
+M6502_API int m6502_memo_run_frames(m6502_memo_t *memo, processor_t *processor,
+                                    uint8_t buttons, unsigned frames);
+
+M6502_API void m6502_memo_stats(m6502_memo_t *memo, m6502_memo_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+#endif /* MEMO_H */
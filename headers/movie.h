@@ -0,0 +1,70 @@
+#ifndef MOVIE_H
+#define MOVIE_H
+
+#include "cpu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MOVIE_VERSION 1
+
+/* the controller input of a run from power on, one byte per frame, with the
+ * frames that never read the controller marked as lag frames. Playing it
+ * back only needs the rom, the emulation never looks at the clock, so it
+ * runs as fast as the host allows and ends in the same state every time.
+ * Record and play on instances from m6502_create_headless, their battery
+ * backed ram starts out blank on reset. With the save mapped in a run starts
+ * from whatever the save holds and changes it for the next one */
+typedef struct {
+  uint64_t rom_hash;
+  uint8_t *inputs; /* controller_buttons per frame */
+  uint8_t *lag;    /* 1 for lag frames */
+  size_t count;
+  size_t capacity;
+  /* m6502_snapshot_hash of the state the recording ended in, checked by the
+   * playback */
+  uint64_t end_hash;
+} m6502_movie_t;
+
+/**
+   @brief resets `processor` and starts an empty movie of its rom
+*/
+M6502_API void m6502_start_movie(m6502_movie_t *movie, processor_t *processor);
+
+/**
+   @brief runs one frame with `buttons` held and adds it to the movie
+   @return false if the frame did not finish, processor->error says why
+   unless it is SUCCESS, then the movie could not grow. Nothing is added
+*/
+M6502_API bool m6502_record_frame(m6502_movie_t *movie, processor_t *processor,
+                                  uint8_t buttons);
+
+/**
+   @brief resets `processor` and runs every frame of the movie
+   @param desync set to the first frame whose lag marker differs from the
+   recording, to the last frame if only the end state does and to
+   movie->count if the playback matched
+   @return SUCCESS or the error that stopped the playback
+*/
+M6502_API int m6502_play_movie(const m6502_movie_t *movie,
+                               processor_t *processor, size_t *desync);
+
+/**
+   @return false if `processor` runs another rom than the movie was made on
+*/
+M6502_API bool m6502_movie_matches(const m6502_movie_t *movie,
+                                   const processor_t *processor);
+
+/* the file is a header ("M6MV", u16 version, u16 reserved, u64 rom hash,
+ * u64 end hash, u64 frame count) followed by runs of equal frames, each a
+ * varint of the run length shifted left once with the lag flag below it,
+ * then the buttons byte. All little endian */
+M6502_API bool m6502_save_movie(const m6502_movie_t *movie, const char *path);
+M6502_API bool m6502_load_movie(const char *path, m6502_movie_t *movie);
+M6502_API void m6502_free_movie(m6502_movie_t *movie);
+
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+#endif /* MOVIE_H */
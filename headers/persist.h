@@ -0,0 +1,48 @@
+#ifndef PERSIST_H
+#define PERSIST_H
+
+#include "snapshot.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PERSIST_MAGIC "M6PS"
+#define PERSIST_VERSION 1
+
+/* keeps the state of a running instance in a shared mapping of a file, so a
+ * process that crashes or is killed can be resumed from the last frame it
+ * completed. The file holds two state slots and a frame marker: at the end
+ * of every frame the state goes into the slot the marker doesn't name, and
+ * only then is the marker moved to it, so the marked slot is always a
+ * whole frame. There is no save step and nothing waits for the disk, the
+ * kernel writes the mapping back on its own and once more when the
+ * instance is destroyed. Every slot carries a checksum, a slot the kernel
+ * only got half way through writing before the machine went down is
+ * passed over for the older one */
+
+/**
+   @brief maps `path`, creating it if needed, and writes the state of
+   `processor` to it now and at the end of every frame from now on
+   @return false if the file could not be mapped
+*/
+M6502_API bool m6502_persist(processor_t *processor, const char *path);
+
+/**
+   @brief loads the last complete frame of `path` into `processor`, call
+   m6502_persist afterwards to keep going in the same file
+   @return false if the file is missing, from another rom or holds no
+   complete frame, `processor` is left alone then
+*/
+M6502_API bool m6502_resume(processor_t *processor, const char *path);
+
+/* the core side, called at the end of every frame */
+typedef struct _persist persist_t;
+
+extern void persist_frame(persist_t *persist, const processor_t *processor);
+extern void close_persist(persist_t *persist);
+
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+#endif /* PERSIST_H */
@@ -0,0 +1,39 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* a fixed set of worker threads that run parallel for loops, every worker
+ * starts on its own slice of the indices and steals from the others once it
+ * runs out so uneven jobs still keep every core busy */
+typedef struct _pool pool_t;
+
+/**
+   @brief one iteration of pool_run
+   @param worker which worker runs it, 0 is the thread that called pool_run
+*/
+typedef void (*pool_task)(void *context, size_t index, unsigned worker);
+
+/**
+   @brief starts `workers - 1` threads, the caller of pool_run is the last one
+   @param workers 0 for one per online core
+   @param pin pin every thread to its own core
+   @return NULL if the threads could not be started
+*/
+extern pool_t *pool_create(unsigned workers, bool pin);
+
+extern unsigned pool_size(const pool_t *pool);
+
+/**
+   @brief calls `task` for every index in [0, count) and returns once all of
+   them have finished, count has to fit in 32 bits
+*/
+extern void pool_run(pool_t *pool, size_t count, pool_task task,
+                     void *context);
+
+/**
+   @brief stops and joins the threads
+*/
+extern void pool_destroy(pool_t *pool);
+#endif /* POOL_H */
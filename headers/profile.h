@@ -0,0 +1,37 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* only the zero page and the stack get per byte counters */
+enum profile_constants { PROFILE_PAGES = 0x100, PROFILE_BYTES = 0x200 };
+
+/* memory access counters, only filled in by the profiling bus (the cpu_profile
+ * library, built with M6502_PROFILE), the normal bus doesn't count anything */
+typedef struct _access_profile {
+  uint64_t reads[PROFILE_PAGES];
+  uint64_t writes[PROFILE_PAGES];
+  uint64_t executes[PROFILE_PAGES]; /* opcode and operand fetches */
+#ifdef M6502_PROFILE_BYTES
+  uint64_t byte_reads[PROFILE_BYTES];
+  uint64_t byte_writes[PROFILE_BYTES];
+  uint64_t byte_executes[PROFILE_BYTES];
+#endif
+} access_profile_t;
+
+/**
+   @brief writes the counters as csv, one `page,...` row per page followed by
+   one `byte,...` row per zero page/stack byte if those are counted
+*/
+extern bool write_profile_csv(const access_profile_t *profile, FILE *fp);
+
+/**
+   @brief writes the counters as a binary heatmap: the magic "M6HP", a version
+   byte, a byte telling if per byte counters follow, two bytes of padding and
+   then the counter arrays as little endian 64 bit integers in the order they
+   appear in access_profile_t
+*/
+extern bool write_profile_binary(const access_profile_t *profile, FILE *fp);
+#endif /* PROFILE_H */
@@ -0,0 +1,48 @@
+#ifndef REWIND_H
+#define REWIND_H
+
+#include "snapshot.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ring of the last states, one pushed per frame. Each state is kept as the
+ * xor against the one before it with the unchanged 8 byte words left out,
+ * every keyframe_interval states one is kept whole so the oldest states
+ * can be dropped without losing the rest. When the memory is used up the
+ * oldest keyframe and the states after it are dropped together */
+typedef struct _m6502_rewind m6502_rewind_t;
+
+/**
+   @param memory bytes for the stored states
+   @param keyframe_interval states per keyframe, 0 for 60
+*/
+M6502_API m6502_rewind_t *m6502_rewind_create(size_t memory,
+                                              unsigned keyframe_interval);
+M6502_API void m6502_rewind_destroy(m6502_rewind_t *rewind);
+
+/**
+   @brief adds the state of the frame that just ended
+   @return false if a single state does not fit in the memory
+*/
+M6502_API bool m6502_rewind_push(m6502_rewind_t *rewind,
+                                 const m6502_snapshot_t *snapshot);
+
+/**
+   @brief drops the newest state and writes the one before it to
+   `snapshot`, load it with m6502_load_snapshot to go back one frame
+   @return false if there is no older state
+*/
+M6502_API bool m6502_rewind_step_back(m6502_rewind_t *rewind,
+                                      m6502_snapshot_t *snapshot);
+
+/**
+   @return states held, the newest included
+*/
+M6502_API size_t m6502_rewind_count(const m6502_rewind_t *rewind);
+
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+#endif /* REWIND_H */
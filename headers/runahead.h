@@ -0,0 +1,28 @@
+#ifndef RUNAHEAD_H
+#define RUNAHEAD_H
+
+#include "snapshot.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   @brief runs one frame for real, then `frames` more with the same input
+   to see where it leads and goes back to the real one. The speculative
+   frames are not logged, frame hashed, persisted or stopped by watchpoints,
+   the shared memory export shows the frame ahead instead of the real one,
+   so whatever presents it reacts to input `frames` frames sooner. Battery
+   backed ram is written by the speculative frames and put back afterwards
+   @param ahead NULL or set to the state `frames` frames ahead, the one to
+   present
+   @return same as m6502_run_frames for the real frame, when it doesn't
+   finish nothing is run ahead
+*/
+M6502_API int m6502_run_ahead(processor_t *processor, unsigned frames,
+                              m6502_snapshot_t *ahead);
+
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+#endif /* RUNAHEAD_H */
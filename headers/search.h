@@ -0,0 +1,60 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "cpu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* (ram[address] & mask) == value */
+typedef struct {
+  uint16_t address;
+  uint8_t mask;
+  uint8_t value;
+} m6502_condition_t;
+
+typedef struct {
+  const uint8_t *alphabet; /* controller bytes tried at every step */
+  size_t alphabet_size;
+  unsigned frames_per_step; /* how long each input is held */
+  unsigned max_depth;       /* steps before giving up */
+  /* states kept per step, the ones with the highest score win. 0 keeps every
+   * new state which makes it a plain breadth first search */
+  size_t beam_width;
+
+  const m6502_condition_t *goal; /* all of them have to hold */
+  size_t goal_count;
+
+  /* little endian counter to rank states by, higher is better, score_bytes 0
+   * keeps the states in the order they were found */
+  uint16_t score_address;
+  uint8_t score_bytes;
+
+  unsigned workers; /* 0 for one per core */
+} m6502_search_config_t;
+
+typedef struct {
+  bool found;
+  uint8_t *inputs; /* one alphabet entry per step, free() it */
+  size_t length;
+  unsigned long long expanded;   /* states emulated */
+  unsigned long long duplicates; /* of those, states that were seen before */
+} m6502_search_result_t;
+
+/**
+   @brief searches for the shortest input sequence (in steps) that takes
+   `start` from its current state to one where the goal holds. Every step
+   expands all the states of the previous one with every input of the
+   alphabet in parallel, states that were already visited are dropped
+   @return false if the search could not be set up, not finding anything is
+   result->found == false
+*/
+M6502_API bool m6502_search(const processor_t *start,
+                            const m6502_search_config_t *config,
+                            m6502_search_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+#endif /* SEARCH_H */
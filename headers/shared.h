@@ -0,0 +1,77 @@
+#ifndef SHARED_H
+#define SHARED_H
+
+#include <stdatomic.h>
+#include <string.h>
+
+#include "cpu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SHARED_MAGIC "M6SM"
+#define SHARED_VERSION 1
+
+/* the layout of an exported instance, other processes map it read only and
+ * use m6502_shared_snapshot to get a consistent copy. The emulator rewrites it
+ * at the end of every frame, `sequence` is odd while it's doing that */
+typedef struct {
+  char magic[4];
+  uint32_t version;
+  _Atomic uint32_t sequence;
+  uint32_t reserved;
+  uint64_t frame;
+  uint64_t clock_ticks;
+  uint8_t ram[INTERNAL_RAM_SIZE];
+  uint8_t prg_ram[PRG_RAM_SIZE];
+  uint8_t oam[OAM_SIZE];
+} m6502_shared_t;
+
+/**
+   @brief exports `processor` into shared memory, published once per frame
+   @param name shm_open name like /m6502-game, NULL for an anonymous memfd
+   that can be handed to other processes with m6502_shared_fd
+*/
+M6502_API bool m6502_share(processor_t *processor, const char *name);
+
+/**
+   @return the descriptor of the shared region, -1 if it isn't shared
+*/
+M6502_API int m6502_shared_fd(const processor_t *processor);
+
+/**
+   @brief maps an exported instance read only, for the observing side
+   @return NULL if there's no such region or it isn't one of ours
+*/
+M6502_API const m6502_shared_t *m6502_shared_map(const char *name);
+M6502_API void m6502_shared_unmap(const m6502_shared_t *shared);
+
+/**
+   @brief copies the last complete frame out of `shared`, retrying while the
+   emulator is in the middle of publishing one
+*/
+static inline void m6502_shared_snapshot(const m6502_shared_t *shared,
+                                         m6502_shared_t *copy) {
+  uint32_t before, after;
+  do {
+    before = atomic_load_explicit(&shared->sequence, memory_order_acquire);
+    memcpy(copy, shared, sizeof(*copy));
+    atomic_thread_fence(memory_order_acquire);
+    after = atomic_load_explicit(&shared->sequence, memory_order_relaxed);
+  } while ((before & 1) || before != after);
+}
+
+/* the emulator side, called by the core */
+typedef struct _shared_export shared_export_t;
+
+extern shared_export_t *open_shared(const char *name);
+extern void publish_shared(shared_export_t *shared,
+                           const processor_t *processor);
+extern int shared_fd(const shared_export_t *shared);
+extern void close_shared(shared_export_t *shared);
+
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+#endif /* SHARED_H */
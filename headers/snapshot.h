@@ -0,0 +1,61 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stddef.h>
+
+#include "cpu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* everything the guest can change, the rom is left out as it never does.
+ * Plain bytes without padding so snapshots can be compared and hashed as
+ * memory, only meaningful to the build that made them */
+typedef struct {
+  uint8_t ram[INTERNAL_RAM_SIZE];
+  uint8_t ppu_registers[BUS_PAGE_SIZE];
+  uint8_t io_registers[BUS_PAGE_SIZE];
+  uint8_t prg_ram[PRG_RAM_SIZE];
+  uint8_t oam[OAM_SIZE];
+  uint16_t pc;
+  uint8_t sp, x, y, accumulator, status;
+  uint8_t controller, controller_shift, controller_strobe;
+  uint8_t controller_polled, lag_frame;
+  uint8_t reserved[4];
+
+  /* not part of the hash, the same state reached at another time is still
+   * the same state */
+  int32_t error;
+  uint32_t reserved2;
+  uint64_t clock_ticks;
+  uint64_t frame;
+  uint64_t frame_end;
+} m6502_snapshot_t;
+
+/* the part of m6502_snapshot_t that m6502_snapshot_hash covers */
+#define SNAPSHOT_STATE_SIZE offsetof(m6502_snapshot_t, error)
+
+M6502_API void m6502_save_snapshot(const processor_t *processor,
+                                   m6502_snapshot_t *snapshot);
+
+/**
+   @brief puts `processor` in the state of `snapshot`, watchpoints, the log
+   and the rom are left alone
+*/
+M6502_API void m6502_load_snapshot(processor_t *processor,
+                                   const m6502_snapshot_t *snapshot);
+
+/**
+   @brief hash of the machine state, the clock and frame count are left out
+*/
+M6502_API uint64_t m6502_snapshot_hash(const m6502_snapshot_t *snapshot);
+
+/* the core side, fills in everything from `pc` on and leaves the memory */
+extern void save_snapshot_registers(const processor_t *processor,
+                                    m6502_snapshot_t *snapshot);
+
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+#endif /* SNAPSHOT_H */
@@ -0,0 +1,80 @@
+#ifndef STATE_H
+#define STATE_H
+
+#include "snapshot.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* save state files. Unlike m6502_snapshot_t, which is a plain in memory
+ * copy, the file is portable between builds: a versioned header followed by
+ * tagged chunks (cpu registers, timing, ram, ppu and io registers, prg ram,
+ * oam, controller, lag flags), each stored raw or lz compressed, all little
+ * endian. Readers skip chunks they don't know so newer files stay loadable
+ * as long as the version is not raised */
+
+#define STATE_VERSION 1
+
+/**
+   @brief writes `snapshot` to `path` through a temporary file that is
+   synced and renamed over it, so `path` always holds a complete state
+*/
+M6502_API bool m6502_write_state(const m6502_snapshot_t *snapshot,
+                                 const char *path);
+
+/**
+   @return false if the file is missing, damaged, from a newer version or
+   lacks a chunk, `snapshot` is left alone then
+*/
+M6502_API bool m6502_read_state(const char *path, m6502_snapshot_t *snapshot);
+
+/**
+   @brief m6502_write_state with up to 4k of the caller's own bytes in a
+   chunk of their own, for what it needs to pick up with the state (input
+   position, log offsets). They are stored as they are, byte order and all,
+   and skipped by m6502_read_state
+*/
+M6502_API bool m6502_write_state_extra(const m6502_snapshot_t *snapshot,
+                                       const void *extra, size_t extra_size,
+                                       const char *path);
+
+/**
+   @param extra_size the room in `extra`, set to the size stored
+   @return false as well if the file has no extra bytes or they don't fit
+*/
+M6502_API bool m6502_read_state_extra(const char *path,
+                                      m6502_snapshot_t *snapshot, void *extra,
+                                      size_t *extra_size);
+
+/* writes states on a thread of its own so the caller only pays for
+ * m6502_save_snapshot and a copy */
+typedef struct _m6502_state_writer m6502_state_writer_t;
+
+M6502_API m6502_state_writer_t *m6502_state_writer_create(void);
+
+/**
+   @brief queues `snapshot` to be written to `path`. A state still queued for
+   the same path is replaced, otherwise this only waits when the queue is
+   full of other paths, never for the write itself
+   @return false if a queued state was replaced
+*/
+M6502_API bool m6502_state_writer_submit(m6502_state_writer_t *writer,
+                                         const m6502_snapshot_t *snapshot,
+                                         const char *path);
+
+/**
+   @brief waits until everything queued is on disk
+   @return false if a write failed since the last flush
+*/
+M6502_API bool m6502_state_writer_flush(m6502_state_writer_t *writer);
+
+/**
+   @brief flushes and stops the thread
+*/
+M6502_API void m6502_state_writer_destroy(m6502_state_writer_t *writer);
+
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+#endif /* STATE_H */
@@ -1,6 +1,15 @@
 #ifndef GUI_H
 #define GUI_H
 
-extern _Bool setup_ppu(void);
-extern void free_ui(void);
+#include "../cpu.h"
+
+/* window and ppu state of one emulator instance */
+typedef struct _ui ui_t;
+
+/**
+   @brief opens the window for `processor`
+   @return NULL if sdl could not be initialised
+*/
+extern ui_t *setup_ppu(processor_t *processor);
+extern void free_ui(ui_t *ui);
 #endif /* GUI_H */
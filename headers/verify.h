@@ -0,0 +1,54 @@
+#ifndef VERIFY_H
+#define VERIFY_H
+
+#include "snapshot.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* states of one run taken every `interval` frames, the segments between two
+ * of them can be replayed independently of each other */
+typedef struct {
+  m6502_snapshot_t *snapshots;
+  uint64_t *hashes; /* of the whole snapshot, clock included */
+  size_t count;
+  unsigned interval;
+} m6502_checkpoints_t;
+
+/**
+   @brief runs `frames` frames from the current state, taking a checkpoint at
+   the start, every `interval` frames and at the end (or where the cpu
+   stopped)
+   @param inputs controller byte per frame, indexed by processor->frame, no
+   buttons after the last one
+*/
+M6502_API bool m6502_record_checkpoints(processor_t *processor,
+                                        const uint8_t *inputs,
+                                        size_t input_count,
+                                        unsigned long long frames,
+                                        unsigned interval,
+                                        m6502_checkpoints_t *checkpoints);
+
+/**
+   @brief replays every segment from its starting checkpoint on all cores and
+   checks that it ends in the state of the next one
+   @param model instance of the rom, cloned for every worker
+   @param segment_ok NULL or count - 1 flags
+   @return how many segments did not match
+*/
+M6502_API size_t m6502_verify_checkpoints(
+    const processor_t *model, const m6502_checkpoints_t *checkpoints,
+    const uint8_t *inputs, size_t input_count, unsigned workers,
+    bool *segment_ok);
+
+M6502_API bool m6502_save_checkpoints(const m6502_checkpoints_t *checkpoints,
+                                      const char *path);
+M6502_API bool m6502_load_checkpoints(const char *path,
+                                      m6502_checkpoints_t *checkpoints);
+M6502_API void m6502_free_checkpoints(m6502_checkpoints_t *checkpoints);
+
+#ifdef __cplusplus
+}
+#endif //__cplusplus
+#endif /* VERIFY_H */
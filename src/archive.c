@@ -0,0 +1,319 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../headers/archive.h"
+#include "../headers/hash.h"
+
+/* most new chunks one insert can need */
+#define INSERT_CHUNKS (ARCHIVE_CHUNKS + ARCHIVE_GROUPS)
+
+struct _m6502_archive {
+  /* chunk i is data[i * ARCHIVE_CHUNK_SIZE], free chunks have no references
+   * and keep the number of the next free chunk in their first 4 bytes */
+  uint8_t *data;
+  uint64_t *hashes;
+  uint32_t *references;
+  /* 1 for chunks of chunk numbers. A group can hold the same bytes as a data
+   * chunk (16 references to chunk 0 are 64 zero bytes), the two are kept
+   * apart so their references never mix */
+  uint8_t *groups;
+  uint32_t chunk_count; /* ever handed out, free ones included */
+  uint32_t chunk_capacity;
+  uint32_t free_chunk; /* ARCHIVE_NONE when there is none */
+  size_t live_chunks;
+
+  /* linear probing over the live chunks, chunk number + 1 or 0 if empty */
+  uint32_t *slots;
+  size_t slot_mask;
+
+  /* root groups of every state, evicted states start with ARCHIVE_NONE and
+   * keep the next evicted state in their second entry */
+  uint32_t (*states)[ARCHIVE_GROUPS];
+  uint32_t state_count;
+  uint32_t state_capacity;
+  uint32_t free_state;
+  size_t live_states;
+};
+
+static uint8_t *chunk_data(const m6502_archive_t *archive, uint32_t chunk) {
+  return archive->data + (size_t)chunk * ARCHIVE_CHUNK_SIZE;
+}
+
+static size_t find_slot(const m6502_archive_t *archive, const uint8_t *chunk,
+                        uint64_t hash, bool group) {
+  size_t mask = archive->slot_mask;
+  for (size_t i = hash & mask;; i = (i + 1) & mask) {
+    uint32_t entry = archive->slots[i];
+    if (entry == 0 || (archive->hashes[entry - 1] == hash &&
+                       archive->groups[entry - 1] == group &&
+                       memcmp(chunk_data(archive, entry - 1), chunk,
+                              ARCHIVE_CHUNK_SIZE) == 0)) {
+      return i;
+    }
+  }
+}
+
+/* backward shift deletion, keeps every probe sequence unbroken without
+ * tombstones */
+static void remove_slot(m6502_archive_t *archive, size_t slot) {
+  for (size_t next = (slot + 1) & archive->slot_mask;
+       archive->slots[next] != 0; next = (next + 1) & archive->slot_mask) {
+    size_t home =
+        archive->hashes[archive->slots[next] - 1] & archive->slot_mask;
+    /* entries whose home lies cyclically in (slot, next] stay put */
+    bool stays = slot < next ? home > slot && home <= next
+                             : home > slot || home <= next;
+    if (!stays) {
+      archive->slots[slot] = archive->slots[next];
+      slot = next;
+    }
+  }
+  archive->slots[slot] = 0;
+}
+
+static bool grow_slots(m6502_archive_t *archive, size_t capacity) {
+  uint32_t *slots = calloc(capacity, sizeof(uint32_t));
+  if (slots == NULL) {
+    return false;
+  }
+  free(archive->slots);
+  archive->slots = slots;
+  archive->slot_mask = capacity - 1;
+  for (uint32_t chunk = 0; chunk < archive->chunk_count; chunk++) {
+    if (archive->references[chunk] != 0) {
+      size_t i = archive->hashes[chunk] & archive->slot_mask;
+      while (slots[i] != 0) {
+        i = (i + 1) & archive->slot_mask;
+      }
+      slots[i] = chunk + 1;
+    }
+  }
+  return true;
+}
+
+static bool grow_chunks(m6502_archive_t *archive, uint32_t capacity) {
+  uint8_t *data = realloc(archive->data, (size_t)capacity * ARCHIVE_CHUNK_SIZE);
+  if (data == NULL) {
+    return false;
+  }
+  archive->data = data;
+  uint64_t *hashes = realloc(archive->hashes, capacity * sizeof(uint64_t));
+  if (hashes == NULL) {
+    return false;
+  }
+  archive->hashes = hashes;
+  uint32_t *references =
+      realloc(archive->references, capacity * sizeof(uint32_t));
+  if (references == NULL) {
+    return false;
+  }
+  archive->references = references;
+  uint8_t *groups = realloc(archive->groups, capacity);
+  if (groups == NULL) {
+    return false;
+  }
+  archive->groups = groups;
+  archive->chunk_capacity = capacity;
+  return true;
+}
+
+/* makes room for one more state up front so an insert never fails half
+ * way through */
+static bool reserve(m6502_archive_t *archive) {
+  if (archive->chunk_capacity - archive->chunk_count < INSERT_CHUNKS &&
+      !grow_chunks(archive, archive->chunk_capacity * 2 + INSERT_CHUNKS)) {
+    return false;
+  }
+  size_t slots = archive->slot_mask + 1;
+  if ((archive->live_chunks + INSERT_CHUNKS) * 2 > slots &&
+      !grow_slots(archive, slots * 2)) {
+    return false;
+  }
+  if (archive->free_state == ARCHIVE_NONE &&
+      archive->state_count == archive->state_capacity) {
+    uint32_t capacity = archive->state_capacity ? archive->state_capacity * 2
+                                                : 1024;
+    void *states =
+        realloc(archive->states, capacity * sizeof(*archive->states));
+    if (states == NULL) {
+      return false;
+    }
+    archive->states = states;
+    archive->state_capacity = capacity;
+  }
+  return true;
+}
+
+/* takes a reference to the chunk holding `bytes`, adding it if it is new */
+static uint32_t intern(m6502_archive_t *archive, const uint8_t *bytes,
+                       bool group, bool *created) {
+  uint64_t hash = hash_bytes(bytes, ARCHIVE_CHUNK_SIZE, group);
+  size_t slot = find_slot(archive, bytes, hash, group);
+  *created = archive->slots[slot] == 0;
+  if (!*created) {
+    uint32_t chunk = archive->slots[slot] - 1;
+    archive->references[chunk]++;
+    return chunk;
+  }
+
+  uint32_t chunk = archive->free_chunk;
+  if (chunk != ARCHIVE_NONE) {
+    memcpy(&archive->free_chunk, chunk_data(archive, chunk), sizeof(uint32_t));
+  } else {
+    chunk = archive->chunk_count++;
+  }
+  memcpy(chunk_data(archive, chunk), bytes, ARCHIVE_CHUNK_SIZE);
+  archive->hashes[chunk] = hash;
+  archive->references[chunk] = 1;
+  archive->groups[chunk] = group;
+  archive->slots[slot] = chunk + 1;
+  archive->live_chunks++;
+  return chunk;
+}
+
+/* @return true if that was the last reference and the chunk is free now */
+static bool release(m6502_archive_t *archive, uint32_t chunk) {
+  if (--archive->references[chunk] > 0) {
+    return false;
+  }
+  remove_slot(archive,
+              find_slot(archive, chunk_data(archive, chunk),
+                        archive->hashes[chunk], archive->groups[chunk]));
+  memcpy(chunk_data(archive, chunk), &archive->free_chunk, sizeof(uint32_t));
+  archive->free_chunk = chunk;
+  archive->live_chunks--;
+  return true;
+}
+
+static size_t group_length(size_t group) {
+  size_t first = group * ARCHIVE_GROUP_SIZE;
+  return ARCHIVE_CHUNKS - first < ARCHIVE_GROUP_SIZE ? ARCHIVE_CHUNKS - first
+                                                     : ARCHIVE_GROUP_SIZE;
+}
+
+extern m6502_archive_t *m6502_archive_create(void) {
+  m6502_archive_t *archive = calloc(1, sizeof(m6502_archive_t));
+  if (archive == NULL) {
+    return NULL;
+  }
+  archive->free_chunk = ARCHIVE_NONE;
+  archive->free_state = ARCHIVE_NONE;
+  if (!grow_chunks(archive, 4 * INSERT_CHUNKS) || !grow_slots(archive, 1024)) {
+    m6502_archive_destroy(archive);
+    return NULL;
+  }
+  return archive;
+}
+
+extern void m6502_archive_destroy(m6502_archive_t *archive) {
+  if (archive == NULL) {
+    return;
+  }
+  free(archive->data);
+  free(archive->hashes);
+  free(archive->references);
+  free(archive->groups);
+  free(archive->slots);
+  free(archive->states);
+  free(archive);
+}
+
+extern uint32_t m6502_archive_insert(m6502_archive_t *archive,
+                                     const m6502_snapshot_t *snapshot) {
+  if (!reserve(archive)) {
+    return ARCHIVE_NONE;
+  }
+  uint32_t id = archive->free_state;
+  if (id != ARCHIVE_NONE) {
+    archive->free_state = archive->states[id][1];
+  } else {
+    id = archive->state_count++;
+  }
+
+  const uint8_t *bytes = (const uint8_t *)snapshot;
+  for (size_t group = 0; group < ARCHIVE_GROUPS; group++) {
+    /* the unused tail of the last group is ARCHIVE_NONE rather than chunk 0,
+     * so it never matches a full group of zero chunks */
+    uint32_t chunks[ARCHIVE_GROUP_SIZE];
+    memset(chunks, 0xff, sizeof(chunks));
+    size_t length = group_length(group);
+    bool created;
+    for (size_t i = 0; i < length; i++) {
+      size_t offset = (group * ARCHIVE_GROUP_SIZE + i) * ARCHIVE_CHUNK_SIZE;
+      if (offset + ARCHIVE_CHUNK_SIZE <= sizeof(m6502_snapshot_t)) {
+        chunks[i] = intern(archive, bytes + offset, false, &created);
+      } else {
+        uint8_t last[ARCHIVE_CHUNK_SIZE] = {0};
+        memcpy(last, bytes + offset, sizeof(m6502_snapshot_t) - offset);
+        chunks[i] = intern(archive, last, false, &created);
+      }
+    }
+
+    archive->states[id][group] =
+        intern(archive, (const uint8_t *)chunks, true, &created);
+    if (!created) {
+      /* the group that was already there holds these chunks */
+      for (size_t i = 0; i < length; i++) {
+        release(archive, chunks[i]);
+      }
+    }
+  }
+  archive->live_states++;
+  return id;
+}
+
+extern bool m6502_archive_restore(const m6502_archive_t *archive, uint32_t id,
+                                  m6502_snapshot_t *snapshot) {
+  if (id >= archive->state_count || archive->states[id][0] == ARCHIVE_NONE) {
+    return false;
+  }
+  uint8_t *bytes = (uint8_t *)snapshot;
+  for (size_t group = 0; group < ARCHIVE_GROUPS; group++) {
+    uint32_t chunks[ARCHIVE_GROUP_SIZE];
+    memcpy(chunks, chunk_data(archive, archive->states[id][group]),
+           sizeof(chunks));
+    for (size_t i = 0; i < group_length(group); i++) {
+      size_t offset = (group * ARCHIVE_GROUP_SIZE + i) * ARCHIVE_CHUNK_SIZE;
+      size_t size = sizeof(m6502_snapshot_t) - offset < ARCHIVE_CHUNK_SIZE
+                        ? sizeof(m6502_snapshot_t) - offset
+                        : ARCHIVE_CHUNK_SIZE;
+      memcpy(bytes + offset, chunk_data(archive, chunks[i]), size);
+    }
+  }
+  return true;
+}
+
+extern void m6502_archive_evict(m6502_archive_t *archive, uint32_t id) {
+  if (id >= archive->state_count || archive->states[id][0] == ARCHIVE_NONE) {
+    return;
+  }
+  for (size_t group = 0; group < ARCHIVE_GROUPS; group++) {
+    uint32_t root = archive->states[id][group];
+    /* read before the release, a freed chunk holds the free list */
+    uint32_t chunks[ARCHIVE_GROUP_SIZE];
+    memcpy(chunks, chunk_data(archive, root), sizeof(chunks));
+    if (!release(archive, root)) {
+      continue;
+    }
+    /* last user of the group, its chunks lose a reference as well */
+    for (size_t i = 0; i < group_length(group); i++) {
+      release(archive, chunks[i]);
+    }
+  }
+  archive->states[id][0] = ARCHIVE_NONE;
+  archive->states[id][1] = archive->free_state;
+  archive->free_state = id;
+  archive->live_states--;
+}
+
+extern void m6502_archive_stats(const m6502_archive_t *archive,
+                                m6502_archive_stats_t *stats) {
+  stats->states = archive->live_states;
+  stats->chunks = archive->live_chunks;
+  stats->bytes =
+      sizeof(m6502_archive_t) +
+      (size_t)archive->chunk_capacity *
+          (ARCHIVE_CHUNK_SIZE + sizeof(uint64_t) + sizeof(uint32_t) + 1) +
+      (archive->slot_mask + 1) * sizeof(uint32_t) +
+      (size_t)archive->state_capacity * sizeof(*archive->states);
+}
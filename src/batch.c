@@ -0,0 +1,559 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../headers/boot.h"
+#include "../headers/cpu.h"
+#include "../headers/framehash.h"
+#include "../headers/inputs.h"
+#include "../headers/pool.h"
+#include "../headers/state.h"
+
+/* headless runner, executes every job of a job list on its own emulator
+ * instance across a pool of pinned threads and prints one line per job
+
+   a job is one line of the job list:
+     rom input budget [stop]
+   input   file with one controller byte (controller_buttons) per frame, -
+           for no input
+   budget  cycles to run before giving up, or frames with an f suffix
+   stop    $addr=value (hex) stops the job when value is written to addr,
+           $addr stops on any write to it
+   blank lines and lines starting with # are skipped
+
+   with -b the first frames of every job are its boot, run without watching
+   for the stop and, with -c, shared between jobs through cached states
+
+   with -k every job keeps a checkpoint in two files it writes in turn,
+   each through a temporary file renamed over it, so one of them is always
+   whole. -r resumes every job from the newer of its two, which gives the
+   same results and frame hash logs (-H) as a run that never stopped. Jobs
+   are told apart by their line, resume with the same job list */
+
+enum job_status { JOB_STOPPED, JOB_TIMEOUT, JOB_ERROR, JOB_LOAD_FAILED };
+
+typedef struct {
+  char *rom;
+  char *input; /* NULL for no input */
+  unsigned long long budget;
+  bool has_stop;
+  uint16_t stop_address;
+  int stop_value; /* -1 for any value */
+  unsigned line;
+} job_t;
+
+typedef struct {
+  int status; /* job_status */
+  int error;  /* error_codes6502 when status is JOB_ERROR */
+  unsigned long long cycles;
+  registers_t registers;
+  uint8_t value; /* what was written for JOB_STOPPED */
+  bool done;
+} result_t;
+
+typedef struct {
+  job_t *jobs;
+  result_t *results;
+  size_t count;
+
+  /* results are printed in job order as soon as every job before them is
+   * done */
+  pthread_mutex_t output_lock;
+  size_t next_output;
+  FILE *output;
+
+  size_t boot_frames;
+  const char *boot_cache; /* NULL to boot every job */
+
+  const char *hash_logs;   /* directory of frame hash logs, NULL for none */
+  const char *checkpoints; /* directory, NULL to not checkpoint */
+  unsigned long long checkpoint_frames; /* 0 when checkpointing by time */
+  double checkpoint_seconds;
+  bool resume;
+} batch_t;
+
+/* stored with the state of a checkpoint as two little endian u64s */
+typedef struct {
+  uint64_t frame;    /* the next frame of the input */
+  uint64_t hash_log; /* bytes of the frame hash log up to the state */
+} checkpoint_t;
+
+#define CHECKPOINT_SIZE 16
+
+/* what a job needs to take and resume checkpoints */
+typedef struct {
+  const batch_t *batch;
+  const job_t *job;
+  FILE *hash_log; /* NULL when not logging */
+  unsigned slot;  /* the checkpoint file written next */
+  unsigned long long frames; /* since the last checkpoint */
+  struct timespec last;
+} checkpointer_t;
+
+static void print_help(const char *name) {
+  fprintf(stderr,
+          "usage: %s [-j workers] [-n] [-o results] [-b frames [-c dir]] "
+          "[-H dir] [-k dir [-e every] [-r]] jobs\n",
+          name);
+  fprintf(stderr, "  -j  worker threads, defaults to one per core\n");
+  fprintf(stderr, "  -n  don't pin the workers to cores\n");
+  fprintf(stderr, "  -o  write the results here instead of stdout\n");
+  fprintf(stderr, "  -b  frames of boot before the stop is watched\n");
+  fprintf(stderr, "  -c  cache the state after the boot in this directory\n");
+  fprintf(stderr, "  -H  log the hash of every frame of a job in this "
+                  "directory\n");
+  fprintf(stderr, "  -k  checkpoint every job in this directory\n");
+  fprintf(stderr, "  -e  frames between checkpoints, or seconds with an s "
+                  "suffix, 3600 by default\n");
+  fprintf(stderr, "  -r  resume every job from its last checkpoint\n");
+}
+
+static bool parse_stop(const char *token, job_t *job) {
+  unsigned address, value;
+  int consumed = 0;
+  if (sscanf(token, "$%x=%x%n", &address, &value, &consumed) == 2 &&
+      token[consumed] == '\0') {
+    job->stop_value = value & 0xff;
+  } else if (sscanf(token, "$%x%n", &address, &consumed) == 1 &&
+             token[consumed] == '\0') {
+    job->stop_value = -1;
+  } else {
+    return false;
+  }
+  job->has_stop = true;
+  job->stop_address = address & 0xffff;
+  return true;
+}
+
+static bool parse_job(char *line, job_t *job) {
+  char *save = NULL;
+  char *rom = strtok_r(line, " \t\n", &save);
+  char *input = strtok_r(NULL, " \t\n", &save);
+  char *budget = strtok_r(NULL, " \t\n", &save);
+  char *stop = strtok_r(NULL, " \t\n", &save);
+  if (rom == NULL || input == NULL || budget == NULL) {
+    return false;
+  }
+
+  char *end;
+  errno = 0;
+  job->budget = strtoull(budget, &end, 10);
+  if (errno != 0 || end == budget) {
+    return false;
+  }
+  if (*end == 'f') {
+    job->budget *= FRAME_CYCLES;
+    end++;
+  }
+  if (*end != '\0') {
+    return false;
+  }
+
+  job->has_stop = false;
+  if (stop != NULL && !parse_stop(stop, job)) {
+    return false;
+  }
+  job->rom = strdup(rom);
+  job->input = strcmp(input, "-") == 0 ? NULL : strdup(input);
+  return job->rom != NULL;
+}
+
+static job_t *read_jobs(FILE *fp, size_t *count) {
+  size_t capacity = 64;
+  job_t *jobs = malloc(capacity * sizeof(job_t));
+  char line[4096];
+  unsigned number = 0;
+  *count = 0;
+
+  while (jobs != NULL && fgets(line, sizeof(line), fp) != NULL) {
+    number++;
+    char *start = line + strspn(line, " \t");
+    if (*start == '#' || *start == '\n' || *start == '\0') {
+      continue;
+    }
+    if (*count == capacity) {
+      capacity *= 2;
+      job_t *grown = realloc(jobs, capacity * sizeof(job_t));
+      if (grown == NULL) {
+        break;
+      }
+      jobs = grown;
+    }
+    if (!parse_job(start, &jobs[*count])) {
+      fprintf(stderr, "Error: invalid job on line %u\n", number);
+      continue;
+    }
+    jobs[(*count)++].line = number;
+  }
+  return jobs;
+}
+
+static void print_result(FILE *fp, const job_t *job, const result_t *result) {
+  static const char *const statuses[] = {
+      [JOB_STOPPED] = "stop",
+      [JOB_TIMEOUT] = "timeout",
+      [JOB_LOAD_FAILED] = "load-failed",
+  };
+  const char *status = result->status == JOB_ERROR
+                           ? m6502_strerror(result->error)
+                           : statuses[result->status];
+
+  fprintf(fp, "%u %s \"%s\" cycles=%llu frames=%llu", job->line, job->rom,
+          status, result->cycles, result->cycles / FRAME_CYCLES);
+  if (result->status != JOB_LOAD_FAILED) {
+    fprintf(fp, " pc=$%04X a=$%02X x=$%02X y=$%02X p=$%02X",
+            result->registers.pc, result->registers.accumulator,
+            result->registers.x, result->registers.y,
+            result->registers.status);
+  }
+  if (result->status == JOB_STOPPED) {
+    fprintf(fp, " value=$%02X", result->value);
+  }
+  fputc('\n', fp);
+}
+
+static void finish_job(batch_t *batch, size_t index) {
+  pthread_mutex_lock(&batch->output_lock);
+  batch->results[index].done = true;
+  while (batch->next_output < batch->count &&
+         batch->results[batch->next_output].done) {
+    print_result(batch->output, &batch->jobs[batch->next_output],
+                 &batch->results[batch->next_output]);
+    batch->next_output++;
+  }
+  fflush(batch->output);
+  pthread_mutex_unlock(&batch->output_lock);
+}
+
+/* a file of the job in `directory`, caller frees */
+static char *job_path(const char *directory, const job_t *job,
+                      const char *suffix) {
+  char *path = malloc(strlen(directory) + strlen(suffix) + 32);
+  if (path != NULL) {
+    sprintf(path, "%s/job%u%s", directory, job->line, suffix);
+  }
+  return path;
+}
+
+static void put64(uint8_t *bytes, uint64_t value) {
+  for (int i = 0; i < 8; i++) {
+    bytes[i] = (value >> (8 * i)) & 0xff;
+  }
+}
+
+static uint64_t get64(const uint8_t *bytes) {
+  uint64_t value = 0;
+  for (int i = 0; i < 8; i++) {
+    value |= (uint64_t)bytes[i] << (8 * i);
+  }
+  return value;
+}
+
+static double seconds_since(const struct timespec *begin) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - begin->tv_sec) + (now.tv_nsec - begin->tv_nsec) / 1e9;
+}
+
+static void write_checkpoint(checkpointer_t *checkpointer,
+                             const processor_t *processor, size_t frame) {
+  checkpoint_t checkpoint = {frame, 0};
+  if (checkpointer->hash_log != NULL) {
+    /* the log has to reach the disk before a state that counts on it */
+    fflush(checkpointer->hash_log);
+    fsync(fileno(checkpointer->hash_log));
+    checkpoint.hash_log = (uint64_t)ftell(checkpointer->hash_log);
+  }
+  uint8_t bytes[CHECKPOINT_SIZE];
+  put64(bytes, checkpoint.frame);
+  put64(bytes + 8, checkpoint.hash_log);
+  m6502_snapshot_t snapshot;
+  m6502_save_snapshot(processor, &snapshot);
+  char *path = job_path(checkpointer->batch->checkpoints, checkpointer->job,
+                        checkpointer->slot ? ".b.m6st" : ".a.m6st");
+  if (path == NULL ||
+      !m6502_write_state_extra(&snapshot, bytes, sizeof(bytes), path)) {
+    fprintf(stderr, "Error: could not checkpoint job on line %u\n",
+            checkpointer->job->line);
+  }
+  free(path);
+  checkpointer->slot ^= 1;
+  checkpointer->frames = 0;
+  clock_gettime(CLOCK_MONOTONIC, &checkpointer->last);
+}
+
+static void maybe_checkpoint(checkpointer_t *checkpointer,
+                             const processor_t *processor, size_t frame) {
+  const batch_t *batch = checkpointer->batch;
+  if (batch->checkpoints == NULL) {
+    return;
+  }
+  checkpointer->frames++;
+  if (batch->checkpoint_frames != 0
+          ? checkpointer->frames >= batch->checkpoint_frames
+          : seconds_since(&checkpointer->last) >= batch->checkpoint_seconds) {
+    write_checkpoint(checkpointer, processor, frame);
+  }
+}
+
+/* loads the newer whole checkpoint of the job, the next one is written over
+ * the other file */
+static bool read_checkpoint(checkpointer_t *checkpointer,
+                            processor_t *processor, checkpoint_t *checkpoint) {
+  bool found = false;
+  for (unsigned slot = 0; slot < 2; slot++) {
+    char *path = job_path(checkpointer->batch->checkpoints, checkpointer->job,
+                          slot ? ".b.m6st" : ".a.m6st");
+    m6502_snapshot_t snapshot;
+    uint8_t bytes[CHECKPOINT_SIZE];
+    size_t size = sizeof(bytes);
+    if (path != NULL &&
+        m6502_read_state_extra(path, &snapshot, bytes, &size) &&
+        size == sizeof(bytes) &&
+        (!found || get64(bytes) > checkpoint->frame)) {
+      m6502_load_snapshot(processor, &snapshot);
+      checkpoint->frame = get64(bytes);
+      checkpoint->hash_log = get64(bytes + 8);
+      checkpointer->slot = slot ^ 1;
+      found = true;
+    }
+    free(path);
+  }
+  return found;
+}
+
+/* opens the frame hash log of the job, cut back to `size` when resuming */
+static FILE *open_hash_log(const batch_t *batch, const job_t *job,
+                           bool resume, uint64_t size) {
+  char *path = job_path(batch->hash_logs, job, ".hashes");
+  if (path == NULL) {
+    return NULL;
+  }
+  FILE *fp = resume ? fopen(path, "r+") : fopen(path, "w");
+  if (fp != NULL && resume &&
+      (ftruncate(fileno(fp), (off_t)size) != 0 ||
+       fseek(fp, 0, SEEK_END) != 0)) {
+    fclose(fp);
+    fp = NULL;
+  }
+  if (fp == NULL) {
+    fprintf(stderr, "Error: could not open %s: %s\n", path, strerror(errno));
+  }
+  free(path);
+  return fp;
+}
+
+/* runs frame by frame so the controller changes on frame boundaries, the
+ * budget is checked in emulated cycles so a hung rom can't stall a worker */
+static void run(processor_t *processor, const job_t *job, const uint8_t *input,
+                size_t input_size, size_t frame,
+                checkpointer_t *checkpointer, result_t *result) {
+  result->status = JOB_TIMEOUT;
+  for (; processor->clock_ticks < job->budget; frame++) {
+    maybe_checkpoint(checkpointer, processor, frame);
+    m6502_set_controller(processor, frame < input_size ? input[frame] : 0);
+
+    unsigned long long end = (unsigned long long)(frame + 1) * FRAME_CYCLES;
+    end = end < job->budget ? end : job->budget;
+    while (processor->clock_ticks < end) {
+      int error = m6502_run(processor, end - processor->clock_ticks);
+      watch_hit_t hit;
+      if (m6502_get_watch_hit(processor, &hit)) {
+        if (job->stop_value == -1 || job->stop_value == hit.value) {
+          result->status = JOB_STOPPED;
+          result->value = hit.value;
+          return;
+        }
+      } else if (error != SUCCESS) {
+        result->status = JOB_ERROR;
+        result->error = error;
+        return;
+      }
+    }
+  }
+}
+
+static void run_job(void *context, size_t index, unsigned worker) {
+  (void)worker;
+  batch_t *batch = context;
+  const job_t *job = &batch->jobs[index];
+  result_t *result = &batch->results[index];
+
+  result->status = JOB_LOAD_FAILED;
+  uint8_t *input = NULL;
+  size_t input_size = 0;
+  if (job->input != NULL &&
+      (input = read_inputs(job->input, &input_size)) == NULL) {
+    fprintf(stderr, "Error: could not read input %s\n", job->input);
+    finish_job(batch, index);
+    return;
+  }
+
+  processor_t *processor = m6502_create_headless(job->rom);
+  if (processor != NULL) {
+    checkpointer_t checkpointer = {batch, job, NULL, 0, 0, {0, 0}};
+    clock_gettime(CLOCK_MONOTONIC, &checkpointer.last);
+    checkpoint_t checkpoint = {0, 0};
+    bool resumed = batch->resume && batch->checkpoints != NULL &&
+                   read_checkpoint(&checkpointer, processor, &checkpoint);
+
+    int error = SUCCESS;
+    size_t frame = (size_t)checkpoint.frame;
+    if (!resumed) {
+      /* a job that can't get through the boot runs all of it as usual */
+      frame = job->budget >= batch->boot_frames * FRAME_CYCLES
+                  ? batch->boot_frames
+                  : 0;
+      error = m6502_boot(processor, input, input_size, frame,
+                         batch->boot_cache);
+    }
+    if (job->has_stop) {
+      m6502_add_watchpoint(processor, job->stop_address, WATCH_WRITE);
+    }
+    bool logging = true;
+    if (batch->hash_logs != NULL) {
+      checkpointer.hash_log =
+          open_hash_log(batch, job, resumed, checkpoint.hash_log);
+      logging = checkpointer.hash_log != NULL &&
+                m6502_hash_frames(processor, checkpointer.hash_log);
+    }
+
+    if (!logging) {
+      result->status = JOB_LOAD_FAILED;
+    } else if (error != SUCCESS) {
+      result->status = JOB_ERROR;
+      result->error = error;
+    } else {
+      run(processor, job, input, input_size, frame, &checkpointer, result);
+    }
+    result->cycles = processor->clock_ticks;
+    result->registers = processor->registers;
+    m6502_destroy(processor);
+    if (checkpointer.hash_log != NULL) {
+      fclose(checkpointer.hash_log);
+    }
+  }
+  free(input);
+  finish_job(batch, index);
+}
+
+int main(int argc, char *argv[]) {
+  unsigned workers = 0;
+  bool pin = true;
+  const char *output_path = NULL;
+  size_t boot_frames = 0;
+  const char *boot_cache = NULL;
+  const char *hash_logs = NULL, *checkpoints = NULL;
+  const char *every = "3600";
+  bool resume = false;
+  int option;
+  while ((option = getopt(argc, argv, "j:no:b:c:H:k:e:rh")) != -1) {
+    switch (option) {
+    case 'j':
+      workers = (unsigned)strtoul(optarg, NULL, 10);
+      break;
+    case 'n':
+      pin = false;
+      break;
+    case 'o':
+      output_path = optarg;
+      break;
+    case 'b':
+      boot_frames = strtoul(optarg, NULL, 10);
+      break;
+    case 'c':
+      boot_cache = optarg;
+      break;
+    case 'H':
+      hash_logs = optarg;
+      break;
+    case 'k':
+      checkpoints = optarg;
+      break;
+    case 'e':
+      every = optarg;
+      break;
+    case 'r':
+      resume = true;
+      break;
+    default:
+      print_help(argv[0]);
+      return 1;
+    }
+  }
+  if (optind >= argc) {
+    print_help(argv[0]);
+    return 1;
+  }
+
+  char *unit;
+  double interval = strtod(every, &unit);
+  if (unit == every || !isfinite(interval) || interval <= 0 ||
+      (*unit != '\0' && strcmp(unit, "s") != 0)) {
+    fprintf(stderr, "Error: -e takes a positive number of frames, or of "
+                    "seconds with an s suffix\n");
+    return 1;
+  }
+
+  FILE *fp = fopen(argv[optind], "r");
+  if (fp == NULL) {
+    fprintf(stderr, "Error: could not open %s: %s\n", argv[optind],
+            strerror(errno));
+    return 1;
+  }
+  batch_t batch = {0};
+  batch.boot_frames = boot_frames;
+  batch.boot_cache = boot_cache;
+  batch.hash_logs = hash_logs;
+  batch.checkpoints = checkpoints;
+  batch.resume = resume;
+  if (*unit == 's') {
+    batch.checkpoint_seconds = interval;
+  } else {
+    batch.checkpoint_frames = interval >= 1 ? (unsigned long long)interval : 1;
+  }
+  batch.jobs = read_jobs(fp, &batch.count);
+  fclose(fp);
+  batch.results = calloc(batch.count ? batch.count : 1, sizeof(result_t));
+  if (batch.jobs == NULL || batch.results == NULL) {
+    fprintf(stderr, "Error: out of memory\n");
+    return 1;
+  }
+
+  batch.output = output_path != NULL ? fopen(output_path, "w") : stdout;
+  if (batch.output == NULL) {
+    fprintf(stderr, "Error: could not open %s: %s\n", output_path,
+            strerror(errno));
+    return 1;
+  }
+  pthread_mutex_init(&batch.output_lock, NULL);
+
+  pool_t *pool = pool_create(workers, pin);
+  if (pool == NULL) {
+    fprintf(stderr, "Error: could not start the workers\n");
+    return 1;
+  }
+  pool_run(pool, batch.count, &run_job, &batch);
+  pool_destroy(pool);
+
+  int failed = 0;
+  for (size_t i = 0; i < batch.count; i++) {
+    failed |= batch.results[i].status == JOB_ERROR ||
+              batch.results[i].status == JOB_LOAD_FAILED;
+    free(batch.jobs[i].rom);
+    free(batch.jobs[i].input);
+  }
+  if (batch.output != stdout) {
+    fclose(batch.output);
+  }
+  pthread_mutex_destroy(&batch.output_lock);
+  free(batch.jobs);
+  free(batch.results);
+  return failed;
+}
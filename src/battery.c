@@ -0,0 +1,167 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../headers/battery.h"
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/* seconds between background flushes of the save file */
+#define SYNC_INTERVAL 5
+
+struct _battery {
+  int fd;
+  uint8_t *memory;
+  size_t size;
+
+  pthread_t sync_thread;
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  _Bool running;
+};
+
+/**
+   @brief replaces the extension of the rom with .sav, caller frees
+*/
+static char *save_path(const char *const rom_path) {
+  const char *slash = strrchr(rom_path, '/');
+  const char *dot = strrchr(rom_path, '.');
+  size_t length = strlen(rom_path);
+
+  if (dot != NULL && (slash == NULL || dot > slash)) {
+    length = (size_t)(dot - rom_path);
+  }
+
+  char *path = malloc(length + sizeof(".sav"));
+  if (path == NULL) {
+    return NULL;
+  }
+  memcpy(path, rom_path, length);
+  strcpy(path + length, ".sav");
+  return path;
+}
+
+/* the emulation thread never waits on the disk, this thread does it instead */
+static void *sync_loop(void *arg) {
+  battery_t *battery = arg;
+  pthread_mutex_lock(&battery->lock);
+  while (battery->running) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += SYNC_INTERVAL;
+    pthread_cond_timedwait(&battery->wake, &battery->lock, &deadline);
+    msync(battery->memory, battery->size, MS_SYNC);
+  }
+  pthread_mutex_unlock(&battery->lock);
+  return NULL;
+}
+
+extern battery_t *open_battery(const char *const rom_path, size_t size) {
+  if (rom_path == NULL) {
+    return NULL;
+  }
+
+  char *path = save_path(rom_path);
+  if (path == NULL) {
+    return NULL;
+  }
+
+  battery_t *battery = calloc(1, sizeof(battery_t));
+  if (battery == NULL) {
+    free(path);
+    return NULL;
+  }
+
+  battery->fd = open(path, O_RDWR | O_CREAT, 0644);
+  if (battery->fd == -1) {
+    fprintf(stderr, "Error: could not open save %s: %s\n", path,
+            strerror(errno));
+    goto fail;
+  }
+
+  struct stat st;
+  if (fstat(battery->fd, &st) == -1 ||
+      ((size_t)st.st_size < size && ftruncate(battery->fd, size) == -1)) {
+    fprintf(stderr, "Error: could not size save %s: %s\n", path,
+            strerror(errno));
+    goto fail;
+  }
+
+  battery->memory =
+      mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, battery->fd, 0);
+  if (battery->memory == MAP_FAILED) {
+    fprintf(stderr, "Error: could not map save %s: %s\n", path,
+            strerror(errno));
+    goto fail;
+  }
+  battery->size = size;
+
+  pthread_mutex_init(&battery->lock, NULL);
+  pthread_cond_init(&battery->wake, NULL);
+  battery->running = true;
+  if (pthread_create(&battery->sync_thread, NULL, &sync_loop, battery) != 0) {
+    /* still usable, it just only gets flushed on close */
+    battery->running = false;
+  }
+
+  free(path);
+  return battery;
+
+fail:
+  if (battery->fd != -1) {
+    close(battery->fd);
+  }
+  free(battery);
+  free(path);
+  return NULL;
+}
+
+extern uint8_t *battery_memory(battery_t *battery) { return battery->memory; }
+
+extern void close_battery(battery_t *battery) {
+  if (battery == NULL) {
+    return;
+  }
+
+  pthread_mutex_lock(&battery->lock);
+  _Bool was_running = battery->running;
+  battery->running = false;
+  pthread_cond_signal(&battery->wake);
+  pthread_mutex_unlock(&battery->lock);
+  if (was_running) {
+    pthread_join(battery->sync_thread, NULL);
+  }
+
+  msync(battery->memory, battery->size, MS_SYNC);
+  munmap(battery->memory, battery->size);
+  close(battery->fd);
+  pthread_cond_destroy(&battery->wake);
+  pthread_mutex_destroy(&battery->lock);
+  free(battery);
+}
+
+#else
+/* no mmap, battery saves are not supported so prg ram stays in memory */
+extern battery_t *open_battery(const char *const rom_path, size_t size) {
+  (void)rom_path;
+  (void)size;
+  fprintf(stderr, "Warning: battery saves are not supported on this platform\n");
+  return NULL;
+}
+
+extern uint8_t *battery_memory(battery_t *battery) {
+  (void)battery;
+  return NULL;
+}
+
+extern void close_battery(battery_t *battery) { (void)battery; }
+#endif
@@ -0,0 +1,417 @@
+#define _POSIX_C_SOURCE 200809L
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../headers/hash.h"
+#include "../headers/inputs.h"
+#include "../headers/movie.h"
+#include "../headers/pool.h"
+#include "../headers/snapshot.h"
+
+/* finds where two builds of the core part ways on the same input. Both
+ * libm6502 builds are loaded with dlopen and run side by side, one pool
+ * worker each, a segment of frames at a time from a checkpoint they agreed
+ * on, hashing the whole state (clock included) after every frame. The first
+ * frame whose hashes differ is run again from the checkpoint, one
+ * instruction at a time from its start until the states part, then once
+ * more with the trace log on to print both traces around that instruction.
+ *
+ * processor_t is only passed to the builds, never looked into, as its layout
+ * may be what changed. m6502_snapshot_t has to be the same in both */
+
+#define DEFAULT_INTERVAL 600
+#define DEFAULT_CONTEXT 8
+#define NO_DIVERGENCE SIZE_MAX
+#define MAX_DIFFERENCES 16
+
+typedef struct {
+  const char *path;
+  void *handle;
+  processor_t *(*create)(const char *rom_path);
+  processor_t *(*create_headless)(const char *rom_path); /* NULL if older */
+  void (*destroy)(processor_t *processor);
+  void (*detach)(processor_t *processor);
+  void (*set_controller)(processor_t *processor, uint8_t buttons);
+  int (*run_frames)(processor_t *processor, unsigned frames);
+  int (*step)(processor_t *processor);
+  void (*save_snapshot)(const processor_t *processor,
+                        m6502_snapshot_t *snapshot);
+  void (*load_snapshot)(processor_t *processor,
+                        const m6502_snapshot_t *snapshot);
+  bool (*open_log)(processor_t *processor, const char *path);
+  const char *(*strerror)(int error);
+
+  processor_t *processor;
+  m6502_snapshot_t checkpoint; /* the start of the segment */
+  uint64_t *hashes;            /* after every frame of the segment */
+  size_t frames_run;           /* fewer than the segment if the cpu stopped */
+  int error;
+} build_t;
+
+typedef struct {
+  build_t builds[2];
+  const uint8_t *inputs;
+  size_t input_count;
+  unsigned long long frame; /* the first frame of the segment */
+  size_t segment;           /* frames in it */
+  unsigned long long target; /* for replay_to */
+} bisect_t;
+
+static void print_help(const char *name) {
+  fprintf(stderr,
+          "usage: %s [-i interval] [-f frames] [-t lines] liba.so libb.so rom "
+          "input\n",
+          name);
+  fprintf(stderr, "  input  a movie or one controller byte per frame\n");
+  fprintf(stderr, "  -i  frames between checkpoints, defaults to %d\n",
+          DEFAULT_INTERVAL);
+  fprintf(stderr, "  -f  frames to run, defaults to the length of the "
+                  "input\n");
+  fprintf(stderr, "  -t  trace lines shown around the divergence, defaults "
+                  "to %d\n",
+          DEFAULT_CONTEXT);
+}
+
+/* the posix way to turn dlsym's void * into a function pointer */
+#define LOAD_SYMBOL(build, field, name)                                      \
+  ((*(void **)&(build)->field = dlsym((build)->handle, name)) != NULL)
+
+static bool load_build(build_t *build, const char *path) {
+  build->path = path;
+  /* local, so the second build's symbols don't resolve to the first's */
+  build->handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+  if (build->handle == NULL) {
+    fprintf(stderr, "Error: could not load %s: %s\n", path, dlerror());
+    return false;
+  }
+  if (!LOAD_SYMBOL(build, create, "m6502_create") ||
+      !LOAD_SYMBOL(build, destroy, "m6502_destroy") ||
+      !LOAD_SYMBOL(build, detach, "m6502_detach") ||
+      !LOAD_SYMBOL(build, set_controller, "m6502_set_controller") ||
+      !LOAD_SYMBOL(build, run_frames, "m6502_run_frames") ||
+      !LOAD_SYMBOL(build, step, "m6502_step") ||
+      !LOAD_SYMBOL(build, save_snapshot, "m6502_save_snapshot") ||
+      !LOAD_SYMBOL(build, load_snapshot, "m6502_load_snapshot") ||
+      !LOAD_SYMBOL(build, open_log, "m6502_open_log") ||
+      !LOAD_SYMBOL(build, strerror, "m6502_strerror")) {
+    fprintf(stderr, "Error: %s lacks m6502 functions: %s\n", path, dlerror());
+    return false;
+  }
+  (void)LOAD_SYMBOL(build, create_headless, "m6502_create_headless");
+  return true;
+}
+
+static bool read_input(const char *path, uint8_t **inputs, size_t *count) {
+  m6502_movie_t movie;
+  if (m6502_load_movie(path, &movie)) {
+    *inputs = movie.inputs;
+    *count = movie.count;
+    free(movie.lag);
+    return true;
+  }
+  if ((*inputs = read_inputs(path, count)) == NULL) {
+    fprintf(stderr, "Error: could not read input %s\n", path);
+    return false;
+  }
+  return true;
+}
+
+static uint8_t input_at(const bisect_t *bisect, unsigned long long frame) {
+  return frame < bisect->input_count ? bisect->inputs[frame] : 0;
+}
+
+static uint64_t state_hash(const build_t *build) {
+  m6502_snapshot_t snapshot;
+  build->save_snapshot(build->processor, &snapshot);
+  return hash_lanes(&snapshot, sizeof(snapshot), 0);
+}
+
+static void run_segment(void *context, size_t index, unsigned worker) {
+  (void)worker;
+  bisect_t *bisect = context;
+  build_t *build = &bisect->builds[index];
+  build->save_snapshot(build->processor, &build->checkpoint);
+  build->frames_run = 0;
+  build->error = SUCCESS;
+  while (build->frames_run < bisect->segment && build->error == SUCCESS) {
+    build->set_controller(build->processor,
+                          input_at(bisect, bisect->frame + build->frames_run));
+    build->error = build->run_frames(build->processor, 1);
+    build->hashes[build->frames_run++] = state_hash(build);
+  }
+}
+
+/* from the checkpoint to the start of frame `target` */
+static void replay_to(void *context, size_t index, unsigned worker) {
+  (void)worker;
+  bisect_t *bisect = context;
+  build_t *build = &bisect->builds[index];
+  build->load_snapshot(build->processor, &build->checkpoint);
+  for (unsigned long long frame = bisect->frame; frame < bisect->target;
+       frame++) {
+    build->set_controller(build->processor, input_at(bisect, frame));
+    build->run_frames(build->processor, 1);
+  }
+}
+
+/* the first frame of the segment the builds disagree on */
+static size_t first_difference(const bisect_t *bisect) {
+  const build_t *a = &bisect->builds[0], *b = &bisect->builds[1];
+  size_t common = a->frames_run < b->frames_run ? a->frames_run
+                                                : b->frames_run;
+  for (size_t i = 0; i < common; i++) {
+    if (a->hashes[i] != b->hashes[i]) {
+      return i;
+    }
+  }
+  return a->frames_run != b->frames_run ? common : NO_DIVERGENCE;
+}
+
+static void print_differences(const m6502_snapshot_t *a,
+                              const m6502_snapshot_t *b) {
+  printf("  pc $%04X $%04X  a $%02X $%02X  x $%02X $%02X  y $%02X $%02X  "
+         "sp $%02X $%02X  p $%02X $%02X\n",
+         a->pc, b->pc, a->accumulator, b->accumulator, a->x, b->x, a->y, b->y,
+         a->sp, b->sp, a->status, b->status);
+  printf("  clock %llu %llu  error %d %d\n",
+         (unsigned long long)a->clock_ticks,
+         (unsigned long long)b->clock_ticks, a->error, b->error);
+
+  static const struct {
+    const char *name;
+    size_t offset, size;
+    uint16_t address; /* of the first byte on the bus, oam has none */
+  } regions[] = {
+      {"ram", offsetof(m6502_snapshot_t, ram), INTERNAL_RAM_SIZE, 0},
+      {"ppu", offsetof(m6502_snapshot_t, ppu_registers), BUS_PAGE_SIZE,
+       PPU_REGISTERS_START},
+      {"io", offsetof(m6502_snapshot_t, io_registers), BUS_PAGE_SIZE,
+       IO_REGISTERS_START},
+      {"prg ram", offsetof(m6502_snapshot_t, prg_ram), PRG_RAM_SIZE,
+       PRG_RAM_START},
+      {"oam", offsetof(m6502_snapshot_t, oam), OAM_SIZE, 0},
+  };
+  const uint8_t *left = (const uint8_t *)a, *right = (const uint8_t *)b;
+  unsigned shown = 0;
+  for (size_t r = 0; r < sizeof(regions) / sizeof(regions[0]); r++) {
+    for (size_t i = 0; i < regions[r].size; i++) {
+      size_t offset = regions[r].offset + i;
+      if (left[offset] == right[offset]) {
+        continue;
+      }
+      if (shown++ == MAX_DIFFERENCES) {
+        printf("  ...\n");
+        return;
+      }
+      printf("  %s $%04zX $%02X $%02X\n", regions[r].name,
+             regions[r].address + i, left[offset], right[offset]);
+    }
+  }
+}
+
+/* steps both builds from `starts` until their states part
+ * @return false if they never did within the frame */
+static bool find_instruction(bisect_t *bisect, const m6502_snapshot_t *starts,
+                             uint8_t buttons, unsigned long long *instruction,
+                             m6502_snapshot_t *ends) {
+  build_t *a = &bisect->builds[0], *b = &bisect->builds[1];
+  for (int i = 0; i < 2; i++) {
+    bisect->builds[i].load_snapshot(bisect->builds[i].processor, &starts[i]);
+    bisect->builds[i].set_controller(bisect->builds[i].processor, buttons);
+  }
+  for (*instruction = 0;; (*instruction)++) {
+    int error = a->step(a->processor);
+    b->step(b->processor);
+    a->save_snapshot(a->processor, &ends[0]);
+    b->save_snapshot(b->processor, &ends[1]);
+    if (memcmp(&ends[0], &ends[1], sizeof(ends[0])) != 0) {
+      return true;
+    }
+    /* equal from here on, errors included */
+    if (error != SUCCESS || ends[0].frame != starts[0].frame) {
+      return false;
+    }
+  }
+}
+
+/* reruns the instructions with the trace log on and prints the lines around
+ * the one where the builds parted, the instance is gone afterwards */
+static void print_trace(build_t *build, const m6502_snapshot_t *start,
+                        uint8_t buttons, unsigned long long instruction,
+                        unsigned context) {
+  char path[] = "/tmp/m6502_bisect.XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    fprintf(stderr, "Error: could not create a trace file\n");
+    return;
+  }
+  close(fd);
+  build->load_snapshot(build->processor, start);
+  build->set_controller(build->processor, buttons);
+  if (build->open_log(build->processor, path)) {
+    for (unsigned long long i = 0; i <= instruction + context; i++) {
+      if (build->step(build->processor) != SUCCESS) {
+        break;
+      }
+    }
+  }
+  /* closes the log */
+  build->destroy(build->processor);
+  build->processor = NULL;
+
+  printf("trace of %s:\n", build->path);
+  FILE *fp = fopen(path, "r");
+  char line[1024];
+  unsigned long long first = instruction > context ? instruction - context : 0;
+  for (unsigned long long i = 0;
+       fp != NULL && i <= instruction + context &&
+       fgets(line, sizeof(line), fp) != NULL;
+       i++) {
+    if (i >= first) {
+      printf("%s %s", i == instruction ? ">" : " ", line);
+    }
+  }
+  if (fp != NULL) {
+    fclose(fp);
+  }
+  unlink(path);
+}
+
+/* @return 2 when the builds diverged, like a movie that desyncs */
+static int report(bisect_t *bisect, pool_t *pool, size_t index,
+                  unsigned context) {
+  unsigned long long frame = bisect->frame + index;
+  bisect->target = frame;
+  pool_run(pool, 2, &replay_to, bisect);
+
+  m6502_snapshot_t starts[2], ends[2];
+  for (int i = 0; i < 2; i++) {
+    bisect->builds[i].save_snapshot(bisect->builds[i].processor, &starts[i]);
+  }
+  uint8_t buttons = input_at(bisect, frame);
+  unsigned long long instruction;
+  if (!find_instruction(bisect, starts, buttons, &instruction, ends)) {
+    printf("frame %llu differs but stepping it does not, run_frames and step "
+           "disagree\n",
+           frame);
+    return 2;
+  }
+  printf("diverged in frame %llu at instruction %llu of the frame\n", frame,
+         instruction);
+  printf("state after it (%s, %s):\n", bisect->builds[0].path,
+         bisect->builds[1].path);
+  print_differences(&ends[0], &ends[1]);
+  for (int i = 0; i < 2; i++) {
+    print_trace(&bisect->builds[i], &starts[i], buttons, instruction,
+                context);
+  }
+  return 2;
+}
+
+int main(int argc, char *argv[]) {
+  unsigned interval = DEFAULT_INTERVAL, context = DEFAULT_CONTEXT;
+  unsigned long long frames = 0;
+  bool frames_given = false;
+  int option;
+  while ((option = getopt(argc, argv, "i:f:t:h")) != -1) {
+    switch (option) {
+    case 'i':
+      interval = (unsigned)strtoul(optarg, NULL, 10);
+      break;
+    case 'f':
+      frames = strtoull(optarg, NULL, 10);
+      frames_given = true;
+      break;
+    case 't':
+      context = (unsigned)strtoul(optarg, NULL, 10);
+      break;
+    default:
+      print_help(argv[0]);
+      return 1;
+    }
+  }
+  if (argc - optind != 4 || interval == 0) {
+    print_help(argv[0]);
+    return 1;
+  }
+
+  bisect_t bisect;
+  memset(&bisect, 0, sizeof(bisect));
+  uint8_t *inputs = NULL;
+  if (!load_build(&bisect.builds[0], argv[optind]) ||
+      !load_build(&bisect.builds[1], argv[optind + 1]) ||
+      !read_input(argv[optind + 3], &inputs, &bisect.input_count)) {
+    return 1;
+  }
+  bisect.inputs = inputs;
+  frames = frames_given ? frames : bisect.input_count;
+
+  int status = 1;
+  pool_t *pool = pool_create(2, false);
+  for (int i = 0; i < 2; i++) {
+    build_t *build = &bisect.builds[i];
+    build->hashes = malloc(interval * sizeof(uint64_t));
+    /* keeps a battery backed cart's save file out of it, builds from before
+     * m6502_create_headless map it and cut it loose, leaking the mapping */
+    build->processor = build->create_headless != NULL
+                           ? build->create_headless(argv[optind + 2])
+                           : build->create(argv[optind + 2]);
+    if (build->hashes == NULL || build->processor == NULL) {
+      fprintf(stderr, "Error: %s could not load %s\n", build->path,
+              argv[optind + 2]);
+      goto done;
+    }
+    if (build->create_headless == NULL) {
+      build->detach(build->processor);
+    }
+  }
+  if (pool == NULL) {
+    goto done;
+  }
+
+  m6502_snapshot_t power_on[2];
+  for (int i = 0; i < 2; i++) {
+    bisect.builds[i].save_snapshot(bisect.builds[i].processor, &power_on[i]);
+  }
+  if (memcmp(&power_on[0], &power_on[1], sizeof(power_on[0])) != 0) {
+    printf("diverged at power on\n");
+    print_differences(&power_on[0], &power_on[1]);
+    status = 2;
+    goto done;
+  }
+
+  status = 0;
+  for (; bisect.frame < frames; bisect.frame += bisect.segment) {
+    bisect.segment =
+        frames - bisect.frame < interval ? frames - bisect.frame : interval;
+    pool_run(pool, 2, &run_segment, &bisect);
+    size_t index = first_difference(&bisect);
+    if (index != NO_DIVERGENCE) {
+      status = report(&bisect, pool, index, context);
+      break;
+    }
+    if (bisect.builds[0].error != SUCCESS) {
+      bisect.frame += bisect.builds[0].frames_run;
+      printf("both stopped in frame %llu: %s\n", bisect.frame - 1,
+             bisect.builds[0].strerror(bisect.builds[0].error));
+      break;
+    }
+  }
+  if (status == 0) {
+    printf("no divergence in %llu frames\n", bisect.frame);
+  }
+
+done:
+  pool_destroy(pool);
+  for (int i = 0; i < 2; i++) {
+    if (bisect.builds[i].processor != NULL) {
+      bisect.builds[i].destroy(bisect.builds[i].processor);
+    }
+    free(bisect.builds[i].hashes);
+  }
+  free(inputs);
+  return status;
+}
@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../headers/boot.h"
+#include "../headers/framehash.h"
+#include "../headers/hash.h"
+#include "../headers/state.h"
+
+/* without the id cmake passes in every compile of this file counts as a new
+ * build, which errs on the side of booting again */
+#ifndef M6502_BUILD_ID
+#define M6502_BUILD_ID __DATE__ " " __TIME__
+#endif
+
+static const char build_id[] = M6502_BUILD_ID
+#ifdef M6502_PROFILE
+    "+profile"
+#endif
+#ifdef M6502_UNINIT_CHECK
+    "+uninit"
+#endif
+    ;
+
+extern const char *m6502_build_id(void) { return build_id; }
+
+/* two differently seeded hashes of everything the booted state depends on,
+ * so entries don't collide by chance */
+static void boot_key(const processor_t *processor, const uint8_t *input,
+                     size_t input_size, size_t frames, uint64_t key[2]) {
+  m6502_snapshot_t start;
+  m6502_save_snapshot(processor, &start);
+  size_t given = input_size < frames ? input_size : frames;
+  uint64_t frame_count = frames;
+
+  for (uint64_t i = 0; i < 2; i++) {
+    uint64_t hash = hash_bytes(build_id, sizeof(build_id), i);
+    hash = hash_bytes(processor->memory + PRG_ROM_START, processor->rom_size,
+                      hash);
+    hash = hash_bytes(&start, sizeof(start), hash);
+    hash = hash_bytes(&frame_count, sizeof(frame_count), hash);
+    /* missing input is 0, the same as input that was given as 0 */
+    hash = hash_bytes(input, given, hash);
+    for (size_t zeros = frames - given; zeros > 0;) {
+      static const uint8_t zero[256];
+      size_t size = zeros < sizeof(zero) ? zeros : sizeof(zero);
+      hash = hash_bytes(zero, size, hash);
+      zeros -= size;
+    }
+    key[i] = hash;
+  }
+}
+
+static int run_boot(processor_t *processor, const uint8_t *input,
+                    size_t input_size, size_t frames) {
+  for (size_t frame = 0; frame < frames; frame++) {
+    m6502_set_controller(processor, frame < input_size ? input[frame] : 0);
+    int error = m6502_run_frames(processor, 1);
+    if (error != SUCCESS) {
+      return error;
+    }
+  }
+  return SUCCESS;
+}
+
+extern int m6502_boot(processor_t *processor, const uint8_t *input,
+                      size_t input_size, size_t frames,
+                      const char *directory) {
+  FILE *log = processor->log;
+  frame_hasher_t *hasher = processor->hasher;
+  size_t watchpoint_count = processor->watchpoint_count;
+  processor->log = NULL;
+  processor->hasher = NULL;
+  processor->watchpoint_count = 0;
+
+  char *path = NULL;
+  if (directory != NULL && (path = malloc(strlen(directory) + 40)) != NULL) {
+    uint64_t key[2];
+    boot_key(processor, input, input_size, frames, key);
+    sprintf(path, "%s/%016llx%016llx.m6st", directory,
+            (unsigned long long)key[0], (unsigned long long)key[1]);
+  }
+
+  int error = SUCCESS;
+  m6502_snapshot_t booted;
+  if (path != NULL && m6502_read_state(path, &booted)) {
+    m6502_load_snapshot(processor, &booted);
+  } else {
+    error = run_boot(processor, input, input_size, frames);
+    if (error == SUCCESS && path != NULL) {
+      /* a failed store only costs the next run the boot */
+      m6502_save_snapshot(processor, &booted);
+      m6502_write_state(&booted, path);
+    }
+  }
+
+  free(path);
+  processor->log = log;
+  processor->hasher = hasher;
+  processor->watchpoint_count = watchpoint_count;
+  return error;
+}
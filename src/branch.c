@@ -0,0 +1,149 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../headers/branch.h"
+
+#ifdef __unix__
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+typedef struct {
+  pid_t pid;
+  int pipe; /* read end, -1 once it has been read */
+} child_t;
+
+static bool write_all(int fd, const uint8_t *buffer, size_t size) {
+  while (size > 0) {
+    ssize_t written = write(fd, buffer, size);
+    if (written == -1 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      return false;
+    }
+    buffer += written;
+    size -= (size_t)written;
+  }
+  return true;
+}
+
+static bool read_all(int fd, uint8_t *buffer, size_t size) {
+  while (size > 0) {
+    ssize_t got = read(fd, buffer, size);
+    if (got == -1 && errno == EINTR) {
+      continue;
+    }
+    if (got <= 0) {
+      return false;
+    }
+    buffer += got;
+    size -= (size_t)got;
+  }
+  return true;
+}
+
+/* never returns, the child leaves with _exit so it doesn't flush the stdio
+ * buffers or run the atexit handlers it inherited from the parent */
+static void run_child(processor_t *processor, size_t branch,
+                      m6502_branch_task task, void *context, size_t size,
+                      int fd) {
+  m6502_detach(processor);
+  uint8_t *result = calloc(size ? size : 1, 1);
+  bool ok = result != NULL && task(processor, branch, context, result);
+  ok = ok && write_all(fd, result, size);
+  _exit(ok ? 0 : 1);
+}
+
+static bool start_child(processor_t *processor, size_t branch,
+                        m6502_branch_task task, void *context, size_t size,
+                        child_t *child) {
+  int fds[2];
+  if (pipe(fds) == -1) {
+    return false;
+  }
+  child->pid = fork();
+  if (child->pid == -1) {
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+  if (child->pid == 0) {
+    close(fds[0]);
+    run_child(processor, branch, task, context, size, fds[1]);
+  }
+  close(fds[1]);
+  child->pipe = fds[0];
+  return true;
+}
+
+/* the result has to be read before waiting, a big one fills the pipe */
+static bool finish_child(child_t *child, uint8_t *result, size_t size) {
+  bool ok = read_all(child->pipe, result, size);
+  close(child->pipe);
+  int status;
+  while (waitpid(child->pid, &status, 0) == -1 && errno == EINTR) {
+  }
+  return ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+extern size_t m6502_branch(processor_t *processor, size_t count,
+                           m6502_branch_task task, void *context,
+                           void *results, size_t result_size, bool *ok,
+                           unsigned max_children) {
+  size_t limit = max_children != 0 && max_children < count ? max_children
+                                                           : count;
+  child_t *children = calloc(limit ? limit : 1, sizeof(child_t));
+  if (children == NULL) {
+    return 0;
+  }
+  /* anything still buffered would be written once by every child too */
+  fflush(NULL);
+
+  size_t succeeded = 0;
+  for (size_t first = 0; first < count; first += limit) {
+    size_t batch = count - first < limit ? count - first : limit;
+    for (size_t i = 0; i < batch; i++) {
+      if (!start_child(processor, first + i, task, context, result_size,
+                       &children[i])) {
+        fprintf(stderr, "Error: could not fork branch %zu: %s\n", first + i,
+                strerror(errno));
+        children[i].pid = -1;
+      }
+    }
+    for (size_t i = 0; i < batch; i++) {
+      uint8_t *result = (uint8_t *)results + (first + i) * result_size;
+      bool done = children[i].pid != -1 &&
+                  finish_child(&children[i], result, result_size);
+      if (ok != NULL) {
+        ok[first + i] = done;
+      }
+      succeeded += done;
+    }
+  }
+  free(children);
+  return succeeded;
+}
+
+#else
+/* no fork, nothing can be branched */
+extern size_t m6502_branch(processor_t *processor, size_t count,
+                           m6502_branch_task task, void *context,
+                           void *results, size_t result_size, bool *ok,
+                           unsigned max_children) {
+  (void)processor;
+  (void)task;
+  (void)context;
+  (void)results;
+  (void)result_size;
+  (void)max_children;
+  if (ok != NULL) {
+    memset(ok, 0, count * sizeof(bool));
+  }
+  fprintf(stderr, "Warning: branching is not supported on this platform\n");
+  return 0;
+}
+#endif
@@ -7,28 +7,34 @@
 
 extern cartridge_t *open_program(const char *const path) {
   if (path == NULL) {
-    exit(1);
+    return NULL;
   }
   FILE *fp = fopen(path, "rb");
+  if (fp == NULL) {
+    return NULL;
+  }
 
   cartridge_t *cartridge = malloc(sizeof(cartridge_t));
   if (cartridge == NULL) {
+    fclose(fp);
     return NULL;
   }
 
-  fread(&cartridge->header, 16, sizeof(unsigned char), fp);
-
   static unsigned char const type[] = {0x4e, 0x45, 0x53, 0x1a};
-  static const int32_t nes_constant = 0x4e45531a;
-  if (cartridge->header.constant == nes_constant) {
-    fprintf(stderr, "Error: not a NES file");
-    exit(1);
+  if (fread(&cartridge->header, 16, sizeof(unsigned char), fp) != 1 ||
+      memcmp(cartridge->header.header, type, sizeof(type)) != 0) {
+    fprintf(stderr, "Error: not a NES file\n");
+    free(cartridge);
+    fclose(fp);
+    return NULL;
   }
 
+#ifdef DEBUG
   printf("%x, prg size: %x, chr size: %d, flags 6: %x, flags7: %x\n",
          cartridge->header.constant, cartridge->header.prg_rom_size,
          cartridge->header.chr_rom_size, cartridge->header.flags6,
          cartridge->header.flags7);
+#endif
 
   cartridge->nes2 = cartridge->header.header[7] & 0x0c;
 
@@ -36,14 +42,9 @@ extern cartridge_t *open_program(const char *const path) {
                               1); /* 0x4000 magic number for size of prg_rom */
   cartridge->chr_rom = calloc((size_t) 0x2000 * cartridge->header.chr_rom_size,
                               1); /* 0x2000 magic number for size of chr_rom */
-  if (cartridge->prg_rom == NULL) {
-    free(cartridge);
-    return NULL;
-  }
-
-  if (cartridge->chr_rom == NULL) {
-    free(cartridge->prg_rom);
-    free(cartridge);
+  if (cartridge->prg_rom == NULL || cartridge->chr_rom == NULL) {
+    free_cartridge(cartridge);
+    fclose(fp);
     return NULL;
   }
 
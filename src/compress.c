@@ -0,0 +1,134 @@
+#include <string.h>
+
+#include "../headers/compress.h"
+
+/* every sequence is a token byte, literal count in the high nibble and match
+ * length - MIN_MATCH in the low one (15 meaning more length bytes follow,
+ * each adding up to 255), the literals, then a 2 byte little endian offset
+ * back into the output. The last sequence stops after its literals */
+
+#define MIN_MATCH 4
+#define MAX_OFFSET 0xffff
+#define HASH_BITS 12
+
+static uint32_t read32(const uint8_t *bytes) {
+  uint32_t word;
+  memcpy(&word, bytes, sizeof(word));
+  return word;
+}
+
+static uint8_t *write_length(uint8_t *out, size_t length) {
+  for (; length >= 255; length -= 255) {
+    *out++ = 255;
+  }
+  *out++ = (uint8_t)length;
+  return out;
+}
+
+static bool read_length(const uint8_t **in, const uint8_t *end,
+                        size_t *length) {
+  uint8_t byte;
+  do {
+    if (*in == end) {
+      return false;
+    }
+    byte = *(*in)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+static uint8_t *write_literals(uint8_t *out, uint8_t *token,
+                               const uint8_t *literals, size_t count) {
+  *token = (uint8_t)((count < 15 ? count : 15) << 4);
+  if (count >= 15) {
+    out = write_length(out, count - 15);
+  }
+  memcpy(out, literals, count);
+  return out + count;
+}
+
+extern size_t compress_bound(size_t size) { return size + size / 255 + 16; }
+
+extern size_t compress_bytes(const void *source, size_t size,
+                             uint8_t *destination) {
+  const uint8_t *in = source, *end = in + size;
+  const uint8_t *literals = in;
+  uint8_t *out = destination;
+  uint32_t table[1 << HASH_BITS] = {0}; /* last position of every hash */
+
+  for (const uint8_t *p = in; end - p >= MIN_MATCH;) {
+    uint32_t word = read32(p);
+    uint32_t hash = (word * 2654435761u) >> (32 - HASH_BITS);
+    const uint8_t *candidate = in + table[hash];
+    table[hash] = (uint32_t)(p - in);
+    if (candidate >= p || p - candidate > MAX_OFFSET ||
+        read32(candidate) != word) {
+      p++;
+      continue;
+    }
+
+    size_t length = MIN_MATCH;
+    while (p + length < end && candidate[length] == p[length]) {
+      length++;
+    }
+    uint8_t *token = out++;
+    out = write_literals(out, token, literals, p - literals);
+    size_t offset = p - candidate;
+    *out++ = offset & 0xff;
+    *out++ = offset >> 8;
+    *token |= length - MIN_MATCH < 15 ? length - MIN_MATCH : 15;
+    if (length - MIN_MATCH >= 15) {
+      out = write_length(out, length - MIN_MATCH - 15);
+    }
+    p += length;
+    literals = p;
+  }
+
+  uint8_t *token = out++;
+  out = write_literals(out, token, literals, end - literals);
+  return out - destination;
+}
+
+extern bool decompress_bytes(const uint8_t *source, size_t source_size,
+                             void *destination, size_t size) {
+  const uint8_t *in = source, *in_end = in + source_size;
+  uint8_t *out = destination, *out_end = out + size;
+
+  while (in < in_end) {
+    uint8_t token = *in++;
+    size_t count = token >> 4;
+    if (count == 15 && !read_length(&in, in_end, &count)) {
+      return false;
+    }
+    if (count > (size_t)(in_end - in) || count > (size_t)(out_end - out)) {
+      return false;
+    }
+    memcpy(out, in, count);
+    in += count;
+    out += count;
+    if (in == in_end) {
+      break;
+    }
+
+    if (in_end - in < 2) {
+      return false;
+    }
+    size_t offset = in[0] | (size_t)in[1] << 8;
+    in += 2;
+    size_t length = token & 15;
+    if (length == 15 && !read_length(&in, in_end, &length)) {
+      return false;
+    }
+    length += MIN_MATCH;
+    if (offset == 0 || offset > (size_t)(out - (uint8_t *)destination) ||
+        length > (size_t)(out_end - out)) {
+      return false;
+    }
+    /* byte by byte, a match may overlap what it produces */
+    for (const uint8_t *match = out - offset; length > 0; length--) {
+      *out++ = *match++;
+    }
+  }
+  return out == out_end;
+}
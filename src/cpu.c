@@ -1,6 +1,13 @@
 #include "../headers/cpu.h"
+#include "../headers/battery.h"
 #include "../headers/cartridge.h"
+#include "../headers/framehash.h"
 #include "../headers/logger.h"
+#include "../headers/persist.h"
+#include "../headers/shared.h"
+#ifdef M6502_PROFILE
+#include "../headers/profile.h"
+#endif
 
 #include <errno.h>
 #include <limits.h>
@@ -28,266 +35,303 @@
  * add clock counter to make drawing easier
  */
 
-typedef void (*instruction_pointer)(void);
+typedef void (*instruction_pointer)(processor_t *processor);
+
+/**
+ * @brief runs the instruction at pc, errors are left in processor->error
+ */
+static void interpret_opcode(processor_t *processor);
+
+#ifdef M6502_UNINIT_CHECK
+static void shadow_read(processor_t *processor, uint16_t address);
+static void shadow_write(processor_t *processor, uint16_t address);
+
+#define SHADOW_READ(address) shadow_read(processor, address)
+#define SHADOW_WRITE(address) shadow_write(processor, address)
+#else
+#define SHADOW_READ(address)
+#define SHADOW_WRITE(address)
+#endif
+
+#ifdef M6502_PROFILE
+#ifdef M6502_PROFILE_BYTES
+#define PROFILE_BYTE(kind, address)                                            \
+  if ((address) < PROFILE_BYTES) {                                             \
+    processor->profile.byte_##kind[(address)]++;                               \
+  }
+#else
+#define PROFILE_BYTE(kind, address)
+#endif
 
-static processor_t processor;
+/* counts an access of `kind` (reads, writes, executes) */
+#define PROFILE_ACCESS(kind, address)                                          \
+  do {                                                                         \
+    processor->profile.kind[(uint16_t)(address) >> 8]++;                       \
+    PROFILE_BYTE(kind, (uint16_t)(address))                                    \
+  } while (0)
+#else
+/* the normal bus doesn't count anything */
+#define PROFILE_ACCESS(kind, address)
+#endif
 
 /* like 150 lines of prototypes, have fun :) */
-static void ADC_absolute(void);
-static void ADC_absolutex(void);
-static void ADC_absolutey(void);
-static void ADC_help(uint16_t value);
-static void ADC_im(void);
-static void ADC_indirectx(void);
-static void ADC_indirecty(void);
-static void ADC_zero(void);
-static void ADC_zerox(void);
-static void AND_absolute(void);
-static void AND_absolutex(void);
-static void AND_absolutey(void);
-static void AND_help(uint8_t value);
-static void AND_im(void);
-static void AND_indirectx(void);
-static void AND_indirecty(void);
-static void AND_zero(void);
-static void AND_zerox(void);
-static void ASL_absolute(void);
-static void ASL_absolutex(void);
-static void ASL_accumulator(void);
-static void ASL_help(uint8_t *address);
-static void ASL_zero(void);
-static void ASL_zerox(void);
-static void BCC(void);
-static void BCS(void);
-static void BEQ(void);
-static void BIT_absolute(void);
-static void BIT_help(uint16_t bit_test);
-static void BIT_zero(void);
-static void BMI(void);
-static void BNE(void);
-static void BPL(void);
-static void BRK(void);
-static void BVC(void);
-static void BVS(void);
-static void CLC(void);
-static void CLD(void);
-static void CLI(void);
-static void CLV(void);
-static void CMP_absolute(void);
-static void CMP_absolutex(void);
-static void CMP_absolutey(void);
-static void CMP_help(unsigned char value);
-static void CMP_im(void);
-static void CMP_indirectx(void);
-static void CMP_indirecty(void);
-static void CMP_zero(void);
-static void CMP_zerox(void);
-static void CPX_absolute(void);
-static void CPX_help(unsigned char value);
-static void CPX_im(void);
-static void CPX_zero(void);
-static void CPY_absolute(void);
-static void CPY_help(unsigned char value);
-static void CPY_im(void);
-static void CPY_zero(void);
-static void DEC_absolute(void);
-static void DEC_absolutex(void);
-static void DEC_help(uint16_t location);
-static void DEC_zero(void);
-static void DEC_zerox(void);
-static void DEX(void);
-static void DEY(void);
-static void EOR_absolute(void);
-static void EOR_absolutex(void);
-static void EOR_absolutey(void);
-static void EOR_help(uint8_t value);
-static void EOR_im(void);
-static void EOR_indirectx(void);
-static void EOR_indirecty(void);
-static void EOR_zero(void);
-static void EOR_zerox(void);
-static void INC_absolute(void);
-static void INC_absolutex(void);
-static void INC_help(uint16_t location);
-static void INC_zero(void);
-static void INC_zerox(void);
-static void INX(void);
-static void INY(void);
-static void JMP_absolute(void);
-static void JMP_indirect(void);
-static void JSR(void);
-static void LDA_absolute(void);
-static void LDA_absolutex(void);
-static void LDA_absolutey(void);
-static void LDA_help(uint8_t value);
-static void LDA_im(void);
-static void LDA_indirectx(void);
-static void LDA_indirecty(void);
-static void LDA_zero(void);
-static void LDA_zerox(void);
-static void LDX_absolute(void);
-static void LDX_absolutey(void);
-static void LDX_help(uint8_t value);
-static void LDX_im(void);
-static void LDX_zero(void);
-static void LDX_zeroy(void);
-static void LDY_absolute(void);
-static void LDY_absolutex(void);
-static void LDY_help(uint8_t value);
-static void LDY_im(void);
-static void LDY_zero(void);
-static void LDY_zerox(void);
-static void LSR_absolute(void);
-static void LSR_absolutex(void);
-static void LSR_accumulator(void);
-static void LSR_help(uint8_t *value);
-static void LSR_zero(void);
-static void LSR_zerox(void);
-static void NOP_zero(void);
-static void NOP_zerox(void);
-static void NOP_im(void);
-static void NOP_absolute(void);
-static void NOP_absolutex(void);
-static void ORA_absolute(void);
-static void ORA_absolutex(void);
-static void ORA_absolutey(void);
-static void ORA_help(uint16_t value);
-static void ORA_im(void);
-static void ORA_indirectx(void);
-static void ORA_indirecty(void);
-static void ORA_zero(void);
-static void ORA_zerox(void);
-static void PHA(void);
-static void PHP(void);
-static void PLA(void);
-static void PLP(void);
-static void ROL_absolute(void);
-static void ROL_absolutex(void);
-static void ROL_accumulator(void);
-static void ROL_help(uint8_t *location);
-static void ROL_zero(void);
-static void ROL_zerox(void);
-static void ROR_absolute(void);
-static void ROR_absolutex(void);
-static void ROR_accumulator(void);
-static void ROR_help(uint8_t *location);
-static void ROR_zero(void);
-static void ROR_zerox(void);
-static void RTI(void);
-static void RTS(void);
-static void SBC_absolute(void);
-static void SBC_absolutex(void);
-static void SBC_absolutey(void);
-static void SBC_help(uint8_t amt);
-static void SBC_im(void);
-static void SBC_indirectx(void);
-static void SBC_indirecty(void);
-static void SBC_zero(void);
-static void SBC_zerox(void);
-static void SEC(void);
-static void SED(void);
-static void SEI(void);
-static void STA_absolute(void);
-static void STA_absolutex(void);
-static void STA_absolutey(void);
-static void STA_indirectx(void);
-static void STA_indirecty(void);
-static void STA_zero(void);
-static void STA_zerox(void);
-static void STX_absolute(void);
-static void STX_zero(void);
-static void STX_zeroy(void);
-static void STY_absolute(void);
-static void STY_zero(void);
-static void STY_zerox(void);
-static void TAX(void);
-static void TAY(void);
-static void TSX(void);
-static void TXA(void);
-static void TXS(void);
-static void TYA(void);
+static void ADC_absolute(processor_t *processor);
+static void ADC_absolutex(processor_t *processor);
+static void ADC_absolutey(processor_t *processor);
+static void ADC_help(processor_t *processor, uint16_t value);
+static void ADC_im(processor_t *processor);
+static void ADC_indirectx(processor_t *processor);
+static void ADC_indirecty(processor_t *processor);
+static void ADC_zero(processor_t *processor);
+static void ADC_zerox(processor_t *processor);
+static void AND_absolute(processor_t *processor);
+static void AND_absolutex(processor_t *processor);
+static void AND_absolutey(processor_t *processor);
+static void AND_help(processor_t *processor, uint8_t value);
+static void AND_im(processor_t *processor);
+static void AND_indirectx(processor_t *processor);
+static void AND_indirecty(processor_t *processor);
+static void AND_zero(processor_t *processor);
+static void AND_zerox(processor_t *processor);
+static void ASL_absolute(processor_t *processor);
+static void ASL_absolutex(processor_t *processor);
+static void ASL_accumulator(processor_t *processor);
+static void ASL_help(processor_t *processor, uint8_t *address);
+static void ASL_zero(processor_t *processor);
+static void ASL_zerox(processor_t *processor);
+static void BCC(processor_t *processor);
+static void BCS(processor_t *processor);
+static void BEQ(processor_t *processor);
+static void BIT_absolute(processor_t *processor);
+static void BIT_help(processor_t *processor, uint16_t bit_test);
+static void BIT_zero(processor_t *processor);
+static void BMI(processor_t *processor);
+static void BNE(processor_t *processor);
+static void BPL(processor_t *processor);
+static void BRK(processor_t *processor);
+static void BVC(processor_t *processor);
+static void BVS(processor_t *processor);
+static void CLC(processor_t *processor);
+static void CLD(processor_t *processor);
+static void CLI(processor_t *processor);
+static void CLV(processor_t *processor);
+static void CMP_absolute(processor_t *processor);
+static void CMP_absolutex(processor_t *processor);
+static void CMP_absolutey(processor_t *processor);
+static void CMP_help(processor_t *processor, unsigned char value);
+static void CMP_im(processor_t *processor);
+static void CMP_indirectx(processor_t *processor);
+static void CMP_indirecty(processor_t *processor);
+static void CMP_zero(processor_t *processor);
+static void CMP_zerox(processor_t *processor);
+static void CPX_absolute(processor_t *processor);
+static void CPX_help(processor_t *processor, unsigned char value);
+static void CPX_im(processor_t *processor);
+static void CPX_zero(processor_t *processor);
+static void CPY_absolute(processor_t *processor);
+static void CPY_help(processor_t *processor, unsigned char value);
+static void CPY_im(processor_t *processor);
+static void CPY_zero(processor_t *processor);
+static void DEC_absolute(processor_t *processor);
+static void DEC_absolutex(processor_t *processor);
+static void DEC_help(processor_t *processor, uint16_t location);
+static void DEC_zero(processor_t *processor);
+static void DEC_zerox(processor_t *processor);
+static void DEX(processor_t *processor);
+static void DEY(processor_t *processor);
+static void EOR_absolute(processor_t *processor);
+static void EOR_absolutex(processor_t *processor);
+static void EOR_absolutey(processor_t *processor);
+static void EOR_help(processor_t *processor, uint8_t value);
+static void EOR_im(processor_t *processor);
+static void EOR_indirectx(processor_t *processor);
+static void EOR_indirecty(processor_t *processor);
+static void EOR_zero(processor_t *processor);
+static void EOR_zerox(processor_t *processor);
+static void INC_absolute(processor_t *processor);
+static void INC_absolutex(processor_t *processor);
+static void INC_help(processor_t *processor, uint16_t location);
+static void INC_zero(processor_t *processor);
+static void INC_zerox(processor_t *processor);
+static void INX(processor_t *processor);
+static void INY(processor_t *processor);
+static void JMP_absolute(processor_t *processor);
+static void JMP_indirect(processor_t *processor);
+static void JSR(processor_t *processor);
+static void LDA_absolute(processor_t *processor);
+static void LDA_absolutex(processor_t *processor);
+static void LDA_absolutey(processor_t *processor);
+static void LDA_help(processor_t *processor, uint8_t value);
+static void LDA_im(processor_t *processor);
+static void LDA_indirectx(processor_t *processor);
+static void LDA_indirecty(processor_t *processor);
+static void LDA_zero(processor_t *processor);
+static void LDA_zerox(processor_t *processor);
+static void LDX_absolute(processor_t *processor);
+static void LDX_absolutey(processor_t *processor);
+static void LDX_help(processor_t *processor, uint8_t value);
+static void LDX_im(processor_t *processor);
+static void LDX_zero(processor_t *processor);
+static void LDX_zeroy(processor_t *processor);
+static void LDY_absolute(processor_t *processor);
+static void LDY_absolutex(processor_t *processor);
+static void LDY_help(processor_t *processor, uint8_t value);
+static void LDY_im(processor_t *processor);
+static void LDY_zero(processor_t *processor);
+static void LDY_zerox(processor_t *processor);
+static void LSR_absolute(processor_t *processor);
+static void LSR_absolutex(processor_t *processor);
+static void LSR_accumulator(processor_t *processor);
+static void LSR_help(processor_t *processor, uint8_t *value);
+static void LSR_zero(processor_t *processor);
+static void LSR_zerox(processor_t *processor);
+static void NOP_zero(processor_t *processor);
+static void NOP_zerox(processor_t *processor);
+static void NOP_im(processor_t *processor);
+static void NOP_absolute(processor_t *processor);
+static void NOP_absolutex(processor_t *processor);
+static void ORA_absolute(processor_t *processor);
+static void ORA_absolutex(processor_t *processor);
+static void ORA_absolutey(processor_t *processor);
+static void ORA_help(processor_t *processor, uint16_t value);
+static void ORA_im(processor_t *processor);
+static void ORA_indirectx(processor_t *processor);
+static void ORA_indirecty(processor_t *processor);
+static void ORA_zero(processor_t *processor);
+static void ORA_zerox(processor_t *processor);
+static void PHA(processor_t *processor);
+static void PHP(processor_t *processor);
+static void PLA(processor_t *processor);
+static void PLP(processor_t *processor);
+static void ROL_absolute(processor_t *processor);
+static void ROL_absolutex(processor_t *processor);
+static void ROL_accumulator(processor_t *processor);
+static void ROL_help(processor_t *processor, uint8_t *location);
+static void ROL_zero(processor_t *processor);
+static void ROL_zerox(processor_t *processor);
+static void ROR_absolute(processor_t *processor);
+static void ROR_absolutex(processor_t *processor);
+static void ROR_accumulator(processor_t *processor);
+static void ROR_help(processor_t *processor, uint8_t *location);
+static void ROR_zero(processor_t *processor);
+static void ROR_zerox(processor_t *processor);
+static void RTI(processor_t *processor);
+static void RTS(processor_t *processor);
+static void SBC_absolute(processor_t *processor);
+static void SBC_absolutex(processor_t *processor);
+static void SBC_absolutey(processor_t *processor);
+static void SBC_help(processor_t *processor, uint8_t amt);
+static void SBC_im(processor_t *processor);
+static void SBC_indirectx(processor_t *processor);
+static void SBC_indirecty(processor_t *processor);
+static void SBC_zero(processor_t *processor);
+static void SBC_zerox(processor_t *processor);
+static void SEC(processor_t *processor);
+static void SED(processor_t *processor);
+static void SEI(processor_t *processor);
+static void STA_absolute(processor_t *processor);
+static void STA_absolutex(processor_t *processor);
+static void STA_absolutey(processor_t *processor);
+static void STA_indirectx(processor_t *processor);
+static void STA_indirecty(processor_t *processor);
+static void STA_zero(processor_t *processor);
+static void STA_zerox(processor_t *processor);
+static void STX_absolute(processor_t *processor);
+static void STX_zero(processor_t *processor);
+static void STX_zeroy(processor_t *processor);
+static void STY_absolute(processor_t *processor);
+static void STY_zero(processor_t *processor);
+static void STY_zerox(processor_t *processor);
+static void TAX(processor_t *processor);
+static void TAY(processor_t *processor);
+static void TSX(processor_t *processor);
+static void TXA(processor_t *processor);
+static void TXS(processor_t *processor);
+static void TYA(processor_t *processor);
 
 #ifdef UNOFFICIAL_OPCODES
 
-static void ALR(void);
-static void ARR(void);
-static void XAA(void);
-static void ANC(void);
-static void ASO_absolute(void);
-static void ASO_absolutex(void);
-static void ASO_absolutey(void);
-static void ASO_indirectx(void);
-static void ASO_indirecty(void);
-static void ASO_zero(void);
-static void ASO_zerox(void);
-static void AXA_absolutey(void);
-static void AXA_indirecty(void);
-static void AXS_absolute(void);
-static void AXS_indirectx(void);
-static void AXS_zero(void);
-static void AXS_zeroy(void);
-static void DCM_absolute(void);
-static void DCM_absolutex(void);
-static void DCM_absolutey(void);
-static void DCM_help(uint8_t *address);
-static void DCM_indirectx(void);
-static void DCM_indirecty(void);
-static void DCM_zero(void);
-static void DCM_zerox(void);
-static void HLT(void);
-static void INS_absolute(void);
-static void INS_absolutex(void);
-static void INS_absolutey(void);
-static void INS_help(uint8_t *address);
-static void INS_indirectx(void);
-static void INS_indirecty(void);
-static void INS_zero(void);
-static void INS_zerox(void);
-static void LAS(void);
-static void LAX_absolute(void);
-static void LAX_absolutey(void);
-static void LAX_indirectx(void);
-static void LAX_indirecty(void);
-static void LAX_zero(void);
-static void LAX_zeroy(void);
-static void LSE_absolute(void);
-static void LSE_absolutex(void);
-static void LSE_absolutey(void);
-static void LSE_indirectx(void);
-static void LSE_indirecty(void);
-static void LSE_zero(void);
-static void LSE_zerox(void);
-static void OAL(void);
-static void SAX(void);
-static void RLA_absolute(void);
-static void RLA_absolutex(void);
-static void RLA_absolutey(void);
-static void RLA_indirectx(void);
-static void RLA_indirecty(void);
-static void RLA_zero(void);
-static void RLA_zerox(void);
-static void RRA_absolute(void);
-static void RRA_absolutex(void);
-static void RRA_absolutey(void);
-static void RRA_indirectx(void);
-static void RRA_indirecty(void);
-static void RRA_zero(void);
-static void RRA_zerox(void);
-static void SAY(void);
-static void TAS(void);
-static void XAS(void);
+static void ALR(processor_t *processor);
+static void ARR(processor_t *processor);
+static void XAA(processor_t *processor);
+static void ANC(processor_t *processor);
+static void ASO_absolute(processor_t *processor);
+static void ASO_absolutex(processor_t *processor);
+static void ASO_absolutey(processor_t *processor);
+static void ASO_indirectx(processor_t *processor);
+static void ASO_indirecty(processor_t *processor);
+static void ASO_zero(processor_t *processor);
+static void ASO_zerox(processor_t *processor);
+static void AXA_absolutey(processor_t *processor);
+static void AXA_indirecty(processor_t *processor);
+static void AXS_absolute(processor_t *processor);
+static void AXS_indirectx(processor_t *processor);
+static void AXS_zero(processor_t *processor);
+static void AXS_zeroy(processor_t *processor);
+static void DCM_absolute(processor_t *processor);
+static void DCM_absolutex(processor_t *processor);
+static void DCM_absolutey(processor_t *processor);
+static void DCM_help(processor_t *processor, uint8_t *address);
+static void DCM_indirectx(processor_t *processor);
+static void DCM_indirecty(processor_t *processor);
+static void DCM_zero(processor_t *processor);
+static void DCM_zerox(processor_t *processor);
+static void HLT(processor_t *processor);
+static void INS_absolute(processor_t *processor);
+static void INS_absolutex(processor_t *processor);
+static void INS_absolutey(processor_t *processor);
+static void INS_help(processor_t *processor, uint8_t *address);
+static void INS_indirectx(processor_t *processor);
+static void INS_indirecty(processor_t *processor);
+static void INS_zero(processor_t *processor);
+static void INS_zerox(processor_t *processor);
+static void LAS(processor_t *processor);
+static void LAX_absolute(processor_t *processor);
+static void LAX_absolutey(processor_t *processor);
+static void LAX_indirectx(processor_t *processor);
+static void LAX_indirecty(processor_t *processor);
+static void LAX_zero(processor_t *processor);
+static void LAX_zeroy(processor_t *processor);
+static void LSE_absolute(processor_t *processor);
+static void LSE_absolutex(processor_t *processor);
+static void LSE_absolutey(processor_t *processor);
+static void LSE_indirectx(processor_t *processor);
+static void LSE_indirecty(processor_t *processor);
+static void LSE_zero(processor_t *processor);
+static void LSE_zerox(processor_t *processor);
+static void OAL(processor_t *processor);
+static void SAX(processor_t *processor);
+static void RLA_absolute(processor_t *processor);
+static void RLA_absolutex(processor_t *processor);
+static void RLA_absolutey(processor_t *processor);
+static void RLA_indirectx(processor_t *processor);
+static void RLA_indirecty(processor_t *processor);
+static void RLA_zero(processor_t *processor);
+static void RLA_zerox(processor_t *processor);
+static void RRA_absolute(processor_t *processor);
+static void RRA_absolutex(processor_t *processor);
+static void RRA_absolutey(processor_t *processor);
+static void RRA_indirectx(processor_t *processor);
+static void RRA_indirecty(processor_t *processor);
+static void RRA_zero(processor_t *processor);
+static void RRA_zerox(processor_t *processor);
+static void SAY(processor_t *processor);
+static void TAS(processor_t *processor);
+static void XAS(processor_t *processor);
 
 #endif
 /**
  * @brief does comparison for the different CMP instructions
  */
-static void cmp_help(unsigned char value, unsigned char reg);
+static void cmp_help(processor_t *processor, unsigned char value,
+                     unsigned char reg);
 
 /* theese just check for what the name says and sets the status based on that */
-static inline void zero_check(uint8_t value);
-static inline void carry_check(uint16_t value);
-static inline void negative_check(uint8_t value);
-static inline void overflow_check(uint16_t value, uint16_t result);
+static inline void zero_check(processor_t *processor, uint8_t value);
+static inline void carry_check(processor_t *processor, uint16_t value);
+static inline void negative_check(processor_t *processor, uint8_t value);
+static inline void overflow_check(processor_t *processor, uint16_t value,
+                                  uint16_t result);
 
 /**
  * @brief does a simple check if the page has been crossed
@@ -298,83 +342,384 @@ static inline void overflow_check(uint16_t value, uint16_t result);
  */
 static inline unsigned long long page_check(uint16_t address, uint8_t reg);
 
-static inline uint8_t *dereference_address(uint16_t address);
-static inline uint8_t *indexed_indirect(uint16_t address);
+static inline uint8_t *dereference_address(processor_t *processor,
+                                           uint16_t address);
+static inline uint16_t indexed_indirect(processor_t *processor,
+                                        uint16_t address);
 /* might get turnt into a macro so the function can access the address */
 
-static inline unsigned char pop_from_stack(void);
-static inline unsigned char peek_from_stack(void);
-static inline void push_to_stack(unsigned char value);
+static inline unsigned char pop_from_stack(processor_t *processor);
+static inline unsigned char peek_from_stack(processor_t *processor);
+static inline void push_to_stack(processor_t *processor, unsigned char value);
+
+static inline void write_byte(processor_t *processor, uint8_t value,
+                              uint16_t location);
+
+/**
+ * @brief copies the page `page` into oam starting at OAMADDR and stalls the
+ * cpu for the duration of the transfer
+ */
+static void oam_dma(processor_t *processor, uint8_t page);
+
+/**
+ * @brief builds the page table for the memory map, prg ram comes from the
+ * battery if there is one
+ */
+static void map_memory(processor_t *processor);
+
+/**
+ * @brief points the pages of [start, start + length) at `base`, wrapping
+ * around every `mirror` bytes
+ */
+static void map_pages(processor_t *processor, uint16_t start, size_t length,
+                      uint8_t *base, size_t mirror);
+
+/**
+ * @brief rebuilds the read/write page tables from `pages`, leaving every page
+ * that holds a watched byte NULL
+ */
+static void update_traps(processor_t *processor);
 
-static inline void write_byte(uint8_t value, uint16_t location);
+/* slow paths for pages with watchpoints */
+static uint8_t trapped_read(processor_t *processor, uint16_t address);
+static void trapped_write(processor_t *processor, uint8_t value,
+                          uint16_t address);
+static uint8_t *trapped_dereference(processor_t *processor, uint16_t address);
 
 /**
  * @brief reads 2 bytes (little endian) and combines them into
  a 16bit unsigned
  * assumes that thereemacs's atleast 2 bytes to read, note increment PC by 2
  */
-static inline uint16_t read_word();
+static inline uint16_t read_word(processor_t *processor);
 
 /**
  * @brief reads 1 byte (little endian), note increment PC
  */
-static inline uint8_t read_byte();
+static inline uint8_t read_byte(processor_t *processor);
 
 /**
  * @brief same as @see{read_byte} but for a specific location
  */
-static inline uint8_t read_byte_at(uint16_t location);
+static inline uint8_t read_byte_at(processor_t *processor, uint16_t location);
+
+/**
+ * @brief reads `location` without counting it as a data access, used for
+ * fetching instructions
+ */
+static inline uint8_t fetch_byte_at(processor_t *processor, uint16_t location);
 
 /**
  * @brief same as @see{read_word} but for a specific location
  */
-static inline uint16_t read_word_at(uint16_t location);
+static inline uint16_t read_word_at(processor_t *processor, uint16_t location);
+
+static processor_t *create(const char *rom_path, bool battery) {
+  if (rom_path == NULL) {
+    fprintf(stderr, ANSI_RED "ERROR: path NULL" ANSI_END);
+    return NULL;
+  }
+  if (access(rom_path, F_OK) == -1) {
+    printf("\n\nERROR: %s\n\n", strerror(errno));
+    return NULL;
+  }
 
-extern void initialize_cpu(cartridge_t *cart) {
+  cartridge_t *cart = open_program(rom_path);
   if (cart == NULL) {
-    fprintf(stderr, ANSI_RED "ERROR: cart is undefined" ANSI_END);
+    return NULL;
+  }
+
+  processor_t *processor = calloc(1, sizeof(processor_t));
+  if (processor == NULL) {
+    free_cartridge(cart);
+    return NULL;
+  }
+
+  processor->rom_size = (size_t)0x4000 * cart->header.prg_rom_size;
+  if (processor->rom_size > PRG_ROM_WINDOW) {
+    processor->rom_size = PRG_ROM_WINDOW; /* no mappers yet, only 32k fit */
+  }
+  memcpy(processor->memory + PRG_ROM_START, cart->prg_rom,
+         processor->rom_size);
+
+  if (battery && (cart->header.flags6 & FLAGS6_BATTERY)) {
+    processor->battery = open_battery(rom_path, PRG_RAM_SIZE);
+  }
+  free_cartridge(cart);
+
+  m6502_reset(processor);
+  return processor;
+}
+
+extern processor_t *m6502_create(const char *rom_path) {
+  return create(rom_path, true);
+}
+
+extern processor_t *m6502_create_headless(const char *rom_path) {
+  return create(rom_path, false);
+}
+
+extern void m6502_destroy(processor_t *processor) {
+  if (processor == NULL) {
     return;
   }
+  close_battery(processor->battery);
+  close_shared(processor->shared);
+  close_frame_hasher(processor->hasher);
+  close_persist(processor->persist);
+  close_log(processor);
+  free(processor);
+}
+
+extern void m6502_reset(processor_t *processor) {
+  processor->registers._sp = 0xfd;
+  processor->registers.accumulator = 0;
+  processor->registers.x = 0;
+  processor->registers.y = 0;
+  processor->registers.pc = 0xc000;
+  processor->registers.status = 0;
+  processor->clock_ticks = 0;
+  processor->frame = 0;
+  processor->frame_end = FRAME_CYCLES;
+  processor->error = SUCCESS;
+  processor->controller_shift = 0;
+  processor->controller_strobe = false;
+  processor->controller_polled = false;
+  processor->lag_frame = false;
+
+  /* everything up to the rom */
+  memset(processor->memory, 0x0, PRG_ROM_START);
+  memset(processor->oam, 0x0, OAM_SIZE);
+#ifdef M6502_UNINIT_CHECK
+  memset(processor->written, 0, sizeof(processor->written));
+  processor->uninitialised_read = false;
+#endif
 
-  processor.registers._sp = 0xfd;
-  processor.registers.accumulator = 0;
-  processor.registers.x = 0;
-  processor.registers.y = 0;
-  processor.registers.pc = 0xc000;
-  processor.registers.status = 0;
+#ifdef M6502_UNINIT_CHECK
+  if (processor->battery != NULL) {
+    /* whatever the save holds counts as written */
+    memset(processor->written + INTERNAL_RAM_SIZE / 8, 0xff,
+           PRG_RAM_SIZE / 8);
+  }
+#endif
+  map_memory(processor);
+}
+
+static void map_memory(processor_t *processor) {
+  /* 2k of internal ram mirrored up to $1fff, the ppu registers are mirrored
+   * up to $3fff (only per page, the 8 byte mirroring inside a page is not
+   * done), 16k roms are mirrored into $c000 */
+  map_pages(processor, 0x0000, 0x2000, processor->memory, INTERNAL_RAM_SIZE);
+  map_pages(processor, 0x2000, 0x2000, processor->memory + PPU_REGISTERS_START,
+            BUS_PAGE_SIZE);
+  map_pages(processor, 0x4000, 0x2000, processor->memory + 0x4000, 0x2000);
+  map_pages(processor, PRG_ROM_START, PRG_ROM_WINDOW,
+            processor->memory + PRG_ROM_START,
+            processor->rom_size != 0 ? processor->rom_size : PRG_ROM_WINDOW);
+
+  if (processor->battery != NULL) {
+    map_pages(processor, PRG_RAM_START, PRG_RAM_SIZE,
+              battery_memory(processor->battery), PRG_RAM_SIZE);
+  } else {
+    map_pages(processor, PRG_RAM_START, PRG_RAM_SIZE,
+              processor->memory + PRG_RAM_START, PRG_RAM_SIZE);
+  }
+}
 
-  memset(&processor.memory, 0x0, 0xffff);
-  memcpy(processor.memory + 0x8000, cart->prg_rom, 0x4000);
+/* everything that happens once per frame, the frame ends with the first
+ * instruction that crosses the boundary */
+static void end_frame(processor_t *processor) {
+  processor->frame++;
+  processor->frame_end += FRAME_CYCLES;
+  processor->lag_frame = !processor->controller_polled;
+  processor->controller_polled = false;
+  if (processor->shared != NULL) {
+    publish_shared(processor->shared, processor);
+  }
+  if (processor->hasher != NULL) {
+    update_frame_hash(processor->hasher, processor);
+  }
+  if (processor->persist != NULL) {
+    persist_frame(processor->persist, processor);
+  }
 }
 
-/**
-   @brief given a file name, if it exists initialize the processor based on the
-   data in it
-   @param path to file
-*/
-extern bool initialize_cpu_filename(char *path) {
-  if (path == NULL) {
-    fprintf(stderr, ANSI_RED "ERROR: path NULL" ANSI_END);
-    return false;
+extern void m6502_detach(processor_t *processor) {
+  if (processor->battery != NULL) {
+    /* the save stays mapped, nothing writes to it anymore */
+    memcpy(processor->memory + PRG_RAM_START,
+           battery_memory(processor->battery), PRG_RAM_SIZE);
+    processor->battery = NULL;
+    map_memory(processor);
   }
-  if (access(path, F_OK) == -1) {
-    printf("\n\nERROR: %s\n\n", strerror(errno));
+  processor->shared = NULL;
+  processor->log = NULL;
+  processor->hasher = NULL;
+  processor->persist = NULL;
+}
+
+extern processor_t *m6502_clone(const processor_t *processor) {
+  processor_t *clone = malloc(sizeof(processor_t));
+  if (clone == NULL) {
+    return NULL;
+  }
+  memcpy(clone, processor, sizeof(processor_t));
+  /* the page table still points into the original */
+  memcpy(clone->memory + PRG_RAM_START,
+         processor->pages[PRG_RAM_START >> 8], PRG_RAM_SIZE);
+  clone->battery = NULL;
+  clone->shared = NULL;
+  clone->log = NULL;
+  clone->hasher = NULL;
+  clone->persist = NULL;
+  map_memory(clone);
+  return clone;
+}
+
+extern int m6502_run(processor_t *processor, unsigned long long cycles) {
+  unsigned long long target = processor->clock_ticks + cycles;
+  if (processor->error == WATCHPOINT_HIT) {
+    processor->error = SUCCESS;
+  }
+  while (processor->clock_ticks < target && processor->error == SUCCESS) {
+    /* the inner loop only has to compare against one end */
+    unsigned long long end =
+        target < processor->frame_end ? target : processor->frame_end;
+    while (processor->clock_ticks < end && processor->error == SUCCESS) {
+      interpret_opcode(processor);
+    }
+    if (processor->clock_ticks >= processor->frame_end) {
+      end_frame(processor);
+    }
+  }
+  return processor->error;
+}
+
+extern int m6502_run_frames(processor_t *processor, unsigned frames) {
+  unsigned long long target = processor->frame + frames;
+  int error = SUCCESS;
+  while (processor->frame < target && error == SUCCESS) {
+    error = m6502_run(processor, processor->frame_end - processor->clock_ticks);
+  }
+  return error;
+}
+
+extern int m6502_step(processor_t *processor) {
+  if (processor->error == WATCHPOINT_HIT) {
+    processor->error = SUCCESS;
+  }
+  if (processor->error == SUCCESS) {
+    interpret_opcode(processor);
+    if (processor->clock_ticks >= processor->frame_end) {
+      end_frame(processor);
+    }
+  }
+  return processor->error;
+}
+
+extern const char *m6502_strerror(int error) {
+  static const char *const messages[] = {
+      [SUCCESS] = "success",
+      [STACK_OVERFLOW] = "stack overflow",
+      [STACK_UNDERFLOW] = "stack underflow",
+      [WATCHPOINT_HIT] = "watchpoint hit",
+      [INVALID_OPCODE] = "invalid opcode",
+      [HALTED] = "cpu halted",
+  };
+  if (error < 0 || (size_t)error >= sizeof(messages) / sizeof(*messages)) {
+    return "unknown error";
+  }
+  return messages[error];
+}
+
+extern uint8_t m6502_peek(const processor_t *processor, uint16_t address) {
+  return processor->pages[address >> 8][address & 0xff];
+}
+
+extern void m6502_set_controller(processor_t *processor, uint8_t buttons) {
+  processor->controller = buttons;
+}
+
+extern bool m6502_lag_frame(const processor_t *processor) {
+  return processor->lag_frame;
+}
+
+extern bool m6502_open_log(processor_t *processor, const char *path) {
+  return init_log(processor, path);
+}
+
+#ifdef M6502_PROFILE
+extern void m6502_reset_access_profile(processor_t *processor) {
+  memset(&processor->profile, 0, sizeof(processor->profile));
+}
+
+extern bool m6502_dump_access_profile(const processor_t *processor,
+                                      const char *path) {
+  FILE *fp = fopen(path, "wb");
+  if (fp == NULL) {
+    fprintf(stderr, ANSI_RED "ERROR: could not open %s: %s" ANSI_END "\n", path,
+            strerror(errno));
     return false;
   }
 
-  cartridge_t *cart = open_program(path);
-  initialize_cpu(cart);
+  const char *extension = strrchr(path, '.');
+  bool ok = extension != NULL && strcmp(extension, ".bin") == 0
+                ? write_profile_binary(&processor->profile, fp)
+                : write_profile_csv(&processor->profile, fp);
+  return fclose(fp) == 0 && ok;
+}
+#endif
+
+#ifdef M6502_UNINIT_CHECK
+/* index into `written`, -1 for addresses that aren't ram */
+static inline int shadow_index(uint16_t address) {
+  if (address < PPU_REGISTERS_START) {
+    return address & (INTERNAL_RAM_SIZE - 1);
+  }
+  if (address >= PRG_RAM_START && address < PRG_RAM_START + PRG_RAM_SIZE) {
+    return INTERNAL_RAM_SIZE + (address - PRG_RAM_START);
+  }
+  return -1;
+}
+
+static void shadow_read(processor_t *processor, uint16_t address) {
+  int index = shadow_index(address);
+  if (index == -1 || (processor->written[index >> 3] & (1 << (index & 7)))) {
+    return;
+  }
 
-  atexit(&close_log);
-  init_log();
+  fprintf(stderr,
+          ANSI_YELLOW
+          "WARNING: read of uninitialised $%04X at PC $%04X" ANSI_END "\n",
+          address, processor->instruction_pc);
+  if (!processor->uninitialised_read) {
+    processor->uninitialised_read = true;
+    processor->uninitialised_address = address;
+    processor->uninitialised_pc = processor->instruction_pc;
+  }
+  /* only the first read of each byte is reported */
+  processor->written[index >> 3] |= 1 << (index & 7);
+}
 
-  free_cartridge(cart);
+static void shadow_write(processor_t *processor, uint16_t address) {
+  int index = shadow_index(address);
+  if (index != -1) {
+    processor->written[index >> 3] |= 1 << (index & 7);
+  }
+}
 
-  return true;
+extern bool m6502_first_uninitialised_read(const processor_t *processor,
+                                           uint16_t *address, uint16_t *pc) {
+  if (processor->uninitialised_read) {
+    *address = processor->uninitialised_address;
+    *pc = processor->uninitialised_pc;
+  }
+  return processor->uninitialised_read;
 }
+#endif
 
 /* parser, pass data to initialize cpu and this does the rest */
-extern void interpret_opcode(void) {
+static void interpret_opcode(processor_t *processor) {
   /* there's a lot of boilerplate code, MAYBE it can be reduced with some macro
    * hax but probably not, plus it would be quite cryptic then (they do follow a
    * pattern) */
@@ -676,159 +1021,313 @@ extern void interpret_opcode(void) {
       [0x9e] = &XAS,
 #endif
   };
-  log_cpu(processor);
-  unsigned char opcode = read_byte();
+  processor->instruction_pc = processor->registers.pc;
+  processor->instruction_ticks = processor->clock_ticks;
+  if (processor->log != NULL) {
+    log_cpu(processor);
+  }
+  unsigned char opcode = read_byte(processor);
 
   if (instructions[opcode]) {
-    instructions[opcode]();
+    instructions[opcode](processor);
   } else {
-    printf("\033[1;31m invalid opcode: %x\033[0m\n", opcode);
-    printf("PC: %x\n", processor.registers.pc);
+    processor->error = INVALID_OPCODE;
   }
 }
 
-static inline void copy_to_stack(unsigned char value) {
-  processor.memory[STACK_START + processor.registers._sp] = value;
+static inline void copy_to_stack(processor_t *processor, unsigned char value) {
+  write_byte(processor, value, STACK_START + processor->registers._sp);
 }
 
-static inline void push_word_to_stack(uint16_t value) {
-  if (processor.registers._sp - 2 < processor.registers._sp) {
-    processor.memory[STACK_START + (processor.registers._sp--)] = value >> 8;
-    processor.memory[STACK_START + (processor.registers._sp--)] = value & 0xff;
+static inline void push_word_to_stack(processor_t *processor, uint16_t value) {
+  if (processor->registers._sp - 2 < processor->registers._sp) {
+    write_byte(processor, value >> 8,
+               STACK_START + (processor->registers._sp--));
+    write_byte(processor, value & 0xff,
+               STACK_START + (processor->registers._sp--));
   } else {
-    fprintf(stderr, "Stack Overflow, exitting");
-    exit(STACK_OVERFLOW);
+    processor->error = STACK_OVERFLOW;
   }
 }
 
-static inline uint16_t pop_word_from_stack(void) {
+static inline uint16_t pop_word_from_stack(processor_t *processor) {
   uint16_t value = 0;
-  if (processor.registers._sp + 2 > processor.registers._sp) {
-    value = processor.memory[STACK_START + (++processor.registers._sp)];
-    value |= processor.memory[STACK_START + (++processor.registers._sp)] << 8;
+  if (processor->registers._sp + 2 > processor->registers._sp) {
+    value = read_byte_at(processor, STACK_START + (++processor->registers._sp));
+    value |= read_byte_at(processor,
+                          STACK_START + (++processor->registers._sp)) << 8;
   } else {
-    fprintf(stderr, "Stack Overflow, exitting");
-    exit(STACK_OVERFLOW);
+    processor->error = STACK_UNDERFLOW;
   }
   return value;
 }
 
-static inline void push_to_stack(unsigned char value) {
-  if (processor.registers._sp - 1 < processor.registers._sp) {
-    processor.memory[STACK_START + (processor.registers._sp--)] = value;
+static inline void push_to_stack(processor_t *processor, unsigned char value) {
+  if (processor->registers._sp - 1 < processor->registers._sp) {
+    write_byte(processor, value, STACK_START + (processor->registers._sp--));
   } else {
-    fprintf(stderr, "Stack Overflow exception, exitting");
-    exit(STACK_OVERFLOW);
+    processor->error = STACK_OVERFLOW;
   }
 }
 
-static inline unsigned char pop_from_stack(void) {
-  if (processor.registers._sp + 1 > processor.registers._sp) {
-    return processor.memory[STACK_START + (++processor.registers._sp)];
+static inline unsigned char pop_from_stack(processor_t *processor) {
+  if (processor->registers._sp + 1 > processor->registers._sp) {
+    return read_byte_at(processor, STACK_START + (++processor->registers._sp));
   } else {
-    fprintf(stderr, "Stack Underflow exception, exitting");
-    exit(STACK_UNDERFLOW);
+    processor->error = STACK_UNDERFLOW;
+    return 0;
   }
 }
 
-static inline unsigned char peek_from_stack(void) {
-  return processor.memory[STACK_START + processor.registers._sp - 1];
+static inline unsigned char peek_from_stack(processor_t *processor) {
+  return read_byte_at(processor, STACK_START + processor->registers._sp - 1);
 }
 
-static inline uint8_t *indexed_indirect(uint16_t address) {
-  uint16_t _location = read_word_at(address);
-  uint16_t location = read_byte_at(_location + processor.registers.x);
-  return &processor.memory[location];
+/* both only work out the address, the access itself goes through the page
+ * table like every other one so watchpoints, mirrors and the profile see it */
+static inline uint16_t indexed_indirect(processor_t *processor,
+                                        uint16_t address) {
+  uint16_t _location = read_word_at(processor, address);
+  return read_byte_at(processor, _location + processor->registers.x);
 }
 
 /* reasoning for being a macro is that for some undocumented opcodes
  * you need to check if it pages with `location` but not with all and it's
  * unnecessary to add some bool checks etc */
 #define indirect_indexed(address)                                              \
-  uint8_t _location = read_byte_at((address));                                 \
-  uint8_t location = read_byte_at(_location);                                  \
-  uint8_t *value = &processor.memory[location + processor.registers.y];
+  uint8_t _location = read_byte_at(processor, (address));                      \
+  uint8_t location = read_byte_at(processor, _location);                       \
+  uint16_t target = location + processor->registers.y;
 
 static inline __attribute__((__always_inline__)) uint8_t *
-dereference_address(uint16_t address) {
-  switch (address >> 14) {
-  case 1:
-    address &= ~0xffffc000; /* PRG RAM */
-    break;
-  case 2:
-    address &= ~0xffffdff8; /* APU */
-    break;
-  case 3:
-    address &= ~0xffff4000; /* PRG ROM */
-    break;
+dereference_address(processor_t *processor, uint16_t address) {
+  PROFILE_ACCESS(reads, address);
+  PROFILE_ACCESS(writes, address);
+  SHADOW_READ(address);
+  SHADOW_WRITE(address);
+  uint8_t *page = processor->write_pages[address >> 8];
+  if (page != NULL && processor->read_pages[address >> 8] != NULL) {
+    return &page[address & 0xff];
   }
-  return &processor.memory[address]; /* always in range due to address being an
-                              2 bytes long */
+  return trapped_dereference(processor, address);
 }
 
-static inline uint16_t read_word() {
-  uint16_t value = read_word_at(processor.registers.pc);
-  processor.registers.pc += 2;
+static inline uint16_t read_word(processor_t *processor) {
+  uint16_t value = fetch_byte_at(processor, processor->registers.pc) |
+                   (fetch_byte_at(processor, processor->registers.pc + 1) << 8);
+  processor->registers.pc += 2;
   return value;
 }
 
-static inline uint16_t read_word_at(uint16_t address) {
-  switch (address >> 14) {
-  case 1:
-    address &= ~0xffffc000;
-    break;
-  case 2:
-    address &= ~0xffffdff8;
-    break;
-  case 3:
-    address &= ~0xffff4000;
-    break;
-  }
-  uint16_t value =
-      (processor.memory[address + 1] << 8) | processor.memory[address];
+static inline uint16_t read_word_at(processor_t *processor, uint16_t address) {
+  uint16_t value = (read_byte_at(processor,
+                                 address + 1) << 8) | read_byte_at(processor,
+                                                                   address);
   return value;
 }
 
-static inline uint8_t read_byte_at(uint16_t address) {
-  switch (address >> 14) {
-  case 1:
-    address &= ~0xffffc000; /* PRG RAM */
-    break;
-  case 2:
-    address &= ~0xffffdff8; /* APU */
-    break;
-  case 3:
-    address &= ~0xffff4000; /* PRG ROM */
-    break;
+static inline uint8_t read_byte_at(processor_t *processor, uint16_t address) {
+  PROFILE_ACCESS(reads, address);
+  SHADOW_READ(address);
+  const uint8_t *page = processor->read_pages[address >> 8];
+  if (page != NULL) {
+    return page[address & 0xff];
   }
-  uint8_t value = processor.memory[address];
-  return value;
+  return trapped_read(processor, address);
+}
+
+static inline uint8_t fetch_byte_at(processor_t *processor, uint16_t address) {
+  PROFILE_ACCESS(executes, address);
+  SHADOW_READ(address);
+  return processor->pages[address >> 8][address & 0xff];
 }
 
-static inline uint8_t read_byte() {
-  uint8_t value = read_byte_at(processor.registers.pc++);
+static inline uint8_t read_byte(processor_t *processor) {
+  uint8_t value = fetch_byte_at(processor, processor->registers.pc++);
   return value;
 }
 
-static inline void write_byte(uint8_t value, uint16_t location) {
-  if (location < 0x2000) {
-    location &= ~0xfffff800;
+static inline void write_byte(processor_t *processor, uint8_t value,
+                              uint16_t location) {
+  PROFILE_ACCESS(writes, location);
+  SHADOW_WRITE(location);
+  uint8_t *page = processor->write_pages[location >> 8];
+  if (page != NULL) {
+    page[location & 0xff] = value;
+    return;
+  }
+  trapped_write(processor, value, location);
+}
+
+/* the source page goes through the page table so ram mirrors and prg ram
+ * work, the 256 reads/writes are done as one copy and the cpu is stalled for
+ * 513 cycles, 514 if the dma started on an odd cycle */
+static void oam_dma(processor_t *processor, uint8_t page) {
+  const uint8_t *source = processor->pages[page];
+  uint8_t start = processor->memory[OAM_ADDR];
+#ifdef M6502_PROFILE
+  processor->profile.reads[page] += OAM_SIZE;
+#endif
+
+  memcpy(processor->oam + start, source, OAM_SIZE - start);
+  memcpy(processor->oam, source + OAM_SIZE - start, start);
+  processor->clock_ticks += OAM_DMA_CYCLES + (processor->clock_ticks & 1);
+}
+
+static void map_pages(processor_t *processor, uint16_t start, size_t length,
+                      uint8_t *base, size_t mirror) {
+  for (size_t offset = 0; offset < length; offset += BUS_PAGE_SIZE) {
+    processor->pages[(start + offset) >> 8] = base + offset % mirror;
+  }
+  update_traps(processor);
+}
+
+static void update_traps(processor_t *processor) {
+  memcpy(processor->read_pages, processor->pages, sizeof(processor->pages));
+  memcpy(processor->write_pages, processor->pages, sizeof(processor->pages));
+
+  for (size_t i = 0; i < processor->watchpoint_count; i++) {
+    const watchpoint_t *watchpoint = &processor->watchpoints[i];
+    /* every page backed by the same memory, so mirrors trap too */
+    const uint8_t *watched = processor->pages[watchpoint->address >> 8];
+    for (size_t page = 0; page < BUS_PAGES; page++) {
+      if (processor->pages[page] != watched) {
+        continue;
+      }
+      if (watchpoint->kind & WATCH_READ) {
+        processor->read_pages[page] = NULL;
+      }
+      if (watchpoint->kind & WATCH_WRITE) {
+        processor->write_pages[page] = NULL;
+      }
+    }
+  }
+
+  /* the io registers have side effects, they always take the slow path */
+  processor->read_pages[IO_REGISTERS_START >> 8] = NULL;
+  processor->write_pages[IO_REGISTERS_START >> 8] = NULL;
+}
+
+/* the standard controller, $4016 shifts out one button per read in the
+ * order of controller_buttons while the strobe is low, 1s after that */
+static uint8_t read_controller(processor_t *processor) {
+  processor->controller_polled = true;
+  if (processor->controller_strobe) {
+    processor->controller_shift = processor->controller;
+  }
+  uint8_t bit = processor->controller_shift & 1;
+  processor->controller_shift = (processor->controller_shift >> 1) | 0x80;
+  return 0x40 | bit; /* open bus, the high bits of the address */
+}
+
+static void write_io(processor_t *processor, uint8_t value, uint16_t address) {
+  if (address == OAM_DMA) {
+    oam_dma(processor, value);
+  } else if (address == CONTROLLER_1) {
+    processor->controller_strobe = value & 1;
+    if (processor->controller_strobe) {
+      processor->controller_shift = processor->controller;
+    }
+  }
+}
+
+static void check_watchpoints(processor_t *processor, const uint8_t *location,
+                              uint16_t address, int kind, uint8_t value) {
+  if (processor->error != SUCCESS) {
+    return; /* only the first hit of an instruction is reported */
+  }
+  for (size_t i = 0; i < processor->watchpoint_count; i++) {
+    uint16_t watched = processor->watchpoints[i].address;
+    if ((processor->watchpoints[i].kind & kind) &&
+        &processor->pages[watched >> 8][watched & 0xff] == location) {
+      processor->watch_hit.address = address;
+      processor->watch_hit.pc = processor->instruction_pc;
+      processor->watch_hit.kind = kind;
+      processor->watch_hit.value = value;
+      processor->watch_hit.clock_ticks = processor->instruction_ticks;
+      processor->error = WATCHPOINT_HIT;
+      return;
+    }
+  }
+}
+
+static uint8_t trapped_read(processor_t *processor, uint16_t address) {
+  uint8_t *location = &processor->pages[address >> 8][address & 0xff];
+  if (address == CONTROLLER_1) {
+    *location = read_controller(processor);
+  }
+  check_watchpoints(processor, location, address, WATCH_READ, *location);
+  return *location;
+}
+
+static void trapped_write(processor_t *processor, uint8_t value,
+                          uint16_t address) {
+  uint8_t *location = &processor->pages[address >> 8][address & 0xff];
+  check_watchpoints(processor, location, address, WATCH_WRITE, value);
+  *location = value;
+  if ((address >> 8) == (IO_REGISTERS_START >> 8)) {
+    write_io(processor, value, address);
+  }
+}
+
+static uint8_t *trapped_dereference(processor_t *processor, uint16_t address) {
+  uint8_t *location = &processor->pages[address >> 8][address & 0xff];
+  check_watchpoints(processor, location, address, WATCH_READ, *location);
+  check_watchpoints(processor, location, address, WATCH_WRITE, *location);
+  return location;
+}
+
+extern bool m6502_add_watchpoint(processor_t *processor, uint16_t address,
+                                 int kind) {
+  for (size_t i = 0; i < processor->watchpoint_count; i++) {
+    if (processor->watchpoints[i].address == address) {
+      processor->watchpoints[i].kind |= kind;
+      update_traps(processor);
+      return true;
+    }
+  }
+  if (processor->watchpoint_count == MAX_WATCHPOINTS) {
+    return false;
+  }
+  processor->watchpoints[processor->watchpoint_count].address = address;
+  processor->watchpoints[processor->watchpoint_count].kind = kind;
+  processor->watchpoint_count++;
+  update_traps(processor);
+  return true;
+}
+
+extern void m6502_remove_watchpoint(processor_t *processor, uint16_t address) {
+  for (size_t i = 0; i < processor->watchpoint_count; i++) {
+    if (processor->watchpoints[i].address == address) {
+      processor->watchpoints[i] =
+          processor->watchpoints[--processor->watchpoint_count];
+      update_traps(processor);
+      return;
+    }
+  }
+}
+
+extern bool m6502_get_watch_hit(const processor_t *processor,
+                                watch_hit_t *hit) {
+  if (processor->error == WATCHPOINT_HIT && hit != NULL) {
+    *hit = processor->watch_hit;
   }
-  processor.memory[location] = value;
+  return processor->error == WATCHPOINT_HIT;
 }
 
-static inline void zero_check(uint8_t value) {
-  processor.registers._status.z = !value;
+static inline void zero_check(processor_t *processor, uint8_t value) {
+  processor->registers._status.z = !value;
 }
-static inline void negative_check(uint8_t value) {
-  processor.registers._status.n = (value & 0x80) != 0;
+static inline void negative_check(processor_t *processor, uint8_t value) {
+  processor->registers._status.n = (value & 0x80) != 0;
 }
-static inline void overflow_check(uint16_t value, uint16_t result) {
+static inline void overflow_check(processor_t *processor, uint16_t value,
+                                  uint16_t result) {
   /* algo to check if there's been an overflow, google for more info */
-  if ((result ^ processor.registers.accumulator) & (result ^ value) & 0x80) {
-    processor.registers._status.v = true;
+  if ((result ^ processor->registers.accumulator) & (result ^ value) & 0x80) {
+    processor->registers._status.v = true;
   } else {
-    processor.registers._status.v = false;
+    processor->registers._status.v = false;
   }
 }
 
@@ -838,1068 +1337,1111 @@ static inline unsigned long long page_check(uint16_t address, uint8_t reg) {
   }
   return 0llu;
 }
-static inline void carry_check(uint16_t value) {
+static inline void carry_check(processor_t *processor, uint16_t value) {
   if (value & 0xff00) {
-    processor.registers._status.c = true;
+    processor->registers._status.c = true;
   } else {
-    processor.registers._status.c = false;
+    processor->registers._status.c = false;
   }
 }
 
-static void ADC_help(uint16_t value) {
+static void ADC_help(processor_t *processor, uint16_t value) {
   uint8_t result =
-      processor.registers.accumulator + value + processor.registers._status.c;
-  overflow_check(value, result);
-  carry_check(result);
-  zero_check(result);
-  negative_check(result);
-  processor.registers.accumulator = result;
+      processor->registers.accumulator + value + processor->registers._status.c;
+  overflow_check(processor, value, result);
+  carry_check(processor, result);
+  zero_check(processor, result);
+  negative_check(processor, result);
+  processor->registers.accumulator = result;
 }
 
-static void ADC_im(void) {
-  uint8_t value = read_byte();
-  processor.clock_ticks += 2;
-  ADC_help(value);
+static void ADC_im(processor_t *processor) {
+  uint8_t value = read_byte(processor);
+  processor->clock_ticks += 2;
+  ADC_help(processor, value);
 }
 
-static void ADC_zero(void) {
-  uint8_t location = read_byte();
-  processor.clock_ticks += 3;
-  ADC_help(read_byte_at(location));
+static void ADC_zero(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  processor->clock_ticks += 3;
+  ADC_help(processor, read_byte_at(processor, location));
 }
 
-static void ADC_zerox(void) {
-  uint8_t location = read_byte();
-  processor.clock_ticks += 4;
-  ADC_help(read_byte_at(location + processor.registers.x));
+static void ADC_zerox(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  processor->clock_ticks += 4;
+  ADC_help(processor, read_byte_at(processor,
+                                   location + processor->registers.x));
 }
 
-static void ADC_absolute(void) {
-  uint16_t location = read_word();
-  processor.clock_ticks += 4;
-  ADC_help(read_byte_at(location));
+static void ADC_absolute(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  processor->clock_ticks += 4;
+  ADC_help(processor, read_byte_at(processor, location));
 }
 
-static void ADC_absolutex(void) {
-  uint16_t location = read_word();
-  processor.clock_ticks += 3 + page_check(location, processor.registers.x);
-  ADC_help(read_byte_at(location + processor.registers.x));
+static void ADC_absolutex(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  processor->clock_ticks += 3 + page_check(location, processor->registers.x);
+  ADC_help(processor, read_byte_at(processor,
+                                   location + processor->registers.x));
 }
 
-static void ADC_absolutey(void) {
-  uint16_t location = read_word();
-  processor.clock_ticks += 3 + page_check(location, processor.registers.y);
-  ADC_help(read_byte_at(location + processor.registers.y));
+static void ADC_absolutey(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  processor->clock_ticks += 3 + page_check(location, processor->registers.y);
+  ADC_help(processor, read_byte_at(processor,
+                                   location + processor->registers.y));
 }
 
-static void ADC_indirectx(void) {
-  uint8_t location = read_byte();
-  uint16_t value = read_word_at(location + processor.registers.x);
-  processor.clock_ticks += 6;
-  ADC_help(value);
+static void ADC_indirectx(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  uint16_t value = read_word_at(processor, location + processor->registers.x);
+  processor->clock_ticks += 6;
+  ADC_help(processor, value);
 }
 
-static void ADC_indirecty(void) {
-  uint8_t address = read_byte();
+static void ADC_indirecty(processor_t *processor) {
+  uint8_t address = read_byte(processor);
   indirect_indexed(address);
-  processor.clock_ticks += 5 + page_check(location, processor.registers.y);
-  ADC_help(*value);
+  processor->clock_ticks += 5 + page_check(location, processor->registers.y);
+  ADC_help(processor, read_byte_at(processor, target));
 }
 
-static void AND_help(uint8_t value) {
-  processor.registers.accumulator &= value;
-  zero_check(processor.registers.accumulator);
-  negative_check(processor.registers.accumulator);
+static void AND_help(processor_t *processor, uint8_t value) {
+  processor->registers.accumulator &= value;
+  zero_check(processor, processor->registers.accumulator);
+  negative_check(processor, processor->registers.accumulator);
 }
-static void AND_im(void) {
-  processor.clock_ticks += 2;
-  uint8_t value = read_byte();
-  AND_help(value);
+static void AND_im(processor_t *processor) {
+  processor->clock_ticks += 2;
+  uint8_t value = read_byte(processor);
+  AND_help(processor, value);
 }
 
-static void AND_zero(void) {
-  processor.clock_ticks += 3;
-  uint8_t value = read_byte_at(read_byte());
-  AND_help(value);
+static void AND_zero(processor_t *processor) {
+  processor->clock_ticks += 3;
+  uint8_t value = read_byte_at(processor, read_byte(processor));
+  AND_help(processor, value);
 }
 
-static void AND_zerox(void) {
-  processor.clock_ticks += 4;
-  uint8_t location = read_byte();
-  AND_help(read_byte_at(location + processor.registers.x));
+static void AND_zerox(processor_t *processor) {
+  processor->clock_ticks += 4;
+  uint8_t location = read_byte(processor);
+  AND_help(processor, read_byte_at(processor,
+                                   location + processor->registers.x));
 }
 
-static void AND_absolute(void) {
-  processor.clock_ticks += 4;
-  uint16_t location = read_word();
-  AND_help(read_byte_at(location));
+static void AND_absolute(processor_t *processor) {
+  processor->clock_ticks += 4;
+  uint16_t location = read_word(processor);
+  AND_help(processor, read_byte_at(processor, location));
 }
 
-static void AND_absolutex(void) {
-  uint16_t address = read_word();
-  processor.clock_ticks += 4 + page_check(address, processor.registers.x);
+static void AND_absolutex(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  processor->clock_ticks += 4 + page_check(address, processor->registers.x);
 
-  AND_help(read_byte_at(address + processor.registers.x));
+  AND_help(processor, read_byte_at(processor,
+                                   address + processor->registers.x));
 }
 
-static void AND_absolutey(void) {
-  uint16_t address = read_word();
-  processor.clock_ticks += 4 + page_check(address, processor.registers.x);
-  AND_help(read_byte_at(address + processor.registers.y));
+static void AND_absolutey(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  processor->clock_ticks += 4 + page_check(address, processor->registers.x);
+  AND_help(processor, read_byte_at(processor,
+                                   address + processor->registers.y));
 }
 
-static void AND_indirectx(void) {
-  uint8_t address = read_byte();
-  uint8_t *value = indexed_indirect(address);
-  processor.clock_ticks += 6;
-  AND_help(*value);
+static void AND_indirectx(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  uint16_t target = indexed_indirect(processor, address);
+  processor->clock_ticks += 6;
+  AND_help(processor, read_byte_at(processor, target));
 }
 
-static void AND_indirecty(void) {
-  uint8_t address = read_byte();
+static void AND_indirecty(processor_t *processor) {
+  uint8_t address = read_byte(processor);
   indirect_indexed(address);
-  processor.clock_ticks += 5 + page_check(location, processor.registers.y);
-  AND_help(*value);
+  processor->clock_ticks += 5 + page_check(location, processor->registers.y);
+  AND_help(processor, read_byte_at(processor, target));
 }
 
-void ASL_help(uint8_t *address) {
+void ASL_help(processor_t *processor, uint8_t *address) {
   *address <<= 1;
-  zero_check(*address);
-  carry_check(*address);
-  negative_check(*address);
+  zero_check(processor, *address);
+  carry_check(processor, *address);
+  negative_check(processor, *address);
 }
 
-static void ASL_accumulator(void) {
-  processor.clock_ticks += 2;
-  ASL_help(&processor.registers.accumulator);
+static void ASL_accumulator(processor_t *processor) {
+  processor->clock_ticks += 2;
+  ASL_help(processor, &processor->registers.accumulator);
 }
 
-static void ASL_zero(void) {
-  processor.clock_ticks += 5;
-  uint8_t location = read_byte();
-  ASL_help(dereference_address(location));
+static void ASL_zero(processor_t *processor) {
+  processor->clock_ticks += 5;
+  uint8_t location = read_byte(processor);
+  ASL_help(processor, dereference_address(processor, location));
 }
 
-static void ASL_zerox(void) {
-  processor.clock_ticks += 6;
-  uint8_t location = read_byte();
-  ASL_help(dereference_address(location + processor.registers.x));
+static void ASL_zerox(processor_t *processor) {
+  processor->clock_ticks += 6;
+  uint8_t location = read_byte(processor);
+  ASL_help(processor, dereference_address(processor,
+                                          location + processor->registers.x));
 }
 
-static void ASL_absolute(void) {
-  processor.clock_ticks += 6;
-  uint16_t location = read_word();
-  ASL_help(dereference_address(location));
+static void ASL_absolute(processor_t *processor) {
+  processor->clock_ticks += 6;
+  uint16_t location = read_word(processor);
+  ASL_help(processor, dereference_address(processor, location));
 }
 
-static void ASL_absolutex(void) {
-  processor.clock_ticks += 7;
-  uint16_t location = read_word();
-  ASL_help(dereference_address(location + processor.registers.x));
+static void ASL_absolutex(processor_t *processor) {
+  processor->clock_ticks += 7;
+  uint16_t location = read_word(processor);
+  ASL_help(processor, dereference_address(processor,
+                                          location + processor->registers.x));
 }
 
-static void branch(bool flag, bool b) {
-  int8_t offset = read_byte();
-  processor.clock_ticks += 2;
+static void branch(processor_t *processor, bool flag, bool b) {
+  int8_t offset = read_byte(processor);
+  processor->clock_ticks += 2;
   if (flag == b) {
-    processor.clock_ticks += 1 + page_check(processor.registers.pc, offset);
-    processor.registers.pc += offset;
+    processor->clock_ticks += 1 + page_check(processor->registers.pc, offset);
+    processor->registers.pc += offset;
   }
 }
-static void BCC(void) { branch(processor.registers._status.c, false); }
+static void BCC(processor_t *processor) {
+  branch(processor, processor->registers._status.c, false);
+}
 
-static void BCS(void) { branch(processor.registers._status.c, true); }
+static void BCS(processor_t *processor) {
+  branch(processor, processor->registers._status.c, true);
+}
 
-static void BEQ(void) { branch(processor.registers._status.z, true); }
+static void BEQ(processor_t *processor) {
+  branch(processor, processor->registers._status.z, true);
+}
 
-void BIT_help(uint16_t bit_test) {
+void BIT_help(processor_t *processor, uint16_t bit_test) {
   if (bit_test == 0) {
-    processor.registers._status.z = true;
-    processor.registers._status.v = false;
-    processor.registers._status.n = false;
+    processor->registers._status.z = true;
+    processor->registers._status.v = false;
+    processor->registers._status.n = false;
   } else {
-    processor.registers._status.v = !!(bit_test & OVERFLOW);
-    processor.registers._status.n = !!(bit_test & NEGATIVE);
+    processor->registers._status.v = !!(bit_test & OVERFLOW);
+    processor->registers._status.n = !!(bit_test & NEGATIVE);
   }
 }
 
-static void BIT_zero(void) {
-  uint8_t location = read_byte();
+static void BIT_zero(processor_t *processor) {
+  uint8_t location = read_byte(processor);
   uint8_t bit_test =
-      processor.registers.accumulator & read_byte_at(location);
-  processor.clock_ticks += 3;
-  BIT_help(bit_test);
+      processor->registers.accumulator & read_byte_at(processor, location);
+  processor->clock_ticks += 3;
+  BIT_help(processor, bit_test);
 }
 
-static void BIT_absolute(void) {
-  uint16_t location = read_word();
+static void BIT_absolute(processor_t *processor) {
+  uint16_t location = read_word(processor);
   uint8_t bit_test =
-      processor.registers.accumulator & read_byte_at(location);
-  processor.clock_ticks += 4;
-  BIT_help(bit_test);
+      processor->registers.accumulator & read_byte_at(processor, location);
+  processor->clock_ticks += 4;
+  BIT_help(processor, bit_test);
 }
 
-static void BMI(void) { branch(processor.registers._status.n, true); }
+static void BMI(processor_t *processor) {
+  branch(processor, processor->registers._status.n, true);
+}
 
-static void BNE(void) { branch(processor.registers._status.z, false); }
+static void BNE(processor_t *processor) {
+  branch(processor, processor->registers._status.z, false);
+}
 
-static void BPL(void) { branch(processor.registers._status.n, false); }
+static void BPL(processor_t *processor) {
+  branch(processor, processor->registers._status.n, false);
+}
 
 /* TODO */
-static void BRK(void) {
-  processor.registers.pc++;
-  push_to_stack(processor.registers.pc & 0xff);
-  push_to_stack((processor.registers.pc & 0xff00) >> 8);
-  push_to_stack(processor.registers.status);
+static void BRK(processor_t *processor) {
+  processor->registers.pc++;
+  push_to_stack(processor, processor->registers.pc & 0xff);
+  push_to_stack(processor, (processor->registers.pc & 0xff00) >> 8);
+  push_to_stack(processor, processor->registers.status);
 
-  processor.registers._status.b = true;
-  processor.registers.pc = read_word_at(0xfffe);
-  processor.clock_ticks += 7;
+  processor->registers._status.b = true;
+  processor->registers.pc = read_word_at(processor, 0xfffe);
+  processor->clock_ticks += 7;
 }
 
-static void BVC(void) { branch(processor.registers._status.v, false); }
+static void BVC(processor_t *processor) {
+  branch(processor, processor->registers._status.v, false);
+}
 
-static void BVS(void) { branch(processor.registers._status.v, true); }
+static void BVS(processor_t *processor) {
+  branch(processor, processor->registers._status.v, true);
+}
 
-static void CLC(void) {
-  processor.clock_ticks += 2;
-  processor.registers._status.c = false;
+static void CLC(processor_t *processor) {
+  processor->clock_ticks += 2;
+  processor->registers._status.c = false;
 }
 
-static void CLD(void) {
-  processor.clock_ticks += 2;
-  processor.registers._status.d = false;
+static void CLD(processor_t *processor) {
+  processor->clock_ticks += 2;
+  processor->registers._status.d = false;
 }
 
-static void CLI(void) {
-  processor.clock_ticks += 2;
-  processor.registers._status.i = false;
+static void CLI(processor_t *processor) {
+  processor->clock_ticks += 2;
+  processor->registers._status.i = false;
 }
 
-static void CLV(void) {
-  processor.clock_ticks += 2;
-  processor.registers._status.v = false;
+static void CLV(processor_t *processor) {
+  processor->clock_ticks += 2;
+  processor->registers._status.v = false;
 }
 
 /* this is for all compare instructions */
-static void cmp_help(unsigned char value, unsigned char reg) {
-  processor.registers._status.z = reg == value;
-  processor.registers._status.c = reg >= value;
-  processor.registers._status.n = (signed char)(reg - value) < 0;
+static void cmp_help(processor_t *processor, unsigned char value,
+                     unsigned char reg) {
+  processor->registers._status.z = reg == value;
+  processor->registers._status.c = reg >= value;
+  processor->registers._status.n = (signed char)(reg - value) < 0;
 }
 
 /* this is simply to have less args for the caller as it's pointless to write
  * out accumulator each time */
-static void CMP_help(unsigned char value) {
-  cmp_help(value, processor.registers.accumulator);
+static void CMP_help(processor_t *processor, unsigned char value) {
+  cmp_help(processor, value, processor->registers.accumulator);
 }
 
-static void CMP_im(void) {
-  unsigned char value = read_byte();
-  processor.clock_ticks += 2;
-  CMP_help(value);
+static void CMP_im(processor_t *processor) {
+  unsigned char value = read_byte(processor);
+  processor->clock_ticks += 2;
+  CMP_help(processor, value);
 }
 
-static void CMP_zero(void) {
-  uint8_t location = read_byte();
-  uint8_t value = read_byte_at(location);
-  processor.clock_ticks += 3;
-  CMP_help(value);
+static void CMP_zero(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  uint8_t value = read_byte_at(processor, location);
+  processor->clock_ticks += 3;
+  CMP_help(processor, value);
 }
 
-static void CMP_zerox(void) {
-  uint8_t location = read_byte();
-  uint8_t value = read_byte_at(location + processor.registers.x);
-  processor.clock_ticks += 4;
-  CMP_help(value);
+static void CMP_zerox(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  uint8_t value = read_byte_at(processor, location + processor->registers.x);
+  processor->clock_ticks += 4;
+  CMP_help(processor, value);
 }
 
-static void CMP_absolute(void) {
-  uint16_t location = read_word();
-  uint8_t value = read_byte_at(location);
-  processor.clock_ticks += 4;
-  CMP_help(value);
+static void CMP_absolute(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t value = read_byte_at(processor, location);
+  processor->clock_ticks += 4;
+  CMP_help(processor, value);
 }
 
-static void CMP_absolutex(void) {
-  uint16_t location = read_word();
-  uint8_t value = read_byte_at(location + processor.registers.x);
-  processor.clock_ticks += 4 + page_check(location, processor.registers.x);
-  CMP_help(value);
+static void CMP_absolutex(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t value = read_byte_at(processor, location + processor->registers.x);
+  processor->clock_ticks += 4 + page_check(location, processor->registers.x);
+  CMP_help(processor, value);
 }
 
-static void CMP_absolutey(void) {
-  uint16_t location = read_word();
-  uint8_t value = read_byte_at(location + processor.registers.y);
-  processor.clock_ticks += 4 + page_check(location, processor.registers.y);
-  CMP_help(value);
+static void CMP_absolutey(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t value = read_byte_at(processor, location + processor->registers.y);
+  processor->clock_ticks += 4 + page_check(location, processor->registers.y);
+  CMP_help(processor, value);
 }
 
-static void CMP_indirectx(void) {
-  uint8_t address = read_byte();
-  uint8_t *value = indexed_indirect(address);
-  processor.clock_ticks += 6;
-  CMP_help(*value);
+static void CMP_indirectx(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  uint16_t target = indexed_indirect(processor, address);
+  processor->clock_ticks += 6;
+  CMP_help(processor, read_byte_at(processor, target));
 }
 
-static void CMP_indirecty(void) {
-  uint8_t address = read_byte();
+static void CMP_indirecty(processor_t *processor) {
+  uint8_t address = read_byte(processor);
   indirect_indexed(address);
-  processor.clock_ticks += 5 + page_check(location, processor.registers.y);
-  CMP_help(*value);
+  processor->clock_ticks += 5 + page_check(location, processor->registers.y);
+  CMP_help(processor, read_byte_at(processor, target));
 }
 
-static void CPX_help(unsigned char value) {
-  cmp_help(value, processor.registers.x);
+static void CPX_help(processor_t *processor, unsigned char value) {
+  cmp_help(processor, value, processor->registers.x);
 }
 
-static void CPX_im(void) {
-  uint8_t value = read_byte();
-  processor.clock_ticks += 2;
-  CPX_help(value);
+static void CPX_im(processor_t *processor) {
+  uint8_t value = read_byte(processor);
+  processor->clock_ticks += 2;
+  CPX_help(processor, value);
 }
 
-static void CPX_zero(void) {
-  uint8_t location = read_byte();
-  uint8_t value = read_byte_at(location);
-  processor.clock_ticks += 3;
-  CPX_help(value);
+static void CPX_zero(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  uint8_t value = read_byte_at(processor, location);
+  processor->clock_ticks += 3;
+  CPX_help(processor, value);
 }
 
-static void CPX_absolute(void) {
-  uint16_t location = read_word();
-  uint8_t value = read_byte_at(location);
-  processor.clock_ticks += 4;
-  CPX_help(value);
+static void CPX_absolute(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t value = read_byte_at(processor, location);
+  processor->clock_ticks += 4;
+  CPX_help(processor, value);
 }
 
-static void CPY_help(unsigned char value) {
-  cmp_help(value, processor.registers.y);
+static void CPY_help(processor_t *processor, unsigned char value) {
+  cmp_help(processor, value, processor->registers.y);
 }
 
-static void CPY_im(void) {
-  uint8_t value = read_byte();
-  processor.clock_ticks += 2;
-  CPY_help(value);
+static void CPY_im(processor_t *processor) {
+  uint8_t value = read_byte(processor);
+  processor->clock_ticks += 2;
+  CPY_help(processor, value);
 }
 
-static void CPY_zero(void) {
-  uint8_t location = read_byte();
-  uint8_t value = read_byte_at(location);
-  processor.clock_ticks += 3;
-  CPY_help(value);
+static void CPY_zero(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  uint8_t value = read_byte_at(processor, location);
+  processor->clock_ticks += 3;
+  CPY_help(processor, value);
 }
 
-static void CPY_absolute(void) {
-  uint16_t location = read_word();
-  uint8_t value = read_byte_at(location);
-  processor.clock_ticks += 4;
-  CPY_help(value);
+static void CPY_absolute(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t value = read_byte_at(processor, location);
+  processor->clock_ticks += 4;
+  CPY_help(processor, value);
 }
 
-static void DEC_help(uint16_t location) {
-  processor.memory[location]--;
-  zero_check(read_byte_at(location));
-  negative_check(read_byte_at(location));
+static void DEC_help(processor_t *processor, uint16_t location) {
+  (*dereference_address(processor, location))--;
+  zero_check(processor, read_byte_at(processor, location));
+  negative_check(processor, read_byte_at(processor, location));
 }
 
-static void DEC_zero(void) {
-  uint8_t location = read_byte();
-  processor.clock_ticks += 5;
-  DEC_help(location);
+static void DEC_zero(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  processor->clock_ticks += 5;
+  DEC_help(processor, location);
 }
 
-static void DEC_zerox(void) {
-  uint8_t location = read_byte();
-  processor.clock_ticks += 6;
-  DEC_help(location);
+static void DEC_zerox(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  processor->clock_ticks += 6;
+  DEC_help(processor, location);
 }
 
-static void DEC_absolute(void) {
-  uint16_t location = read_word();
-  processor.clock_ticks += 6;
-  DEC_help(location);
+static void DEC_absolute(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  processor->clock_ticks += 6;
+  DEC_help(processor, location);
 }
 
-static void DEC_absolutex(void) {
-  uint16_t location = read_word();
-  processor.clock_ticks += 7;
-  DEC_help(location + processor.registers.x);
+static void DEC_absolutex(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  processor->clock_ticks += 7;
+  DEC_help(processor, location + processor->registers.x);
 }
 
-static void DEX(void) {
-  processor.registers.x--;
-  zero_check(processor.registers.x);
-  negative_check(processor.registers.x);
-  processor.clock_ticks += 2;
+static void DEX(processor_t *processor) {
+  processor->registers.x--;
+  zero_check(processor, processor->registers.x);
+  negative_check(processor, processor->registers.x);
+  processor->clock_ticks += 2;
 }
 
-static void DEY(void) {
-  processor.registers.y--;
-  zero_check(processor.registers.y);
-  negative_check(processor.registers.y);
-  processor.clock_ticks += 2;
+static void DEY(processor_t *processor) {
+  processor->registers.y--;
+  zero_check(processor, processor->registers.y);
+  negative_check(processor, processor->registers.y);
+  processor->clock_ticks += 2;
 }
 
-static void EOR_help(uint8_t value) {
-  processor.registers.accumulator ^= value;
-  zero_check(processor.registers.accumulator);
-  negative_check(processor.registers.accumulator);
+static void EOR_help(processor_t *processor, uint8_t value) {
+  processor->registers.accumulator ^= value;
+  zero_check(processor, processor->registers.accumulator);
+  negative_check(processor, processor->registers.accumulator);
 }
 
-static void EOR_im(void) {
-  uint8_t value = read_byte();
-  processor.clock_ticks += 2;
-  EOR_help(value);
+static void EOR_im(processor_t *processor) {
+  uint8_t value = read_byte(processor);
+  processor->clock_ticks += 2;
+  EOR_help(processor, value);
 }
 
-static void EOR_zero(void) {
-  uint8_t location = read_byte();
-  uint8_t value = read_byte_at(location);
-  processor.clock_ticks += 3;
-  EOR_help(value);
+static void EOR_zero(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  uint8_t value = read_byte_at(processor, location);
+  processor->clock_ticks += 3;
+  EOR_help(processor, value);
 }
 
-static void EOR_zerox(void) {
-  uint8_t location = read_byte();
-  uint8_t value = read_byte_at(location);
-  processor.clock_ticks += 4;
-  EOR_help(value);
+static void EOR_zerox(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  uint8_t value = read_byte_at(processor, location);
+  processor->clock_ticks += 4;
+  EOR_help(processor, value);
 }
 
-static void EOR_absolute(void) {
-  uint16_t location = read_word();
-  uint8_t value = read_byte_at(location);
-  processor.clock_ticks += 4;
-  EOR_help(value);
+static void EOR_absolute(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t value = read_byte_at(processor, location);
+  processor->clock_ticks += 4;
+  EOR_help(processor, value);
 }
 
-static void EOR_absolutex(void) {
-  uint16_t location = read_word();
-  uint8_t value = read_byte_at(location + processor.registers.x);
-  processor.clock_ticks += 4 + page_check(location, processor.registers.x);
-  EOR_help(value);
+static void EOR_absolutex(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t value = read_byte_at(processor, location + processor->registers.x);
+  processor->clock_ticks += 4 + page_check(location, processor->registers.x);
+  EOR_help(processor, value);
 }
 
-static void EOR_absolutey(void) {
-  uint16_t location = read_word();
-  uint8_t value = read_byte_at(location + processor.registers.y);
-  processor.clock_ticks += 4 + page_check(location, processor.registers.y);
-  EOR_help(value);
+static void EOR_absolutey(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t value = read_byte_at(processor, location + processor->registers.y);
+  processor->clock_ticks += 4 + page_check(location, processor->registers.y);
+  EOR_help(processor, value);
 }
 
-static void EOR_indirectx(void) {
-  uint8_t address = read_byte();
-  uint8_t *value = indexed_indirect(address);
-  processor.clock_ticks += 6;
-  EOR_help(*value);
+static void EOR_indirectx(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  uint16_t target = indexed_indirect(processor, address);
+  processor->clock_ticks += 6;
+  EOR_help(processor, read_byte_at(processor, target));
 }
 
-static void EOR_indirecty(void) {
-  uint8_t address = read_byte();
+static void EOR_indirecty(processor_t *processor) {
+  uint8_t address = read_byte(processor);
   indirect_indexed(address);
-  processor.clock_ticks += 5 + page_check(location, processor.registers.y);
-  EOR_help(*value);
+  processor->clock_ticks += 5 + page_check(location, processor->registers.y);
+  EOR_help(processor, read_byte_at(processor, target));
 }
 
-static void INC_help(uint16_t location) {
-  processor.memory[location]++;
-  zero_check(read_byte_at(location));
-  negative_check(read_byte_at(location));
+static void INC_help(processor_t *processor, uint16_t location) {
+  (*dereference_address(processor, location))++;
+  zero_check(processor, read_byte_at(processor, location));
+  negative_check(processor, read_byte_at(processor, location));
 }
 
-static void INC_zero(void) {
-  uint8_t location = read_byte();
-  processor.clock_ticks += 5;
-  INC_help(location);
+static void INC_zero(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  processor->clock_ticks += 5;
+  INC_help(processor, location);
 }
 
-static void INC_zerox(void) {
-  uint8_t location = read_byte();
-  processor.clock_ticks += 6;
-  INC_help(location);
+static void INC_zerox(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  processor->clock_ticks += 6;
+  INC_help(processor, location);
 }
 
-static void INC_absolute(void) {
-  uint16_t location = read_word();
-  processor.clock_ticks += 6;
-  INC_help(location);
+static void INC_absolute(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  processor->clock_ticks += 6;
+  INC_help(processor, location);
 }
 
-static void INC_absolutex(void) {
-  uint16_t location = read_word();
-  processor.clock_ticks += 7;
-  INC_help(location);
+static void INC_absolutex(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  processor->clock_ticks += 7;
+  INC_help(processor, location);
 }
 
-static void INX(void) {
-  processor.registers.x++;
-  processor.clock_ticks += 2;
-  zero_check(processor.registers.x);
-  negative_check(processor.registers.x);
+static void INX(processor_t *processor) {
+  processor->registers.x++;
+  processor->clock_ticks += 2;
+  zero_check(processor, processor->registers.x);
+  negative_check(processor, processor->registers.x);
 }
 
-static void INY(void) {
-  processor.registers.y++;
-  processor.clock_ticks += 2;
-  zero_check(processor.registers.y);
-  negative_check(processor.registers.y);
+static void INY(processor_t *processor) {
+  processor->registers.y++;
+  processor->clock_ticks += 2;
+  zero_check(processor, processor->registers.y);
+  negative_check(processor, processor->registers.y);
 }
 
-static void JMP_absolute(void) {
-  processor.clock_ticks += 3;
-  uint16_t location = read_word();
-  processor.registers.pc = location;
+static void JMP_absolute(processor_t *processor) {
+  processor->clock_ticks += 3;
+  uint16_t location = read_word(processor);
+  processor->registers.pc = location;
 }
 
-static void JMP_indirect(void) {
-  uint16_t location = read_word();
-  uint16_t jmp_to = read_word_at(location);
-  processor.clock_ticks += 5;
-  processor.registers.pc = jmp_to;
+static void JMP_indirect(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint16_t jmp_to = read_word_at(processor, location);
+  processor->clock_ticks += 5;
+  processor->registers.pc = jmp_to;
 }
 
-static void JSR(void) {
-  uint16_t location = read_word();
-  push_word_to_stack(processor.registers.pc - 1);
+static void JSR(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  push_word_to_stack(processor, processor->registers.pc - 1);
 
-  processor.registers.pc = location;
-  processor.clock_ticks += 6;
+  processor->registers.pc = location;
+  processor->clock_ticks += 6;
 }
 
-void LDA_help(uint8_t value) {
-  processor.registers.accumulator = value;
-  zero_check(processor.registers.accumulator);
-  negative_check(processor.registers.accumulator);
+void LDA_help(processor_t *processor, uint8_t value) {
+  processor->registers.accumulator = value;
+  zero_check(processor, processor->registers.accumulator);
+  negative_check(processor, processor->registers.accumulator);
 }
 
-static void LDA_im(void) {
-  uint8_t value = read_byte();
-  processor.clock_ticks += 2;
-  LDA_help(value);
+static void LDA_im(processor_t *processor) {
+  uint8_t value = read_byte(processor);
+  processor->clock_ticks += 2;
+  LDA_help(processor, value);
 }
 
-static void LDA_zero(void) {
-  processor.clock_ticks += 3;
-  uint16_t location = read_byte();
-  LDA_help(read_byte_at(location));
+static void LDA_zero(processor_t *processor) {
+  processor->clock_ticks += 3;
+  uint16_t location = read_byte(processor);
+  LDA_help(processor, read_byte_at(processor, location));
 }
 
-static void LDA_zerox(void) {
-  processor.clock_ticks += 4;
-  uint8_t location = read_byte();
-  LDA_help(read_byte_at(location + processor.registers.x));
+static void LDA_zerox(processor_t *processor) {
+  processor->clock_ticks += 4;
+  uint8_t location = read_byte(processor);
+  LDA_help(processor, read_byte_at(processor,
+                                   location + processor->registers.x));
 }
 
-static void LDA_absolute(void) {
-  processor.clock_ticks += 4;
-  uint16_t location = read_word();
-  LDA_help(read_byte_at(location));
+static void LDA_absolute(processor_t *processor) {
+  processor->clock_ticks += 4;
+  uint16_t location = read_word(processor);
+  LDA_help(processor, read_byte_at(processor, location));
 }
 
-static void LDA_absolutex(void) {
-  uint16_t address = read_word();
-  processor.clock_ticks += 4 + page_check(address, processor.registers.x);
-  LDA_help(read_byte_at(address + processor.registers.x));
+static void LDA_absolutex(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  processor->clock_ticks += 4 + page_check(address, processor->registers.x);
+  LDA_help(processor, read_byte_at(processor,
+                                   address + processor->registers.x));
 }
 
-static void LDA_absolutey(void) {
-  uint16_t address = read_word();
-  processor.clock_ticks += 4 + page_check(address, processor.registers.y);
-  LDA_help(read_byte_at(address + processor.registers.y));
+static void LDA_absolutey(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  processor->clock_ticks += 4 + page_check(address, processor->registers.y);
+  LDA_help(processor, read_byte_at(processor,
+                                   address + processor->registers.y));
 }
 
-static void LDA_indirectx(void) {
-  uint8_t address = read_byte();
-  uint8_t *value = indexed_indirect(address);
-  processor.clock_ticks += 6;
-  LDA_help(*value);
+static void LDA_indirectx(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  uint16_t target = indexed_indirect(processor, address);
+  processor->clock_ticks += 6;
+  LDA_help(processor, read_byte_at(processor, target));
 }
 
-static void LDA_indirecty(void) {
-  uint8_t address = read_byte();
+static void LDA_indirecty(processor_t *processor) {
+  uint8_t address = read_byte(processor);
   indirect_indexed(address);
-  processor.clock_ticks += 5 + page_check(location, processor.registers.y);
-  LDA_help(*value);
+  processor->clock_ticks += 5 + page_check(location, processor->registers.y);
+  LDA_help(processor, read_byte_at(processor, target));
 }
 
-static void LDX_help(uint8_t value) {
-  processor.registers.x = value;
-  zero_check(processor.registers.x);
-  negative_check(processor.registers.x);
+static void LDX_help(processor_t *processor, uint8_t value) {
+  processor->registers.x = value;
+  zero_check(processor, processor->registers.x);
+  negative_check(processor, processor->registers.x);
 }
 
-static void LDX_im(void) {
-  uint8_t value = read_byte();
-  processor.clock_ticks += 2;
-  LDX_help(value);
+static void LDX_im(processor_t *processor) {
+  uint8_t value = read_byte(processor);
+  processor->clock_ticks += 2;
+  LDX_help(processor, value);
 }
 
-static void LDX_zero(void) {
-  processor.clock_ticks += 3;
-  uint8_t location = read_byte();
-  LDX_help(read_byte_at(location));
+static void LDX_zero(processor_t *processor) {
+  processor->clock_ticks += 3;
+  uint8_t location = read_byte(processor);
+  LDX_help(processor, read_byte_at(processor, location));
 }
 
-static void LDX_zeroy(void) {
-  processor.clock_ticks += 4;
-  uint8_t location = read_byte();
-  LDX_help(read_byte_at(location + processor.registers.y));
+static void LDX_zeroy(processor_t *processor) {
+  processor->clock_ticks += 4;
+  uint8_t location = read_byte(processor);
+  LDX_help(processor, read_byte_at(processor,
+                                   location + processor->registers.y));
 }
 
-static void LDX_absolute(void) {
-  processor.clock_ticks += 4;
-  uint16_t location = read_word();
-  LDX_help(read_byte_at(location));
+static void LDX_absolute(processor_t *processor) {
+  processor->clock_ticks += 4;
+  uint16_t location = read_word(processor);
+  LDX_help(processor, read_byte_at(processor, location));
 }
 
-static void LDX_absolutey(void) {
-  uint16_t address = read_word();
-  processor.clock_ticks += 4 + page_check(address, processor.registers.y);
-  LDX_help(read_byte_at(address + processor.registers.y));
+static void LDX_absolutey(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  processor->clock_ticks += 4 + page_check(address, processor->registers.y);
+  LDX_help(processor, read_byte_at(processor,
+                                   address + processor->registers.y));
 }
 
-static void LDY_help(uint8_t value) {
-  processor.registers.y = value;
-  zero_check(processor.registers.y);
-  negative_check(processor.registers.y);
+static void LDY_help(processor_t *processor, uint8_t value) {
+  processor->registers.y = value;
+  zero_check(processor, processor->registers.y);
+  negative_check(processor, processor->registers.y);
 }
 
-static void LDY_im(void) {
-  processor.clock_ticks += 2;
-  LDY_help(read_byte());
+static void LDY_im(processor_t *processor) {
+  processor->clock_ticks += 2;
+  LDY_help(processor, read_byte(processor));
 }
 
-static void LDY_zero(void) {
-  processor.clock_ticks += 3;
-  LDY_help(read_byte_at(read_byte()));
+static void LDY_zero(processor_t *processor) {
+  processor->clock_ticks += 3;
+  LDY_help(processor, read_byte_at(processor, read_byte(processor)));
 }
 
-static void LDY_zerox(void) {
-  processor.clock_ticks += 4;
-  LDY_help(read_byte_at(read_byte() + processor.registers.x));
+static void LDY_zerox(processor_t *processor) {
+  processor->clock_ticks += 4;
+  LDY_help(processor, read_byte_at(processor, read_byte(processor) +
+                                                  processor->registers.x));
 }
 
-static void LDY_absolute(void) {
-  processor.clock_ticks += 4;
-  LDY_help(read_byte_at(read_word()));
+static void LDY_absolute(processor_t *processor) {
+  processor->clock_ticks += 4;
+  LDY_help(processor, read_byte_at(processor, read_word(processor)));
 }
 
-static void LDY_absolutex(void) {
-  uint16_t address = read_word();
-  processor.clock_ticks += 4 + page_check(address, processor.registers.x);
-  LDY_help(read_byte_at(read_word() + processor.registers.x));
+static void LDY_absolutex(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  processor->clock_ticks += 4 + page_check(address, processor->registers.x);
+  LDY_help(processor, read_byte_at(processor, read_word(processor) +
+                                                  processor->registers.x));
 }
 
-static void LSR_help(uint8_t *value) {
+static void LSR_help(processor_t *processor, uint8_t *value) {
   (*value) >>= 1;
-  carry_check(*value);
-  zero_check(*value);
-  negative_check(*value);
+  carry_check(processor, *value);
+  zero_check(processor, *value);
+  negative_check(processor, *value);
 }
 
-static void LSR_accumulator(void) {
-  processor.clock_ticks += 2;
-  LSR_help(&processor.registers.accumulator);
+static void LSR_accumulator(processor_t *processor) {
+  processor->clock_ticks += 2;
+  LSR_help(processor, &processor->registers.accumulator);
 }
 
-static void LSR_zero(void) {
-  uint8_t location = read_byte();
-  processor.clock_ticks += 5;
-  LSR_help(dereference_address(location));
+static void LSR_zero(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  processor->clock_ticks += 5;
+  LSR_help(processor, dereference_address(processor, location));
 }
 
-static void LSR_zerox(void) {
-  uint8_t location = read_byte();
-  processor.clock_ticks += 6;
-  LSR_help(dereference_address(location + processor.registers.x));
+static void LSR_zerox(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  processor->clock_ticks += 6;
+  LSR_help(processor, dereference_address(processor,
+                                          location + processor->registers.x));
 }
 
-static void LSR_absolute(void) {
-  uint16_t location = read_word();
-  processor.clock_ticks += 6;
-  LSR_help(dereference_address(location));
+static void LSR_absolute(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  processor->clock_ticks += 6;
+  LSR_help(processor, dereference_address(processor, location));
 }
 
-static void LSR_absolutex(void) {
-  uint16_t location = read_word();
-  processor.clock_ticks += 7;
-  LSR_help(dereference_address(location + processor.registers.x));
+static void LSR_absolutex(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  processor->clock_ticks += 7;
+  LSR_help(processor, dereference_address(processor,
+                                          location + processor->registers.x));
 }
 
-static void NOP_im(void) { processor.clock_ticks += 2; }
+static void NOP_im(processor_t *processor) { processor->clock_ticks += 2; }
 
-static void NOP_absolute(void) {
-  processor.clock_ticks += 4;
-  processor.registers.pc += 2;
+static void NOP_absolute(processor_t *processor) {
+  processor->clock_ticks += 4;
+  processor->registers.pc += 2;
 }
 
-static void NOP_absolutex(void) {
-  uint16_t address = read_word();
-  processor.clock_ticks += 4 + page_check(address, processor.registers.x);
+static void NOP_absolutex(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  processor->clock_ticks += 4 + page_check(address, processor->registers.x);
 }
-static void NOP_zero(void) { processor.clock_ticks += 3; }
+static void NOP_zero(processor_t *processor) { processor->clock_ticks += 3; }
 
-static void NOP_zerox(void) { processor.clock_ticks += 4; }
+static void NOP_zerox(processor_t *processor) { processor->clock_ticks += 4; }
 
-static void ORA_help(uint16_t value) {
-  processor.registers.accumulator |= value;
-  zero_check(processor.registers.accumulator);
-  negative_check(processor.registers.accumulator);
+static void ORA_help(processor_t *processor, uint16_t value) {
+  processor->registers.accumulator |= value;
+  zero_check(processor, processor->registers.accumulator);
+  negative_check(processor, processor->registers.accumulator);
 }
 
-static void ORA_im(void) {
-  uint8_t value = read_byte();
-  processor.clock_ticks += 2;
-  ORA_help(value);
+static void ORA_im(processor_t *processor) {
+  uint8_t value = read_byte(processor);
+  processor->clock_ticks += 2;
+  ORA_help(processor, value);
 }
 
-static void ORA_zero(void) {
-  uint8_t location = read_byte();
-  uint8_t value = read_byte_at(location);
-  processor.clock_ticks += 3;
-  ORA_help(value);
+static void ORA_zero(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  uint8_t value = read_byte_at(processor, location);
+  processor->clock_ticks += 3;
+  ORA_help(processor, value);
 }
 
-static void ORA_zerox(void) {
-  uint8_t location = read_byte();
-  uint8_t value = read_byte_at(location);
-  processor.clock_ticks += 4;
-  ORA_help(value);
+static void ORA_zerox(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  uint8_t value = read_byte_at(processor, location);
+  processor->clock_ticks += 4;
+  ORA_help(processor, value);
 }
 
-static void ORA_absolute(void) {
-  uint16_t location = read_word();
-  uint8_t value = read_byte_at(location);
-  processor.clock_ticks += 4;
-  ORA_help(value);
+static void ORA_absolute(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t value = read_byte_at(processor, location);
+  processor->clock_ticks += 4;
+  ORA_help(processor, value);
 }
 
-static void ORA_absolutex(void) {
-  uint16_t location = read_word();
-  uint8_t value = read_byte_at(location + processor.registers.x);
-  processor.clock_ticks += 4 + page_check(location, processor.registers.x);
-  ORA_help(value);
+static void ORA_absolutex(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t value = read_byte_at(processor, location + processor->registers.x);
+  processor->clock_ticks += 4 + page_check(location, processor->registers.x);
+  ORA_help(processor, value);
 }
 
-static void ORA_absolutey(void) {
-  uint16_t location = read_word();
-  uint8_t value = read_byte_at(location + processor.registers.y);
-  processor.clock_ticks += 4 + page_check(location, processor.registers.y);
-  ORA_help(value);
+static void ORA_absolutey(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t value = read_byte_at(processor, location + processor->registers.y);
+  processor->clock_ticks += 4 + page_check(location, processor->registers.y);
+  ORA_help(processor, value);
 }
 
-static void ORA_indirectx(void) {
-  uint8_t address = read_byte();
-  uint8_t *value = indexed_indirect(address);
-  processor.clock_ticks += 6;
-  ORA_help(*value);
+static void ORA_indirectx(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  uint16_t target = indexed_indirect(processor, address);
+  processor->clock_ticks += 6;
+  ORA_help(processor, read_byte_at(processor, target));
 }
 
-static void ORA_indirecty(void) {
-  uint8_t address = read_byte();
+static void ORA_indirecty(processor_t *processor) {
+  uint8_t address = read_byte(processor);
   indirect_indexed(address);
-  processor.clock_ticks += 5 + page_check(location, processor.registers.y);
-  ORA_help(*value);
+  processor->clock_ticks += 5 + page_check(location, processor->registers.y);
+  ORA_help(processor, read_byte_at(processor, target));
 }
 
-static void PHA(void) {
-  push_to_stack(processor.registers.accumulator);
-  processor.clock_ticks += 3;
+static void PHA(processor_t *processor) {
+  push_to_stack(processor, processor->registers.accumulator);
+  processor->clock_ticks += 3;
 }
 
-static void PHP(void) {
-  processor.clock_ticks += 3;
-  push_to_stack(processor.registers.status);
+static void PHP(processor_t *processor) {
+  processor->clock_ticks += 3;
+  push_to_stack(processor, processor->registers.status);
 }
 
-static void PLA(void) {
-  processor.clock_ticks += 4;
-  processor.registers.accumulator = pop_from_stack();
+static void PLA(processor_t *processor) {
+  processor->clock_ticks += 4;
+  processor->registers.accumulator = pop_from_stack(processor);
 }
 
-static void PLP(void) {
-  processor.clock_ticks += 4;
-  processor.registers.status = pop_from_stack();
+static void PLP(processor_t *processor) {
+  processor->clock_ticks += 4;
+  processor->registers.status = pop_from_stack(processor);
 }
 
-static void ROL_help(uint8_t *location) {
+static void ROL_help(processor_t *processor, uint8_t *location) {
   *location = (*location << 1) | (*location >> 7);
-  carry_check(*location);
-  zero_check(*location);
-  negative_check(*location);
+  carry_check(processor, *location);
+  zero_check(processor, *location);
+  negative_check(processor, *location);
 }
 
-static void ROL_accumulator(void) {
-  processor.clock_ticks += 2;
-  ROL_help(&processor.registers.accumulator);
+static void ROL_accumulator(processor_t *processor) {
+  processor->clock_ticks += 2;
+  ROL_help(processor, &processor->registers.accumulator);
 }
 
-static void ROL_zero(void) {
-  uint8_t location = read_byte();
-  processor.clock_ticks += 5;
-  ROL_help(dereference_address(location));
+static void ROL_zero(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  processor->clock_ticks += 5;
+  ROL_help(processor, dereference_address(processor, location));
 }
 
-static void ROL_zerox(void) {
-  uint8_t location = read_byte();
-  processor.clock_ticks += 6;
-  ROL_help(dereference_address(location + processor.registers.x));
+static void ROL_zerox(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  processor->clock_ticks += 6;
+  ROL_help(processor, dereference_address(processor,
+                                          location + processor->registers.x));
 }
 
-static void ROL_absolute(void) {
-  uint16_t location = read_word();
-  processor.clock_ticks += 6;
-  ROL_help(dereference_address(location));
+static void ROL_absolute(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  processor->clock_ticks += 6;
+  ROL_help(processor, dereference_address(processor, location));
 }
 
-static void ROL_absolutex(void) {
-  uint16_t location = read_word();
-  processor.clock_ticks += 7;
-  ROL_help(dereference_address(location + processor.registers.x));
+static void ROL_absolutex(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  processor->clock_ticks += 7;
+  ROL_help(processor, dereference_address(processor,
+                                          location + processor->registers.x));
 }
 
-static void ROR_help(uint8_t *location) {
+static void ROR_help(processor_t *processor, uint8_t *location) {
   /* shifts the accumulator (to be changed later to support different addressing
    * modes) by 1 */
   *location = (*location >> 1) | (*location << 7);
-  carry_check(*location);
-  zero_check(*location);
-  negative_check(*location);
+  carry_check(processor, *location);
+  zero_check(processor, *location);
+  negative_check(processor, *location);
 }
 
-static void ROR_accumulator(void) {
-  processor.clock_ticks += 2;
-  ROR_help(&processor.registers.accumulator);
+static void ROR_accumulator(processor_t *processor) {
+  processor->clock_ticks += 2;
+  ROR_help(processor, &processor->registers.accumulator);
 }
 
-static void ROR_zero(void) {
-  uint8_t location = read_byte();
-  processor.clock_ticks += 5;
-  ROR_help(dereference_address(location));
+static void ROR_zero(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  processor->clock_ticks += 5;
+  ROR_help(processor, dereference_address(processor, location));
 }
 
-static void ROR_zerox(void) {
-  uint8_t location = read_byte();
-  processor.clock_ticks += 6;
-  ROR_help(dereference_address(location + processor.registers.x));
+static void ROR_zerox(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  processor->clock_ticks += 6;
+  ROR_help(processor, dereference_address(processor,
+                                          location + processor->registers.x));
 }
 
-static void ROR_absolute(void) {
-  uint16_t location = read_word();
-  processor.clock_ticks += 6;
-  ROR_help(dereference_address(location));
+static void ROR_absolute(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  processor->clock_ticks += 6;
+  ROR_help(processor, dereference_address(processor, location));
 }
 
-static void ROR_absolutex(void) {
-  uint16_t location = read_word();
-  processor.clock_ticks += 7;
-  ROR_help(dereference_address(location + processor.registers.x));
+static void ROR_absolutex(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  processor->clock_ticks += 7;
+  ROR_help(processor, dereference_address(processor,
+                                          location + processor->registers.x));
 }
 
-static void RTI(void) {
-  processor.registers.status = pop_from_stack();
-  processor.clock_ticks += 6;
+static void RTI(processor_t *processor) {
+  processor->registers.status = pop_from_stack(processor);
+  processor->clock_ticks += 6;
 }
 
-static void RTS(void) {
-  processor.registers.pc = pop_word_from_stack();
-  processor.registers.pc++;
-  processor.clock_ticks += 6;
+static void RTS(processor_t *processor) {
+  processor->registers.pc = pop_word_from_stack(processor);
+  processor->registers.pc++;
+  processor->clock_ticks += 6;
 }
 
-static void SBC_help(uint8_t amt) {
+static void SBC_help(processor_t *processor, uint8_t amt) {
   uint8_t result =
-      processor.registers.accumulator - amt - processor.registers._status.c;
-  overflow_check(amt, result);
-  carry_check(result);
-  zero_check(result);
-  negative_check(result);
-  processor.registers.accumulator = result;
+      processor->registers.accumulator - amt - processor->registers._status.c;
+  overflow_check(processor, amt, result);
+  carry_check(processor, result);
+  zero_check(processor, result);
+  negative_check(processor, result);
+  processor->registers.accumulator = result;
 }
 
-static void SBC_im(void) {
-  uint8_t value = read_byte();
-  processor.clock_ticks += 2;
-  SBC_help(value);
+static void SBC_im(processor_t *processor) {
+  uint8_t value = read_byte(processor);
+  processor->clock_ticks += 2;
+  SBC_help(processor, value);
 }
 
-static void SBC_zero(void) {
-  uint8_t location = read_byte();
-  processor.clock_ticks += 3;
-  SBC_help(read_byte_at(location));
+static void SBC_zero(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  processor->clock_ticks += 3;
+  SBC_help(processor, read_byte_at(processor, location));
 }
 
-static void SBC_zerox(void) {
-  uint8_t location = read_byte();
-  uint8_t value = read_byte_at(location);
-  processor.clock_ticks += 4;
-  SBC_help(value);
+static void SBC_zerox(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  uint8_t value = read_byte_at(processor, location);
+  processor->clock_ticks += 4;
+  SBC_help(processor, value);
 }
 
-static void SBC_absolute(void) {
-  uint16_t location = read_word();
-  uint8_t value = read_byte_at(location);
-  processor.clock_ticks += 4;
-  SBC_help(value);
+static void SBC_absolute(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t value = read_byte_at(processor, location);
+  processor->clock_ticks += 4;
+  SBC_help(processor, value);
 }
 
-static void SBC_absolutex(void) {
-  uint16_t location = read_word();
-  uint8_t value = read_byte_at(location + processor.registers.x);
-  processor.clock_ticks += 4 + page_check(location, processor.registers.x);
-  SBC_help(value);
+static void SBC_absolutex(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t value = read_byte_at(processor, location + processor->registers.x);
+  processor->clock_ticks += 4 + page_check(location, processor->registers.x);
+  SBC_help(processor, value);
 }
 
-static void SBC_absolutey(void) {
-  uint16_t location = read_word();
-  uint8_t value = read_byte_at(location + processor.registers.y);
-  processor.clock_ticks += 4 + page_check(location, processor.registers.y);
-  SBC_help(value);
+static void SBC_absolutey(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t value = read_byte_at(processor, location + processor->registers.y);
+  processor->clock_ticks += 4 + page_check(location, processor->registers.y);
+  SBC_help(processor, value);
 }
 
-static void SBC_indirectx(void) {
-  uint8_t address = read_byte();
-  uint8_t *ptr = indexed_indirect(address);
-  processor.clock_ticks += 6;
-  SBC_help(*ptr);
+static void SBC_indirectx(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  uint16_t target = indexed_indirect(processor, address);
+  processor->clock_ticks += 6;
+  SBC_help(processor, read_byte_at(processor, target));
 }
 
-static void SBC_indirecty(void) {
-  uint8_t address = read_byte();
+static void SBC_indirecty(processor_t *processor) {
+  uint8_t address = read_byte(processor);
   indirect_indexed(address);
-  processor.clock_ticks += 5 + page_check(location, processor.registers.y);
-  SBC_help(*value);
+  processor->clock_ticks += 5 + page_check(location, processor->registers.y);
+  SBC_help(processor, read_byte_at(processor, target));
 }
 
-static void SEC(void) {
-  processor.clock_ticks += 2;
-  processor.registers._status.c = true;
+static void SEC(processor_t *processor) {
+  processor->clock_ticks += 2;
+  processor->registers._status.c = true;
 }
-static void SED(void) {
-  processor.clock_ticks += 2;
-  processor.registers._status.d = true;
+static void SED(processor_t *processor) {
+  processor->clock_ticks += 2;
+  processor->registers._status.d = true;
 }
-static void SEI(void) {
-  processor.clock_ticks += 2;
-  processor.registers._status.i = true;
+static void SEI(processor_t *processor) {
+  processor->clock_ticks += 2;
+  processor->registers._status.i = true;
 }
 
-static void STA_zero(void) {
-  uint8_t location = read_byte();
-  processor.clock_ticks += 3;
-  write_byte(processor.registers.accumulator, location);
+static void STA_zero(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  processor->clock_ticks += 3;
+  write_byte(processor, processor->registers.accumulator, location);
 }
 
-static void STA_zerox(void) {
-  uint8_t address = read_byte();
-  processor.clock_ticks += 4;
-  write_byte(processor.registers.accumulator, address + processor.registers.x);
+static void STA_zerox(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  processor->clock_ticks += 4;
+  write_byte(processor, processor->registers.accumulator,
+             address + processor->registers.x);
 }
 
-static void STA_absolute(void) {
-  uint16_t address = read_word();
-  processor.clock_ticks += 4;
-  write_byte(processor.registers.accumulator, address);
+static void STA_absolute(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  processor->clock_ticks += 4;
+  write_byte(processor, processor->registers.accumulator, address);
 }
 
-static void STA_absolutex(void) {
-  uint16_t address = read_word();
-  processor.clock_ticks += 4;
-  write_byte(processor.registers.accumulator, address + processor.registers.x);
+static void STA_absolutex(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  processor->clock_ticks += 4;
+  write_byte(processor, processor->registers.accumulator,
+             address + processor->registers.x);
 }
 
-static void STA_absolutey(void) {
-  uint16_t address = read_word();
-  processor.clock_ticks += 4;
-  write_byte(processor.registers.accumulator, address + processor.registers.y);
+static void STA_absolutey(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  processor->clock_ticks += 4;
+  write_byte(processor, processor->registers.accumulator,
+             address + processor->registers.y);
 }
 
-static void STA_indirectx(void) {
-  uint8_t address = read_byte();
-  uint8_t *ptr = indexed_indirect(address);
-  processor.clock_ticks += 6;
-  *ptr = processor.registers.accumulator;
+static void STA_indirectx(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  uint16_t target = indexed_indirect(processor, address);
+  processor->clock_ticks += 6;
+  write_byte(processor, processor->registers.accumulator, target);
 }
 
-static void STA_indirecty(void) {
-  uint8_t address = read_byte();
+static void STA_indirecty(processor_t *processor) {
+  uint8_t address = read_byte(processor);
   indirect_indexed(address);
-  processor.clock_ticks += 6;
-  *value = processor.registers.accumulator;
+  processor->clock_ticks += 6;
+  write_byte(processor, processor->registers.accumulator, target);
 }
 
-static void STX_zero(void) {
-  processor.clock_ticks += 3;
-  uint8_t location = read_byte();
-  write_byte(processor.registers.x, location);
+static void STX_zero(processor_t *processor) {
+  processor->clock_ticks += 3;
+  uint8_t location = read_byte(processor);
+  write_byte(processor, processor->registers.x, location);
 }
-static void STX_zeroy(void) {
-  processor.clock_ticks += 4;
-  uint8_t location = read_byte();
-  write_byte(processor.registers.x, location);
+static void STX_zeroy(processor_t *processor) {
+  processor->clock_ticks += 4;
+  uint8_t location = read_byte(processor);
+  write_byte(processor, processor->registers.x, location);
 }
-static void STX_absolute(void) {
-  processor.clock_ticks += 4;
-  uint16_t location = read_word();
-  write_byte(processor.registers.x, location);
+static void STX_absolute(processor_t *processor) {
+  processor->clock_ticks += 4;
+  uint16_t location = read_word(processor);
+  write_byte(processor, processor->registers.x, location);
 }
 
-static void STY_zero(void) {
-  uint8_t location = read_byte();
-  write_byte(processor.registers.y, location);
-  processor.clock_ticks += 3;
+static void STY_zero(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  write_byte(processor, processor->registers.y, location);
+  processor->clock_ticks += 3;
 }
-static void STY_zerox(void) {
-  uint8_t location = read_byte();
-  write_byte(processor.registers.y, location + processor.registers.x);
-  processor.clock_ticks += 4;
+static void STY_zerox(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  write_byte(processor, processor->registers.y,
+             location + processor->registers.x);
+  processor->clock_ticks += 4;
 }
-static void STY_absolute(void) {
-  uint16_t location = read_word();
-  write_byte(processor.registers.y, location + processor.registers.x);
-  processor.clock_ticks += 4;
+static void STY_absolute(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  write_byte(processor, processor->registers.y,
+             location + processor->registers.x);
+  processor->clock_ticks += 4;
 }
 
-static void TAX(void) {
-  processor.registers.x = processor.registers.accumulator;
-  zero_check(processor.registers.x);
-  negative_check(processor.registers.x);
-  processor.clock_ticks += 2;
+static void TAX(processor_t *processor) {
+  processor->registers.x = processor->registers.accumulator;
+  zero_check(processor, processor->registers.x);
+  negative_check(processor, processor->registers.x);
+  processor->clock_ticks += 2;
 }
 
-static void TAY(void) {
-  processor.registers.y = processor.registers.accumulator;
-  zero_check(processor.registers.y);
-  negative_check(processor.registers.y);
-  processor.clock_ticks += 4;
+static void TAY(processor_t *processor) {
+  processor->registers.y = processor->registers.accumulator;
+  zero_check(processor, processor->registers.y);
+  negative_check(processor, processor->registers.y);
+  processor->clock_ticks += 4;
 }
-static void TSX(void) {
-  processor.registers.x = processor.registers._sp;
-  zero_check(processor.registers.x);
-  negative_check(processor.registers.x);
-  processor.clock_ticks += 2;
+static void TSX(processor_t *processor) {
+  processor->registers.x = processor->registers._sp;
+  zero_check(processor, processor->registers.x);
+  negative_check(processor, processor->registers.x);
+  processor->clock_ticks += 2;
 }
 
-static void TXA(void) {
-  processor.registers.accumulator = processor.registers.x;
-  zero_check(processor.registers.accumulator);
-  negative_check(processor.registers.accumulator);
-  processor.clock_ticks += 2;
+static void TXA(processor_t *processor) {
+  processor->registers.accumulator = processor->registers.x;
+  zero_check(processor, processor->registers.accumulator);
+  negative_check(processor, processor->registers.accumulator);
+  processor->clock_ticks += 2;
 }
 
-static void TXS(void) {
-  processor.registers._sp = processor.registers.x;
-  zero_check(processor.registers.x);
-  negative_check(processor.registers.x);
-  processor.clock_ticks += 2;
+static void TXS(processor_t *processor) {
+  processor->registers._sp = processor->registers.x;
+  zero_check(processor, processor->registers.x);
+  negative_check(processor, processor->registers.x);
+  processor->clock_ticks += 2;
 }
 
-static void TYA(void) {
-  processor.registers.accumulator = processor.registers.y;
-  zero_check(processor.registers.accumulator);
-  negative_check(processor.registers.accumulator);
-  processor.clock_ticks += 2;
+static void TYA(processor_t *processor) {
+  processor->registers.accumulator = processor->registers.y;
+  zero_check(processor, processor->registers.accumulator);
+  negative_check(processor, processor->registers.accumulator);
+  processor->clock_ticks += 2;
 }
 
 /* UNDOCUMENTED OPCODES */
@@ -1908,497 +2450,536 @@ static void TYA(void) {
 /* add status flags for the following ones, might be unnecessary tbh, because of
  * the fact they're done in the helper functions */
 #ifdef UNOFFICIAL_OPCODES
-static void HLT(void) { exit(1); }
+static void HLT(processor_t *processor) { processor->error = HALTED; }
 
-static void ASO_absolute(void) {
-  uint16_t location = read_word();
-  uint8_t *value_ptr = dereference_address(location);
-  processor.clock_ticks += 6;
-  ASL_help(value_ptr);
-  ORA_help(*value_ptr);
+static void ASO_absolute(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t *value_ptr = dereference_address(processor, location);
+  processor->clock_ticks += 6;
+  ASL_help(processor, value_ptr);
+  ORA_help(processor, *value_ptr);
 }
 
-static void ASO_absolutex(void) {
-  uint16_t location = read_word();
-  uint8_t *value_ptr = dereference_address(location + processor.registers.x);
-  processor.clock_ticks += 7;
-  ASL_help(value_ptr);
-  ORA_help(*value_ptr);
+static void ASO_absolutex(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t *value_ptr = dereference_address(processor,
+                                           location + processor->registers.x);
+  processor->clock_ticks += 7;
+  ASL_help(processor, value_ptr);
+  ORA_help(processor, *value_ptr);
 }
 
-static void ASO_absolutey(void) {
-  uint16_t location = read_word();
-  uint8_t *value_ptr = dereference_address(location + processor.registers.y);
-  processor.clock_ticks += 7;
-  ASL_help(value_ptr);
-  ORA_help(*value_ptr);
+static void ASO_absolutey(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t *value_ptr = dereference_address(processor,
+                                           location + processor->registers.y);
+  processor->clock_ticks += 7;
+  ASL_help(processor, value_ptr);
+  ORA_help(processor, *value_ptr);
 }
 
-static void ASO_zero(void) {
-  uint8_t location = read_byte();
-  uint8_t *value = dereference_address(location);
-  ASL_help(value);
-  ORA_help(*value);
+static void ASO_zero(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  uint8_t *value = dereference_address(processor, location);
+  ASL_help(processor, value);
+  ORA_help(processor, *value);
 }
 
-static void ASO_zerox(void) {
-  uint8_t location = read_byte();
-  uint8_t *value = dereference_address(location + processor.registers.x);
-  processor.clock_ticks += 5;
-  ASL_help(value);
-  ORA_help(*value);
+static void ASO_zerox(processor_t *processor) {
+  uint8_t location = read_byte(processor);
+  uint8_t *value = dereference_address(processor,
+                                       location + processor->registers.x);
+  processor->clock_ticks += 5;
+  ASL_help(processor, value);
+  ORA_help(processor, *value);
 }
 
-static void ASO_indirectx(void) {
-  uint8_t address = read_byte();
-  uint8_t *dereferenced = indexed_indirect(address);
-  processor.clock_ticks += 8;
-  ASL_help(dereferenced);
-  ORA_help(*dereferenced);
+static void ASO_indirectx(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  uint16_t target = indexed_indirect(processor, address);
+  uint8_t *dereferenced = dereference_address(processor, target);
+  processor->clock_ticks += 8;
+  ASL_help(processor, dereferenced);
+  ORA_help(processor, *dereferenced);
 }
 
-static void ASO_indirecty(void) {
-  uint8_t address = read_byte();
+static void ASO_indirecty(processor_t *processor) {
+  uint8_t address = read_byte(processor);
   indirect_indexed(address);
-  processor.clock_ticks += 8;
-  ASL_help(value);
-  ORA_help(*value);
-}
-
-static void RLA_absolute(void) {
-  uint16_t address = read_word();
-  uint8_t *dereferenced = dereference_address(address);
-  processor.clock_ticks += 6;
-  ROL_help(dereferenced);
-  AND_help(*dereferenced);
-}
-
-static void RLA_absolutex(void) {
-  uint16_t address = read_word();
-  uint8_t *dereferenced = dereference_address(address + processor.registers.x);
-  processor.clock_ticks += 7;
-  ROL_help(dereferenced);
-  AND_help(*dereferenced);
-}
-
-static void RLA_absolutey(void) {
-  uint16_t address = read_word();
-  uint8_t *dereferenced = dereference_address(address + processor.registers.y);
-  processor.clock_ticks += 7;
-  ROL_help(dereferenced);
-  AND_help(*dereferenced);
-}
-
-static void RLA_zero(void) {
-  uint8_t address = read_byte();
-  uint8_t *dereferenced = dereference_address(address);
-  processor.clock_ticks += 5;
-  ROL_help(dereferenced);
-  AND_help(*dereferenced);
-}
-
-static void RLA_zerox(void) {
-  uint8_t address = read_byte();
-  uint8_t *dereferenced = dereference_address(address + processor.registers.x);
-  processor.clock_ticks += 6;
-  ROL_help(dereferenced);
-  AND_help(*dereferenced);
-}
-
-static void RLA_indirectx(void) {
-  uint8_t address = read_byte();
-  uint8_t *dereferenced = indexed_indirect(address);
-  processor.clock_ticks += 8;
-  ROL_help(dereferenced);
-  AND_help(*dereferenced);
-}
-
-static void RLA_indirecty(void) {
-  uint8_t address = read_byte();
+  uint8_t *value = dereference_address(processor, target);
+  processor->clock_ticks += 8;
+  ASL_help(processor, value);
+  ORA_help(processor, *value);
+}
+
+static void RLA_absolute(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  uint8_t *dereferenced = dereference_address(processor, address);
+  processor->clock_ticks += 6;
+  ROL_help(processor, dereferenced);
+  AND_help(processor, *dereferenced);
+}
+
+static void RLA_absolutex(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  uint8_t *dereferenced = dereference_address(processor,
+                                              address + processor->registers.x);
+  processor->clock_ticks += 7;
+  ROL_help(processor, dereferenced);
+  AND_help(processor, *dereferenced);
+}
+
+static void RLA_absolutey(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  uint8_t *dereferenced = dereference_address(processor,
+                                              address + processor->registers.y);
+  processor->clock_ticks += 7;
+  ROL_help(processor, dereferenced);
+  AND_help(processor, *dereferenced);
+}
+
+static void RLA_zero(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  uint8_t *dereferenced = dereference_address(processor, address);
+  processor->clock_ticks += 5;
+  ROL_help(processor, dereferenced);
+  AND_help(processor, *dereferenced);
+}
+
+static void RLA_zerox(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  uint8_t *dereferenced = dereference_address(processor,
+                                              address + processor->registers.x);
+  processor->clock_ticks += 6;
+  ROL_help(processor, dereferenced);
+  AND_help(processor, *dereferenced);
+}
+
+static void RLA_indirectx(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  uint16_t target = indexed_indirect(processor, address);
+  uint8_t *dereferenced = dereference_address(processor, target);
+  processor->clock_ticks += 8;
+  ROL_help(processor, dereferenced);
+  AND_help(processor, *dereferenced);
+}
+
+static void RLA_indirecty(processor_t *processor) {
+  uint8_t address = read_byte(processor);
   indirect_indexed(address);
-  processor.clock_ticks += 8;
-  ROL_help(value);
-  AND_help(*value);
+  uint8_t *value = dereference_address(processor, target);
+  processor->clock_ticks += 8;
+  ROL_help(processor, value);
+  AND_help(processor, *value);
 }
 
-static void LSE_absolute(void) {
-  uint16_t location = read_word();
-  uint8_t *value_ptr = dereference_address(location);
-  processor.clock_ticks += 6;
-  LSR_help(value_ptr);
-  EOR_help(*value_ptr);
+static void LSE_absolute(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t *value_ptr = dereference_address(processor, location);
+  processor->clock_ticks += 6;
+  LSR_help(processor, value_ptr);
+  EOR_help(processor, *value_ptr);
 }
 
-static void LSE_absolutex(void) {
-  uint16_t address = read_word();
-  uint8_t *dereferenced = dereference_address(address + processor.registers.x);
-  processor.clock_ticks += 7;
-  LSR_help(dereferenced);
-  EOR_help(*dereferenced);
+static void LSE_absolutex(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  uint8_t *dereferenced = dereference_address(processor,
+                                              address + processor->registers.x);
+  processor->clock_ticks += 7;
+  LSR_help(processor, dereferenced);
+  EOR_help(processor, *dereferenced);
 }
 
-static void LSE_absolutey(void) {
-  uint16_t address = read_word();
-  uint8_t *dereferenced = dereference_address(address + processor.registers.y);
-  processor.clock_ticks += 7;
-  LSR_help(dereferenced);
-  EOR_help(*dereferenced);
+static void LSE_absolutey(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  uint8_t *dereferenced = dereference_address(processor,
+                                              address + processor->registers.y);
+  processor->clock_ticks += 7;
+  LSR_help(processor, dereferenced);
+  EOR_help(processor, *dereferenced);
 }
 
-static void LSE_zero(void) {
-  uint8_t address = read_byte();
-  uint8_t *dereferenced = dereference_address(address);
-  processor.clock_ticks += 5;
-  LSR_help(dereferenced);
-  EOR_help(*dereferenced);
+static void LSE_zero(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  uint8_t *dereferenced = dereference_address(processor, address);
+  processor->clock_ticks += 5;
+  LSR_help(processor, dereferenced);
+  EOR_help(processor, *dereferenced);
 }
 
-static void LSE_zerox(void) {
-  uint8_t address = read_byte();
-  uint8_t *dereferenced = dereference_address(address);
-  processor.clock_ticks += 6;
-  LSR_help(dereferenced);
-  EOR_help(*dereferenced);
+static void LSE_zerox(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  uint8_t *dereferenced = dereference_address(processor, address);
+  processor->clock_ticks += 6;
+  LSR_help(processor, dereferenced);
+  EOR_help(processor, *dereferenced);
 }
 
-static void LSE_indirectx(void) {
-  uint8_t address = read_byte();
-  uint8_t *dereferenced = indexed_indirect(address);
-  processor.clock_ticks += 8;
-  LSR_help(dereferenced);
-  EOR_help(*dereferenced);
+static void LSE_indirectx(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  uint16_t target = indexed_indirect(processor, address);
+  uint8_t *dereferenced = dereference_address(processor, target);
+  processor->clock_ticks += 8;
+  LSR_help(processor, dereferenced);
+  EOR_help(processor, *dereferenced);
 }
 
-static void LSE_indirecty(void) {
-  uint8_t address = read_byte();
+static void LSE_indirecty(processor_t *processor) {
+  uint8_t address = read_byte(processor);
   indirect_indexed(address);
-  processor.clock_ticks += 8;
-  LSR_help(value);
-  EOR_help(*value);
-}
-
-static void RRA_absolute(void) {
-  uint16_t address = read_word();
-  uint8_t *dereferenced = dereference_address(address);
-  processor.clock_ticks += 6;
-  ROR_help(dereferenced);
-  ADC_help(*dereferenced);
-}
-
-static void RRA_absolutex(void) {
-  uint16_t address = read_word();
-  uint8_t *dereferenced = dereference_address(address + processor.registers.x);
-  processor.clock_ticks += 7;
-  ROR_help(dereferenced);
-  ADC_help(*dereferenced);
-}
-
-static void RRA_absolutey(void) {
-  uint16_t address = read_word();
-  uint8_t *dereferenced = dereference_address(address + processor.registers.y);
-  processor.clock_ticks += 7;
-  ROR_help(dereferenced);
-  ADC_help(*dereferenced);
-}
-
-static void RRA_zero(void) {
-  uint16_t address = read_byte();
-  uint8_t *dereferenced = dereference_address(address);
-  processor.clock_ticks += 5;
-  ROR_help(dereferenced);
-  ADC_help(*dereferenced);
-}
-
-static void RRA_zerox(void) {
-  uint16_t address = read_byte();
-  uint8_t *dereferenced = dereference_address(address + processor.registers.x);
-  processor.clock_ticks += 6;
-  ROR_help(dereferenced);
-  ADC_help(*dereferenced);
-}
-
-static void RRA_indirectx(void) {
-  uint16_t address = read_byte();
-  uint8_t *dereferenced = indexed_indirect(address);
-  processor.clock_ticks += 8;
-  ROR_help(dereferenced);
-  ADC_help(*dereferenced);
-}
-
-static void RRA_indirecty(void) {
-  uint16_t address = read_byte();
+  uint8_t *value = dereference_address(processor, target);
+  processor->clock_ticks += 8;
+  LSR_help(processor, value);
+  EOR_help(processor, *value);
+}
+
+static void RRA_absolute(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  uint8_t *dereferenced = dereference_address(processor, address);
+  processor->clock_ticks += 6;
+  ROR_help(processor, dereferenced);
+  ADC_help(processor, *dereferenced);
+}
+
+static void RRA_absolutex(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  uint8_t *dereferenced = dereference_address(processor,
+                                              address + processor->registers.x);
+  processor->clock_ticks += 7;
+  ROR_help(processor, dereferenced);
+  ADC_help(processor, *dereferenced);
+}
+
+static void RRA_absolutey(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  uint8_t *dereferenced = dereference_address(processor,
+                                              address + processor->registers.y);
+  processor->clock_ticks += 7;
+  ROR_help(processor, dereferenced);
+  ADC_help(processor, *dereferenced);
+}
+
+static void RRA_zero(processor_t *processor) {
+  uint16_t address = read_byte(processor);
+  uint8_t *dereferenced = dereference_address(processor, address);
+  processor->clock_ticks += 5;
+  ROR_help(processor, dereferenced);
+  ADC_help(processor, *dereferenced);
+}
+
+static void RRA_zerox(processor_t *processor) {
+  uint16_t address = read_byte(processor);
+  uint8_t *dereferenced = dereference_address(processor,
+                                              address + processor->registers.x);
+  processor->clock_ticks += 6;
+  ROR_help(processor, dereferenced);
+  ADC_help(processor, *dereferenced);
+}
+
+static void RRA_indirectx(processor_t *processor) {
+  uint16_t address = read_byte(processor);
+  uint16_t target = indexed_indirect(processor, address);
+  uint8_t *dereferenced = dereference_address(processor, target);
+  processor->clock_ticks += 8;
+  ROR_help(processor, dereferenced);
+  ADC_help(processor, *dereferenced);
+}
+
+static void RRA_indirecty(processor_t *processor) {
+  uint16_t address = read_byte(processor);
   indirect_indexed(address);
-  processor.clock_ticks += 8;
-  ROR_help(value);
-  ADC_help(*value);
+  uint8_t *value = dereference_address(processor, target);
+  processor->clock_ticks += 8;
+  ROR_help(processor, value);
+  ADC_help(processor, *value);
 }
 
-static void AXS_absolute(void) {
-  uint16_t address = read_word();
-  uint8_t *dereferenced = dereference_address(address);
-  processor.clock_ticks += 4;
-  *dereferenced = processor.registers.accumulator & processor.registers.x;
+static void AXS_absolute(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  uint8_t *dereferenced = dereference_address(processor, address);
+  processor->clock_ticks += 4;
+  *dereferenced = processor->registers.accumulator & processor->registers.x;
 }
 
-static void AXS_zero(void) {
-  uint8_t address = read_byte();
-  uint8_t *dereferenced = dereference_address(address);
-  processor.clock_ticks += 3;
-  *dereferenced = processor.registers.accumulator & processor.registers.x;
+static void AXS_zero(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  uint8_t *dereferenced = dereference_address(processor, address);
+  processor->clock_ticks += 3;
+  *dereferenced = processor->registers.accumulator & processor->registers.x;
 }
 
-static void AXS_zeroy(void) {
-  uint8_t address = read_byte();
-  uint8_t *dereferenced = dereference_address(address + processor.registers.y);
-  processor.clock_ticks += 4;
-  *dereferenced = processor.registers.accumulator & processor.registers.x;
+static void AXS_zeroy(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  uint8_t *dereferenced = dereference_address(processor,
+                                              address + processor->registers.y);
+  processor->clock_ticks += 4;
+  *dereferenced = processor->registers.accumulator & processor->registers.x;
 }
 
-static void AXS_indirectx(void) {
-  uint8_t address = read_byte();
-  uint8_t *dereferenced = indexed_indirect(address);
-  processor.clock_ticks += 6;
-  *dereferenced = processor.registers.accumulator & processor.registers.x;
+static void AXS_indirectx(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  uint16_t target = indexed_indirect(processor, address);
+  processor->clock_ticks += 6;
+  write_byte(processor,
+             processor->registers.accumulator & processor->registers.x, target);
 }
 
-static void LAX_absolute(void) {
-  uint16_t address = read_word();
-  uint8_t *dereferenced = dereference_address(address);
-  processor.clock_ticks += 4;
-  processor.registers.x = *dereferenced;
-  processor.registers.accumulator = *dereferenced;
+static void LAX_absolute(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  uint8_t *dereferenced = dereference_address(processor, address);
+  processor->clock_ticks += 4;
+  processor->registers.x = *dereferenced;
+  processor->registers.accumulator = *dereferenced;
 }
 
-static void LAX_absolutey(void) {
-  uint16_t address = read_word();
-  uint8_t *dereferenced = dereference_address(address + processor.registers.y);
-  processor.clock_ticks += 4 + page_check(address, processor.registers.y);
-  processor.registers.x = *dereferenced;
-  processor.registers.accumulator = *dereferenced;
+static void LAX_absolutey(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  uint8_t *dereferenced = dereference_address(processor,
+                                              address + processor->registers.y);
+  processor->clock_ticks += 4 + page_check(address, processor->registers.y);
+  processor->registers.x = *dereferenced;
+  processor->registers.accumulator = *dereferenced;
 }
 
-static void LAX_zero(void) {
-  uint16_t address = read_word();
-  uint8_t *dereferenced = dereference_address(address);
-  processor.clock_ticks += 3;
-  processor.registers.x = *dereferenced;
-  processor.registers.accumulator = *dereferenced;
+static void LAX_zero(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  uint8_t *dereferenced = dereference_address(processor, address);
+  processor->clock_ticks += 3;
+  processor->registers.x = *dereferenced;
+  processor->registers.accumulator = *dereferenced;
 }
 
-static void LAX_zeroy(void) {
-  uint16_t address = read_word();
-  uint8_t *dereferenced = dereference_address(address + processor.registers.y);
-  processor.clock_ticks += 4;
-  processor.registers.x = *dereferenced;
-  processor.registers.accumulator = *dereferenced;
+static void LAX_zeroy(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  uint8_t *dereferenced = dereference_address(processor,
+                                              address + processor->registers.y);
+  processor->clock_ticks += 4;
+  processor->registers.x = *dereferenced;
+  processor->registers.accumulator = *dereferenced;
 }
 
-static void LAX_indirectx(void) {
-  uint16_t address = read_word();
-  uint8_t *dereferenced = indexed_indirect(address);
-  processor.clock_ticks += 6;
-  processor.registers.x = *dereferenced;
-  processor.registers.accumulator = *dereferenced;
+static void LAX_indirectx(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  uint8_t value =
+      read_byte_at(processor, indexed_indirect(processor, address));
+  processor->clock_ticks += 6;
+  processor->registers.x = value;
+  processor->registers.accumulator = value;
 }
 
-static void LAX_indirecty(void) {
-  uint16_t address = read_word();
+static void LAX_indirecty(processor_t *processor) {
+  uint16_t address = read_word(processor);
   indirect_indexed(address);
-  processor.clock_ticks += 5 + page_check(location, processor.registers.y);
-  processor.registers.x = *value;
-  processor.registers.accumulator = *value;
+  uint8_t value = read_byte_at(processor, target);
+  processor->clock_ticks += 5 + page_check(location, processor->registers.y);
+  processor->registers.x = value;
+  processor->registers.accumulator = value;
 }
 
-static void DCM_help(uint8_t *address) {
+static void DCM_help(processor_t *processor, uint8_t *address) {
   (*address)--;
-  cmp_help(*address, processor.registers.accumulator);
+  cmp_help(processor, *address, processor->registers.accumulator);
 }
 
-static void DCM_absolute(void) {
-  uint16_t address = read_word();
-  processor.clock_ticks += 6;
-  DCM_help(dereference_address(address));
+static void DCM_absolute(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  processor->clock_ticks += 6;
+  DCM_help(processor, dereference_address(processor, address));
 }
 
-static void DCM_absolutex(void) {
-  uint16_t address = read_word();
-  processor.clock_ticks += 7;
-  DCM_help(dereference_address(address + processor.registers.x));
+static void DCM_absolutex(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  processor->clock_ticks += 7;
+  DCM_help(processor, dereference_address(processor,
+                                          address + processor->registers.x));
 }
 
-static void DCM_absolutey(void) {
-  uint16_t address = read_word();
-  processor.clock_ticks += 7;
-  DCM_help(dereference_address(address + processor.registers.y));
+static void DCM_absolutey(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  processor->clock_ticks += 7;
+  DCM_help(processor, dereference_address(processor,
+                                          address + processor->registers.y));
 }
 
-static void DCM_zero(void) {
-  uint8_t address = read_byte();
-  processor.clock_ticks += 5;
-  DCM_help(dereference_address(address));
+static void DCM_zero(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  processor->clock_ticks += 5;
+  DCM_help(processor, dereference_address(processor, address));
 }
 
-static void DCM_zerox(void) {
-  uint8_t address = read_byte();
-  processor.clock_ticks += 6;
-  DCM_help(dereference_address(address + processor.registers.x));
+static void DCM_zerox(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  processor->clock_ticks += 6;
+  DCM_help(processor, dereference_address(processor,
+                                          address + processor->registers.x));
 }
 
-static void DCM_indirectx(void) {
-  uint8_t address = read_byte();
-  processor.clock_ticks += 8;
-  DCM_help(indexed_indirect(address));
+static void DCM_indirectx(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  processor->clock_ticks += 8;
+  uint16_t target = indexed_indirect(processor, address);
+  DCM_help(processor, dereference_address(processor, target));
 }
 
-static void DCM_indirecty(void) {
-  uint8_t address = read_byte();
+static void DCM_indirecty(processor_t *processor) {
+  uint8_t address = read_byte(processor);
   indirect_indexed(address);
-  processor.clock_ticks += 8;
-  DCM_help(value);
+  uint8_t *value = dereference_address(processor, target);
+  processor->clock_ticks += 8;
+  DCM_help(processor, value);
 }
 
-static void INS_help(uint8_t *address) {
+static void INS_help(processor_t *processor, uint8_t *address) {
   (*address)++;
-  SBC_help(*address);
+  SBC_help(processor, *address);
 }
 
-static void INS_absolute(void) {
-  uint16_t address = read_word();
-  processor.clock_ticks += 6;
-  INS_help(dereference_address(address));
+static void INS_absolute(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  processor->clock_ticks += 6;
+  INS_help(processor, dereference_address(processor, address));
 }
 
-static void INS_absolutex(void) {
-  uint16_t address = read_word();
-  processor.clock_ticks += 7;
-  INS_help(dereference_address(address + processor.registers.x));
+static void INS_absolutex(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  processor->clock_ticks += 7;
+  INS_help(processor, dereference_address(processor,
+                                          address + processor->registers.x));
 }
 
-static void INS_absolutey(void) {
-  uint16_t address = read_word();
-  processor.clock_ticks += 7;
-  INS_help(dereference_address(address + processor.registers.y));
+static void INS_absolutey(processor_t *processor) {
+  uint16_t address = read_word(processor);
+  processor->clock_ticks += 7;
+  INS_help(processor, dereference_address(processor,
+                                          address + processor->registers.y));
 }
 
-static void INS_zero(void) {
-  uint8_t address = read_byte();
-  processor.clock_ticks += 5;
-  INS_help(dereference_address(address));
+static void INS_zero(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  processor->clock_ticks += 5;
+  INS_help(processor, dereference_address(processor, address));
 }
 
-static void INS_zerox(void) {
-  uint8_t address = read_byte();
-  processor.clock_ticks += 6;
-  INS_help(dereference_address(address + processor.registers.x));
+static void INS_zerox(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  processor->clock_ticks += 6;
+  INS_help(processor, dereference_address(processor,
+                                          address + processor->registers.x));
 }
 
-static void INS_indirectx(void) {
-  uint8_t address = read_byte();
-  processor.clock_ticks += 7;
-  INS_help(indexed_indirect(address));
+static void INS_indirectx(processor_t *processor) {
+  uint8_t address = read_byte(processor);
+  processor->clock_ticks += 7;
+  uint16_t target = indexed_indirect(processor, address);
+  INS_help(processor, dereference_address(processor, target));
 }
 
-static void INS_indirecty(void) {
-  uint8_t address = read_byte();
+static void INS_indirecty(processor_t *processor) {
+  uint8_t address = read_byte(processor);
   indirect_indexed(address);
-  processor.clock_ticks += 8;
-  INS_help(value);
+  uint8_t *value = dereference_address(processor, target);
+  processor->clock_ticks += 8;
+  INS_help(processor, value);
 }
 
-static void ALR(void) {
-  uint8_t value = read_byte();
-  processor.clock_ticks += 2;
-  AND_help(value);
-  LSR_help(&processor.registers.accumulator);
+static void ALR(processor_t *processor) {
+  uint8_t value = read_byte(processor);
+  processor->clock_ticks += 2;
+  AND_help(processor, value);
+  LSR_help(processor, &processor->registers.accumulator);
 }
 
-static void ARR(void) {
-  uint8_t value = read_byte();
-  processor.clock_ticks += 2;
-  processor.registers.accumulator &= value;
-  ROR_help(&processor.registers.accumulator);
+static void ARR(processor_t *processor) {
+  uint8_t value = read_byte(processor);
+  processor->clock_ticks += 2;
+  processor->registers.accumulator &= value;
+  ROR_help(processor, &processor->registers.accumulator);
 }
 
-static void XAA(void) {
-  uint8_t value = read_byte();
-  processor.clock_ticks += 2;
-  processor.registers.accumulator = processor.registers.x & value;
+static void XAA(processor_t *processor) {
+  uint8_t value = read_byte(processor);
+  processor->clock_ticks += 2;
+  processor->registers.accumulator = processor->registers.x & value;
 }
 
-static void OAL(void) {
-  uint8_t value = read_byte();
-  processor.clock_ticks += 2;
-  ORA_help(0xee);
-  AND_help(value);
-  processor.registers.x = processor.registers.accumulator;
+static void OAL(processor_t *processor) {
+  uint8_t value = read_byte(processor);
+  processor->clock_ticks += 2;
+  ORA_help(processor, 0xee);
+  AND_help(processor, value);
+  processor->registers.x = processor->registers.accumulator;
 }
 
-static void SAX(void) {
-  uint8_t value = read_byte();
-  uint8_t calc_accumulator = processor.registers.accumulator;
-  processor.clock_ticks += 2;
-  calc_accumulator &= processor.registers.x;
+static void SAX(processor_t *processor) {
+  uint8_t value = read_byte(processor);
+  uint8_t calc_accumulator = processor->registers.accumulator;
+  processor->clock_ticks += 2;
+  calc_accumulator &= processor->registers.x;
   calc_accumulator -= value;
-  carry_check(calc_accumulator);
-  processor.registers.x = calc_accumulator;
-}
-static void TAS(void) {
-  uint16_t location = read_word();
-  uint8_t tmp = processor.registers.accumulator & processor.registers.x;
-  processor.clock_ticks += 5;
-  push_to_stack(processor.registers.x);
+  carry_check(processor, calc_accumulator);
+  processor->registers.x = calc_accumulator;
+}
+static void TAS(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t tmp = processor->registers.accumulator & processor->registers.x;
+  processor->clock_ticks += 5;
+  push_to_stack(processor, processor->registers.x);
   tmp &= ((location >> 8) + 1);
 
-  processor.memory[read_byte_at(location + processor.registers.y)] = tmp;
+  write_byte(processor, tmp,
+             read_byte_at(processor, location + processor->registers.y));
 }
 
 /* essentially the same as XAS but for Y register */
-static void SAY(void) {
-  uint16_t location = read_word();
-  uint8_t value = processor.registers.y & 0xf;
-  processor.clock_ticks += 5;
-  processor.memory[read_byte_at(location + processor.registers.x)] = value;
+static void SAY(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t value = processor->registers.y & 0xf;
+  processor->clock_ticks += 5;
+  write_byte(processor, value,
+             read_byte_at(processor, location + processor->registers.x));
 }
 
-static void XAS(void) {
-  uint16_t location = read_word();
-  uint8_t value = processor.registers.x & 0xf;
-  processor.clock_ticks += 5;
-  processor.memory[read_byte_at(location + processor.registers.x)] = value;
+static void XAS(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t value = processor->registers.x & 0xf;
+  processor->clock_ticks += 5;
+  write_byte(processor, value,
+             read_byte_at(processor, location + processor->registers.x));
 }
 
 /* TODO */
-static void AXA_absolutey(void) {
-  uint16_t location = read_word();
-  uint8_t written = processor.registers.accumulator & processor.registers.x &
+static void AXA_absolutey(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  uint8_t written = processor->registers.accumulator & processor->registers.x &
                     ((location >> 8) + 1);
-  processor.clock_ticks += 5;
-  write_byte(written, location + processor.registers.y);
+  processor->clock_ticks += 5;
+  write_byte(processor, written, location + processor->registers.y);
 }
 
-static void AXA_indirecty(void) {
-  uint8_t address = read_byte();
+static void AXA_indirecty(processor_t *processor) {
+  uint8_t address = read_byte(processor);
   uint8_t written =
-      processor.registers.accumulator & processor.registers.x & (address + 1);
+      processor->registers.accumulator & processor->registers.x & (address + 1);
   indirect_indexed(address);
-  processor.clock_ticks += 6;
-  write_byte(written, *value);
+  processor->clock_ticks += 6;
+  write_byte(processor, written, read_byte_at(processor, target));
 }
 
-static void ANC(void) {
-  uint8_t value = read_byte();
-  processor.registers.accumulator &= value;
-  processor.clock_ticks += 2;
-  processor.registers._status.c = processor.registers.accumulator & 0x80;
+static void ANC(processor_t *processor) {
+  uint8_t value = read_byte(processor);
+  processor->registers.accumulator &= value;
+  processor->clock_ticks += 2;
+  processor->registers._status.c = processor->registers.accumulator & 0x80;
 }
 
-static void LAS(void) {
-  uint16_t location = read_word();
-  processor.registers.accumulator =
-      read_byte_at(location + processor.registers.y) & peek_from_stack();
-  processor.clock_ticks += 4 + page_check(location, processor.registers.y);
-  negative_check(processor.registers.accumulator);
-  zero_check(processor.registers.accumulator);
+static void LAS(processor_t *processor) {
+  uint16_t location = read_word(processor);
+  processor->registers.accumulator =
+      read_byte_at(processor, location + processor->registers.y) &
+      peek_from_stack(processor);
+  processor->clock_ticks += 4 + page_check(location, processor->registers.y);
+  negative_check(processor, processor->registers.accumulator);
+  zero_check(processor, processor->registers.accumulator);
 }
 
 #endif
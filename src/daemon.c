@@ -0,0 +1,746 @@
+#define _XOPEN_SOURCE 700
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../headers/compress.h"
+#include "../headers/cpu.h"
+#include "../headers/hash.h"
+#include "../headers/snapshot.h"
+#include "../headers/state.h"
+
+/* headless daemon that keeps roms loaded and instances warm so a job costs
+ * only its emulation. Clients connect to a unix socket and send one request
+ * per line, every request is answered by one line as soon as it is done
+
+   load rom                  loads the rom if needed, answers with its hash
+   run rom budget [option]   rom is a path or a hash load answered with
+     budget         cycles to run, or frames with an f suffix
+     state=path     start from this save state instead of power on
+     inputs=hex     one controller byte (controller_buttons) per frame
+     stop=$addr[=v] stop on a write to addr (of v), as in m6502_batch
+     ram            answer with the internal ram in hex
+     hash           answer with m6502_snapshot_hash of the end state
+     save=path      write the end state to path as a save state
+   open rom [state=path]     starts a session, answers with its @id
+   run @id budget [option]   continues the session where it stopped
+   close @id                 ends the session
+   stats                     sessions and memory held
+   answers are `ok ...` or `error message`
+
+   sessions that were not used for the longest time are compressed to a
+   blob of their state once the daemon holds more than its memory budget
+   and are restored the next time they are used */
+
+#define DEFAULT_SOCKET "/tmp/m6502.sock"
+#define DEFAULT_BUDGET 256 /* MiB */
+
+typedef struct _rom {
+  char *path;
+  uint64_t hash;
+  processor_t *model; /* never run, every instance is cloned from it */
+  m6502_snapshot_t power_on;
+
+  processor_t **idle; /* instances waiting for the next job */
+  size_t idle_count;
+  size_t idle_capacity;
+  struct _rom *next;
+} rom_t;
+
+typedef struct {
+  rom_t *rom;
+  processor_t *processor; /* NULL while compressed */
+  uint8_t *blob;          /* the compressed snapshot */
+  size_t blob_size;
+  unsigned long long last_use;
+  bool busy; /* a request is using it, it is left alone */
+} session_t;
+
+typedef struct {
+  pthread_mutex_t lock; /* guards everything below */
+  rom_t *roms;
+  session_t **sessions; /* by id, NULL once closed */
+  size_t session_count;
+  size_t session_capacity;
+  unsigned long long uses; /* ticks on every session use */
+
+  /* idle and session instances plus blobs, in bytes, 0 budget for no
+   * limit */
+  size_t memory;
+  size_t budget;
+} daemon_t;
+
+typedef struct {
+  daemon_t *daemon;
+  int fd;
+} connection_t;
+
+typedef struct {
+  unsigned long long budget;
+  const char *state;
+  const char *save;
+  uint8_t *inputs;
+  size_t input_count;
+  bool has_stop;
+  uint16_t stop_address;
+  int stop_value; /* -1 for any value */
+  bool ram;
+  bool hash;
+} request_t;
+
+static volatile sig_atomic_t stopping;
+
+static void print_help(const char *name) {
+  fprintf(stderr, "usage: %s [-s socket] [-m MiB] [rom...]\n", name);
+  fprintf(stderr, "  -s  socket to listen on, defaults to " DEFAULT_SOCKET
+                  "\n");
+  fprintf(stderr, "  -m  memory for instances before idle sessions get "
+                  "compressed, defaults to %d, 0 for no limit\n",
+          DEFAULT_BUDGET);
+  fprintf(stderr, "  rom  roms to load before the first request\n");
+}
+
+static void stop(int signal) {
+  (void)signal;
+  stopping = 1;
+}
+
+static uint64_t rom_hash(const processor_t *processor) {
+  return hash_bytes(processor->memory + PRG_ROM_START, processor->rom_size, 0);
+}
+
+/* the caller holds the lock, loading is quick enough that nobody minds */
+static rom_t *find_rom(daemon_t *daemon, const char *name) {
+  char *end;
+  unsigned long long hash = strtoull(name, &end, 16);
+  bool is_hash = strlen(name) == 16 && *end == '\0';
+  /* the same rom reached through another path is still loaded once */
+  char path[PATH_MAX];
+  if (realpath(name, path) == NULL) {
+    if (!is_hash) {
+      return NULL;
+    }
+    path[0] = '\0';
+  }
+  for (rom_t *rom = daemon->roms; rom != NULL; rom = rom->next) {
+    if (strcmp(rom->path, path) == 0 || (is_hash && rom->hash == hash)) {
+      return rom;
+    }
+  }
+  if (path[0] == '\0') {
+    return NULL;
+  }
+
+  processor_t *model = m6502_create_headless(path);
+  if (model == NULL) {
+    return NULL;
+  }
+  rom_t *rom = calloc(1, sizeof(rom_t));
+  if (rom == NULL || (rom->path = strdup(path)) == NULL) {
+    free(rom);
+    m6502_destroy(model);
+    return NULL;
+  }
+  rom->model = model;
+  rom->hash = rom_hash(model);
+  m6502_save_snapshot(model, &rom->power_on);
+  rom->next = daemon->roms;
+  daemon->roms = rom;
+  return rom;
+}
+
+/* the caller holds the lock */
+static bool compress_session(daemon_t *daemon, session_t *session) {
+  m6502_snapshot_t snapshot;
+  m6502_save_snapshot(session->processor, &snapshot);
+  uint8_t *blob = malloc(compress_bound(sizeof(snapshot)));
+  if (blob == NULL) {
+    return false;
+  }
+  size_t size = compress_bytes(&snapshot, sizeof(snapshot), blob);
+  uint8_t *shrunk = realloc(blob, size);
+  session->blob = shrunk != NULL ? shrunk : blob;
+  session->blob_size = size;
+  m6502_destroy(session->processor);
+  session->processor = NULL;
+  daemon->memory -= sizeof(processor_t);
+  daemon->memory += size;
+  return true;
+}
+
+/* frees instances nobody is waiting for first, then compresses the
+ * sessions that were used the longest time ago. The caller holds the lock */
+static void enforce_budget(daemon_t *daemon) {
+  while (daemon->budget != 0 && daemon->memory > daemon->budget) {
+    rom_t *rom = daemon->roms;
+    while (rom != NULL && rom->idle_count == 0) {
+      rom = rom->next;
+    }
+    if (rom != NULL) {
+      m6502_destroy(rom->idle[--rom->idle_count]);
+      daemon->memory -= sizeof(processor_t);
+      continue;
+    }
+
+    session_t *oldest = NULL;
+    for (size_t i = 0; i < daemon->session_count; i++) {
+      session_t *session = daemon->sessions[i];
+      if (session != NULL && session->processor != NULL && !session->busy &&
+          (oldest == NULL || session->last_use < oldest->last_use)) {
+        oldest = session;
+      }
+    }
+    if (oldest == NULL || !compress_session(daemon, oldest)) {
+      return;
+    }
+  }
+}
+
+static processor_t *take_instance(daemon_t *daemon, rom_t *rom) {
+  pthread_mutex_lock(&daemon->lock);
+  processor_t *processor = NULL;
+  if (rom->idle_count > 0) {
+    processor = rom->idle[--rom->idle_count];
+    daemon->memory -= sizeof(processor_t);
+  }
+  pthread_mutex_unlock(&daemon->lock);
+  return processor != NULL ? processor : m6502_clone(rom->model);
+}
+
+static void return_instance(daemon_t *daemon, rom_t *rom,
+                            processor_t *processor) {
+  pthread_mutex_lock(&daemon->lock);
+  if (rom->idle_count == rom->idle_capacity) {
+    size_t capacity = rom->idle_capacity ? rom->idle_capacity * 2 : 8;
+    processor_t **idle = realloc(rom->idle, capacity * sizeof(processor_t *));
+    if (idle != NULL) {
+      rom->idle = idle;
+      rom->idle_capacity = capacity;
+    }
+  }
+  if (rom->idle_count < rom->idle_capacity) {
+    rom->idle[rom->idle_count++] = processor;
+    daemon->memory += sizeof(processor_t);
+    processor = NULL;
+  }
+  enforce_budget(daemon);
+  pthread_mutex_unlock(&daemon->lock);
+  m6502_destroy(processor);
+}
+
+static void restore_session(daemon_t *daemon, session_t *session) {
+  m6502_snapshot_t snapshot;
+  processor_t *processor = take_instance(daemon, session->rom);
+  if (processor == NULL ||
+      !decompress_bytes(session->blob, session->blob_size, &snapshot,
+                        sizeof(snapshot))) {
+    m6502_destroy(processor);
+    return;
+  }
+  m6502_load_snapshot(processor, &snapshot);
+  pthread_mutex_lock(&daemon->lock);
+  daemon->memory += sizeof(processor_t);
+  daemon->memory -= session->blob_size;
+  pthread_mutex_unlock(&daemon->lock);
+  free(session->blob);
+  session->blob = NULL;
+  session->processor = processor;
+}
+
+/* marks the session busy and makes sure it has an instance, NULL and
+ * `error` set if it can't be used */
+static session_t *use_session(daemon_t *daemon, const char *name,
+                              const char **error) {
+  char *end;
+  unsigned long id = strtoul(name + 1, &end, 10);
+  pthread_mutex_lock(&daemon->lock);
+  session_t *session = *end == '\0' && id < daemon->session_count
+                           ? daemon->sessions[id]
+                           : NULL;
+  if (session == NULL) {
+    *error = "no such session";
+  } else if (session->busy) {
+    *error = "session busy";
+    session = NULL;
+  } else {
+    session->busy = true;
+    session->last_use = ++daemon->uses;
+  }
+  pthread_mutex_unlock(&daemon->lock);
+
+  if (session != NULL && session->processor == NULL) {
+    restore_session(daemon, session);
+    if (session->processor == NULL) {
+      *error = "could not restore session";
+      pthread_mutex_lock(&daemon->lock);
+      session->busy = false;
+      pthread_mutex_unlock(&daemon->lock);
+      return NULL;
+    }
+  }
+  return session;
+}
+
+static void release_session(daemon_t *daemon, session_t *session) {
+  pthread_mutex_lock(&daemon->lock);
+  session->busy = false;
+  enforce_budget(daemon);
+  pthread_mutex_unlock(&daemon->lock);
+}
+
+static bool parse_hex(const char *text, uint8_t **bytes, size_t *count) {
+  size_t length = strlen(text);
+  if (length % 2 != 0) {
+    return false;
+  }
+  *count = length / 2;
+  *bytes = malloc(*count ? *count : 1);
+  for (size_t i = 0; *bytes != NULL && i < *count; i++) {
+    unsigned value;
+    if (sscanf(text + i * 2, "%2x", &value) != 1) {
+      return false;
+    }
+    (*bytes)[i] = value;
+  }
+  return *bytes != NULL;
+}
+
+static bool parse_stop(const char *token, request_t *request) {
+  unsigned address, value;
+  int consumed = 0;
+  if (sscanf(token, "$%x=%x%n", &address, &value, &consumed) == 2 &&
+      token[consumed] == '\0') {
+    request->stop_value = value & 0xff;
+  } else if (sscanf(token, "$%x%n", &address, &consumed) == 1 &&
+             token[consumed] == '\0') {
+    request->stop_value = -1;
+  } else {
+    return false;
+  }
+  request->has_stop = true;
+  request->stop_address = address & 0xffff;
+  return true;
+}
+
+/* parses what follows the rom of a run request, NULL or what was wrong */
+static const char *parse_run(char **save, request_t *request) {
+  char *budget = strtok_r(NULL, " \t\r\n", save);
+  if (budget == NULL) {
+    return "missing budget";
+  }
+  char *end;
+  errno = 0;
+  request->budget = strtoull(budget, &end, 10);
+  if (*end == 'f') {
+    request->budget *= FRAME_CYCLES;
+    end++;
+  }
+  if (errno != 0 || end == budget || *end != '\0') {
+    return "invalid budget";
+  }
+
+  for (char *option = strtok_r(NULL, " \t\r\n", save); option != NULL;
+       option = strtok_r(NULL, " \t\r\n", save)) {
+    if (strncmp(option, "state=", 6) == 0) {
+      request->state = option + 6;
+    } else if (strncmp(option, "save=", 5) == 0) {
+      request->save = option + 5;
+    } else if (strncmp(option, "inputs=", 7) == 0) {
+      free(request->inputs);
+      if (!parse_hex(option + 7, &request->inputs, &request->input_count)) {
+        return "invalid inputs";
+      }
+    } else if (strncmp(option, "stop=", 5) == 0) {
+      if (!parse_stop(option + 5, request)) {
+        return "invalid stop";
+      }
+    } else if (strcmp(option, "ram") == 0) {
+      request->ram = true;
+    } else if (strcmp(option, "hash") == 0) {
+      request->hash = true;
+    } else {
+      return "unknown option";
+    }
+  }
+  return NULL;
+}
+
+/* same frame by frame loop as m6502_batch, inputs and budget count from the
+ * state the job starts in */
+static const char *run(processor_t *processor, const request_t *request,
+                       int *value) {
+  unsigned long long start_frame = processor->frame;
+  unsigned long long budget = processor->clock_ticks + request->budget;
+  if (request->has_stop) {
+    m6502_add_watchpoint(processor, request->stop_address, WATCH_WRITE);
+  }
+  while (processor->clock_ticks < budget) {
+    unsigned long long frame = processor->frame - start_frame;
+    m6502_set_controller(processor, frame < request->input_count
+                                        ? request->inputs[frame]
+                                        : 0);
+    unsigned long long end =
+        processor->frame_end < budget ? processor->frame_end : budget;
+    int error = m6502_run(processor, end - processor->clock_ticks);
+    watch_hit_t hit;
+    if (m6502_get_watch_hit(processor, &hit)) {
+      if (request->stop_value == -1 || request->stop_value == hit.value) {
+        *value = hit.value;
+        return "stop";
+      }
+    } else if (error != SUCCESS) {
+      return m6502_strerror(error);
+    }
+  }
+  return "timeout";
+}
+
+static void report_run(processor_t *processor, const request_t *request,
+                       FILE *out) {
+  m6502_snapshot_t snapshot;
+  unsigned long long start_ticks = processor->clock_ticks;
+  unsigned long long start_frame = processor->frame;
+
+  int value = -1;
+  const char *status = run(processor, request, &value);
+  m6502_save_snapshot(processor, &snapshot);
+  fprintf(out, "ok \"%s\" cycles=%llu frames=%llu", status,
+          processor->clock_ticks - start_ticks, processor->frame - start_frame);
+  fprintf(out, " pc=$%04X a=$%02X x=$%02X y=$%02X p=$%02X",
+          processor->registers.pc, processor->registers.accumulator,
+          processor->registers.x, processor->registers.y,
+          processor->registers.status);
+  if (value != -1) {
+    fprintf(out, " value=$%02X", value);
+  }
+  if (request->hash) {
+    fprintf(out, " hash=%016llx",
+            (unsigned long long)m6502_snapshot_hash(&snapshot));
+  }
+  if (request->ram) {
+    fputs(" ram=", out);
+    for (size_t i = 0; i < INTERNAL_RAM_SIZE; i++) {
+      fprintf(out, "%02X", processor->memory[i]);
+    }
+  }
+  if (request->save != NULL && !m6502_write_state(&snapshot, request->save)) {
+    fprintf(out, " save-failed");
+  }
+  fputc('\n', out);
+  while (processor->watchpoint_count > 0) {
+    m6502_remove_watchpoint(processor, processor->watchpoints[0].address);
+  }
+}
+
+static void handle_run(daemon_t *daemon, rom_t *rom, request_t *request,
+                       FILE *out) {
+  m6502_snapshot_t snapshot = rom->power_on;
+  if (request->state != NULL && !m6502_read_state(request->state, &snapshot)) {
+    fprintf(out, "error could not read %s\n", request->state);
+    return;
+  }
+  processor_t *processor = take_instance(daemon, rom);
+  if (processor == NULL) {
+    fprintf(out, "error out of memory\n");
+    return;
+  }
+  m6502_load_snapshot(processor, &snapshot);
+  report_run(processor, request, out);
+  return_instance(daemon, rom, processor);
+}
+
+static void handle_open(daemon_t *daemon, rom_t *rom, char **save,
+                        FILE *out) {
+  m6502_snapshot_t snapshot = rom->power_on;
+  char *option = strtok_r(NULL, " \t\r\n", save);
+  if (option != NULL && (strncmp(option, "state=", 6) != 0 ||
+                         !m6502_read_state(option + 6, &snapshot))) {
+    fprintf(out, "error could not read %s\n", option);
+    return;
+  }
+  session_t *session = calloc(1, sizeof(session_t));
+  if (session == NULL ||
+      (session->processor = take_instance(daemon, rom)) == NULL) {
+    free(session);
+    fprintf(out, "error out of memory\n");
+    return;
+  }
+  session->rom = rom;
+  m6502_load_snapshot(session->processor, &snapshot);
+
+  pthread_mutex_lock(&daemon->lock);
+  if (daemon->session_count == daemon->session_capacity) {
+    size_t capacity =
+        daemon->session_capacity ? daemon->session_capacity * 2 : 64;
+    session_t **sessions =
+        realloc(daemon->sessions, capacity * sizeof(session_t *));
+    if (sessions != NULL) {
+      daemon->sessions = sessions;
+      daemon->session_capacity = capacity;
+    }
+  }
+  size_t id = daemon->session_count;
+  if (id < daemon->session_capacity) {
+    daemon->sessions[daemon->session_count++] = session;
+    daemon->memory += sizeof(processor_t);
+    session->last_use = ++daemon->uses;
+    enforce_budget(daemon);
+  }
+  pthread_mutex_unlock(&daemon->lock);
+
+  if (id < daemon->session_capacity) {
+    fprintf(out, "ok @%zu\n", id);
+  } else {
+    return_instance(daemon, rom, session->processor);
+    free(session);
+    fprintf(out, "error out of memory\n");
+  }
+}
+
+static void handle_close(daemon_t *daemon, const char *name, FILE *out) {
+  char *end;
+  unsigned long id = strtoul(name + 1, &end, 10);
+  pthread_mutex_lock(&daemon->lock);
+  session_t *session = *end == '\0' && id < daemon->session_count
+                           ? daemon->sessions[id]
+                           : NULL;
+  bool busy = session != NULL && session->busy;
+  if (session != NULL && !busy) {
+    daemon->sessions[id] = NULL;
+    daemon->memory -= session->processor != NULL ? sizeof(processor_t)
+                                                 : session->blob_size;
+  }
+  pthread_mutex_unlock(&daemon->lock);
+
+  if (session == NULL) {
+    fprintf(out, "error no such session\n");
+  } else if (busy) {
+    fprintf(out, "error session busy\n");
+  } else {
+    if (session->processor != NULL) {
+      return_instance(daemon, session->rom, session->processor);
+    }
+    free(session->blob);
+    free(session);
+    fprintf(out, "ok\n");
+  }
+}
+
+static void handle_session(daemon_t *daemon, const char *command,
+                           const char *name, char **save, FILE *out) {
+  if (strcmp(command, "close") == 0) {
+    handle_close(daemon, name, out);
+    return;
+  }
+  if (strcmp(command, "run") != 0) {
+    fprintf(out, "error unknown request %s\n", command);
+    return;
+  }
+  request_t request = {0};
+  const char *error = parse_run(save, &request);
+  m6502_snapshot_t snapshot;
+  session_t *session = NULL;
+  if (error == NULL && request.state != NULL &&
+      !m6502_read_state(request.state, &snapshot)) {
+    error = "could not read state";
+  }
+  if (error == NULL && (session = use_session(daemon, name, &error)) != NULL) {
+    if (request.state != NULL) {
+      m6502_load_snapshot(session->processor, &snapshot);
+    }
+    report_run(session->processor, &request, out);
+    release_session(daemon, session);
+  }
+  if (error != NULL) {
+    fprintf(out, "error %s\n", error);
+  }
+  free(request.inputs);
+}
+
+static void handle_stats(daemon_t *daemon, FILE *out) {
+  size_t sessions = 0, compressed = 0;
+  pthread_mutex_lock(&daemon->lock);
+  for (size_t i = 0; i < daemon->session_count; i++) {
+    sessions += daemon->sessions[i] != NULL;
+    compressed +=
+        daemon->sessions[i] != NULL && daemon->sessions[i]->processor == NULL;
+  }
+  size_t memory = daemon->memory;
+  pthread_mutex_unlock(&daemon->lock);
+  fprintf(out, "ok sessions=%zu compressed=%zu memory=%zu\n", sessions,
+          compressed, memory);
+}
+
+static void handle(daemon_t *daemon, char *line, FILE *out) {
+  char *save = NULL;
+  char *command = strtok_r(line, " \t\r\n", &save);
+  if (command == NULL) {
+    fprintf(out, "error empty request\n");
+    return;
+  }
+  if (strcmp(command, "stats") == 0) {
+    handle_stats(daemon, out);
+    return;
+  }
+  char *name = strtok_r(NULL, " \t\r\n", &save);
+  if (name == NULL) {
+    fprintf(out, "error missing rom\n");
+    return;
+  }
+  if (name[0] == '@') {
+    handle_session(daemon, command, name, &save, out);
+    return;
+  }
+  pthread_mutex_lock(&daemon->lock);
+  rom_t *rom = find_rom(daemon, name);
+  pthread_mutex_unlock(&daemon->lock);
+  if (rom == NULL) {
+    fprintf(out, "error could not load %s\n", name);
+    return;
+  }
+
+  if (strcmp(command, "load") == 0) {
+    fprintf(out, "ok %016llx\n", (unsigned long long)rom->hash);
+  } else if (strcmp(command, "run") == 0) {
+    request_t request = {0};
+    const char *error = parse_run(&save, &request);
+    if (error != NULL) {
+      fprintf(out, "error %s\n", error);
+    } else {
+      handle_run(daemon, rom, &request, out);
+    }
+    free(request.inputs);
+  } else if (strcmp(command, "open") == 0) {
+    handle_open(daemon, rom, &save, out);
+  } else {
+    fprintf(out, "error unknown request %s\n", command);
+  }
+}
+
+static void *serve(void *argument) {
+  connection_t *connection = argument;
+  int fd = dup(connection->fd);
+  FILE *in = fdopen(connection->fd, "r");
+  FILE *out = fd != -1 ? fdopen(fd, "w") : NULL;
+  if (in != NULL && out != NULL) {
+    char *line = NULL;
+    size_t capacity = 0;
+    while (getline(&line, &capacity, in) != -1) {
+      handle(connection->daemon, line, out);
+      if (fflush(out) != 0) {
+        break;
+      }
+    }
+    free(line);
+  }
+  if (in != NULL) {
+    fclose(in);
+  } else {
+    close(connection->fd);
+  }
+  if (out != NULL) {
+    fclose(out);
+  } else if (fd != -1) {
+    close(fd);
+  }
+  free(connection);
+  return NULL;
+}
+
+static int listen_on(const char *path) {
+  struct sockaddr_un address = {.sun_family = AF_UNIX};
+  if (strlen(path) >= sizeof(address.sun_path)) {
+    fprintf(stderr, "Error: socket path %s is too long\n", path);
+    return -1;
+  }
+  strcpy(address.sun_path, path);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd == -1) {
+    fprintf(stderr, "Error: could not create socket: %s\n", strerror(errno));
+    return -1;
+  }
+  unlink(path);
+  if (bind(fd, (struct sockaddr *)&address, sizeof(address)) == -1 ||
+      listen(fd, 64) == -1) {
+    fprintf(stderr, "Error: could not listen on %s: %s\n", path,
+            strerror(errno));
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+int main(int argc, char *argv[]) {
+  const char *socket_path = DEFAULT_SOCKET;
+  int option;
+  size_t budget = DEFAULT_BUDGET;
+  while ((option = getopt(argc, argv, "s:m:h")) != -1) {
+    switch (option) {
+    case 's':
+      socket_path = optarg;
+      break;
+    case 'm':
+      budget = strtoul(optarg, NULL, 10);
+      break;
+    default:
+      print_help(argv[0]);
+      return 1;
+    }
+  }
+
+  daemon_t daemon = {.budget = budget << 20};
+  pthread_mutex_init(&daemon.lock, NULL);
+  for (int i = optind; i < argc; i++) {
+    rom_t *rom = find_rom(&daemon, argv[i]);
+    if (rom == NULL) {
+      fprintf(stderr, "Error: could not load %s\n", argv[i]);
+      return 1;
+    }
+    printf("%016llx %s\n", (unsigned long long)rom->hash, rom->path);
+  }
+
+  /* no SA_RESTART, accept has to give up when asked to stop */
+  struct sigaction action = {.sa_handler = stop};
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+  signal(SIGPIPE, SIG_IGN);
+
+  int listener = listen_on(socket_path);
+  if (listener == -1) {
+    return 1;
+  }
+  fflush(stdout);
+  while (!stopping) {
+    int fd = accept(listener, NULL, NULL);
+    if (fd == -1) {
+      continue;
+    }
+    connection_t *connection = malloc(sizeof(connection_t));
+    pthread_t thread;
+    if (connection == NULL) {
+      close(fd);
+      continue;
+    }
+    connection->daemon = &daemon;
+    connection->fd = fd;
+    if (pthread_create(&thread, NULL, &serve, connection) != 0) {
+      close(fd);
+      free(connection);
+      continue;
+    }
+    pthread_detach(thread);
+  }
+
+  /* connections still being served keep the roms, the process is going
+   * away anyway */
+  close(listener);
+  unlink(socket_path);
+  return 0;
+}
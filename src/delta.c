@@ -0,0 +1,63 @@
+#include <string.h>
+
+#include "../headers/delta.h"
+
+static uint8_t *put_varint(uint8_t *out, size_t value) {
+  for (; value >= 0x80; value >>= 7) {
+    *out++ = (uint8_t)(value | 0x80);
+  }
+  *out++ = (uint8_t)value;
+  return out;
+}
+
+static const uint8_t *get_varint(const uint8_t *in, size_t *value) {
+  *value = 0;
+  for (unsigned shift = 0;; shift += 7) {
+    uint8_t byte = *in++;
+    *value |= (size_t)(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return in;
+    }
+  }
+}
+
+extern size_t delta_encode(const uint64_t *state, const uint64_t *base,
+                           size_t words, uint8_t *out) {
+  uint8_t *start = out;
+  for (size_t i = 0; i < words;) {
+    size_t unchanged = i;
+    while (i < words && state[i] == (base != NULL ? base[i] : 0)) {
+      i++;
+    }
+    size_t changed = i;
+    while (i < words && state[i] != (base != NULL ? base[i] : 0)) {
+      i++;
+    }
+    out = put_varint(out, changed - unchanged);
+    out = put_varint(out, i - changed);
+    for (size_t word = changed; word < i; word++) {
+      uint64_t delta = state[word] ^ (base != NULL ? base[word] : 0);
+      memcpy(out, &delta, sizeof(delta));
+      out += sizeof(delta);
+    }
+  }
+  return out - start;
+}
+
+extern void delta_apply(uint64_t *state, size_t words, const uint8_t *in,
+                        size_t size) {
+  const uint8_t *end = in + size;
+  size_t i = 0;
+  while (in < end) {
+    size_t skip, changed;
+    in = get_varint(in, &skip);
+    in = get_varint(in, &changed);
+    i += skip;
+    for (; changed > 0 && i < words; changed--, i++) {
+      uint64_t delta;
+      memcpy(&delta, in, sizeof(delta));
+      state[i] ^= delta;
+      in += sizeof(delta);
+    }
+  }
+}
@@ -0,0 +1,147 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../headers/env.h"
+#include "../headers/memo.h"
+#include "../headers/pool.h"
+
+struct _m6502_env {
+  processor_t **instances;
+  size_t count;
+  m6502_env_config_t config;
+  pool_t *pool;
+  uint32_t *scores; /* reward counter of every instance after its last step */
+  m6502_memo_t *memo; /* NULL to always emulate */
+
+  /* arguments of the step being run, read by the workers */
+  const uint8_t *actions;
+  unsigned frames;
+  float *rewards;
+  uint8_t *dones;
+  uint8_t *ram;
+};
+
+static uint32_t read_score(const m6502_env_t *env,
+                           const processor_t *processor) {
+  uint32_t score = 0;
+  for (uint8_t i = 0; i < env->config.reward_bytes && i < 4; i++) {
+    score |= (uint32_t)m6502_peek(processor, env->config.reward_address + i)
+             << (i * 8);
+  }
+  return score;
+}
+
+static bool is_done(const m6502_env_t *env, const processor_t *processor) {
+  return env->config.done_mask != 0 &&
+         (m6502_peek(processor, env->config.done_address) &
+          env->config.done_mask) == env->config.done_value;
+}
+
+static void copy_ram(const m6502_env_t *env, size_t index) {
+  if (env->ram != NULL) {
+    memcpy(env->ram + index * INTERNAL_RAM_SIZE,
+           env->instances[index]->memory, INTERNAL_RAM_SIZE);
+  }
+}
+
+static void reset_instance(void *context, size_t index, unsigned worker) {
+  (void)worker;
+  m6502_env_t *env = context;
+  m6502_reset(env->instances[index]);
+  env->scores[index] = read_score(env, env->instances[index]);
+  copy_ram(env, index);
+}
+
+static void step_instance(void *context, size_t index, unsigned worker) {
+  (void)worker;
+  m6502_env_t *env = context;
+  processor_t *processor = env->instances[index];
+
+  uint8_t buttons = env->actions != NULL ? env->actions[index] : 0;
+  m6502_set_controller(processor, buttons);
+  bool done = false;
+  for (unsigned frame = 0; frame < env->frames && !done; frame++) {
+    int error = env->memo != NULL
+                    ? m6502_memo_run_frames(env->memo, processor, buttons, 1)
+                    : m6502_run_frames(processor, 1);
+    done = error != SUCCESS || is_done(env, processor);
+  }
+
+  uint32_t score = read_score(env, processor);
+  if (env->rewards != NULL) {
+    env->rewards[index] = (float)(int32_t)(score - env->scores[index]);
+  }
+  env->scores[index] = score;
+  if (env->dones != NULL) {
+    env->dones[index] = done;
+  }
+
+  if (done && env->config.auto_reset) {
+    m6502_reset(processor);
+    env->scores[index] = read_score(env, processor);
+  }
+  copy_ram(env, index);
+}
+
+extern m6502_env_t *m6502_env_create(const char *rom_path, size_t count,
+                                     const m6502_env_config_t *config,
+                                     unsigned workers) {
+  m6502_env_t *env = calloc(1, sizeof(m6502_env_t));
+  if (env == NULL) {
+    return NULL;
+  }
+  env->config = *config;
+  env->instances = calloc(count, sizeof(processor_t *));
+  env->scores = calloc(count, sizeof(uint32_t));
+  env->pool = pool_create(workers, true);
+  if (env->instances == NULL || env->scores == NULL || env->pool == NULL) {
+    m6502_env_destroy(env);
+    return NULL;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    env->instances[i] = m6502_create_headless(rom_path);
+    if (env->instances[i] == NULL) {
+      m6502_env_destroy(env);
+      return NULL;
+    }
+    env->count++;
+    env->scores[i] = read_score(env, env->instances[i]);
+  }
+  return env;
+}
+
+extern void m6502_env_destroy(m6502_env_t *env) {
+  if (env == NULL) {
+    return;
+  }
+  for (size_t i = 0; i < env->count; i++) {
+    m6502_destroy(env->instances[i]);
+  }
+  pool_destroy(env->pool);
+  free(env->instances);
+  free(env->scores);
+  free(env);
+}
+
+extern size_t m6502_env_count(const m6502_env_t *env) { return env->count; }
+
+extern void m6502_env_set_memo(m6502_env_t *env, m6502_memo_t *memo) {
+  env->memo = memo;
+}
+
+extern void m6502_env_reset(m6502_env_t *env, uint8_t *ram) {
+  env->ram = ram;
+  pool_run(env->pool, env->count, &reset_instance, env);
+}
+
+extern void m6502_env_step(m6502_env_t *env, const uint8_t *actions,
+                           unsigned frames, float *rewards, uint8_t *dones,
+                           uint8_t *ram) {
+  env->actions = actions;
+  env->frames = frames;
+  env->rewards = rewards;
+  env->dones = dones;
+  env->ram = ram;
+  pool_run(env->pool, env->count, &step_instance, env);
+}
@@ -0,0 +1,137 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../headers/framehash.h"
+#include "../headers/hash.h"
+#include "../headers/snapshot.h"
+
+#define BLOCK_SIZE 256
+#define BLOCKS ((SNAPSHOT_STATE_SIZE + BLOCK_SIZE - 1) / BLOCK_SIZE)
+#define REGIONS 6
+
+_Static_assert(offsetof(m6502_snapshot_t, ppu_registers) % BLOCK_SIZE == 0 &&
+                   offsetof(m6502_snapshot_t, io_registers) % BLOCK_SIZE == 0 &&
+                   offsetof(m6502_snapshot_t, prg_ram) % BLOCK_SIZE == 0 &&
+                   offsetof(m6502_snapshot_t, oam) % BLOCK_SIZE == 0 &&
+                   offsetof(m6502_snapshot_t, pc) % BLOCK_SIZE == 0,
+               "every part of the snapshot starts a block of its own");
+
+struct _frame_hasher {
+  FILE *log;
+  uint64_t hash;
+  /* the frame hash is the finalised sum of the block hashes, which are
+   * seeded with their block number, so a changed block only has to replace
+   * its own term */
+  uint64_t block_hashes[BLOCKS];
+  uint64_t sum;
+  m6502_snapshot_t hashed;    /* the state the block hashes are of */
+  m6502_snapshot_t registers; /* only the part from `pc` on is used */
+};
+
+/* a part of the snapshot and where it lives in the instance */
+typedef struct {
+  size_t offset;
+  size_t size;
+  const uint8_t *source;
+} region_t;
+
+static void find_regions(const processor_t *processor,
+                         const m6502_snapshot_t *registers,
+                         region_t regions[REGIONS]) {
+  size_t pc = offsetof(m6502_snapshot_t, pc);
+  regions[0] = (region_t){offsetof(m6502_snapshot_t, ram), INTERNAL_RAM_SIZE,
+                          processor->memory};
+  regions[1] = (region_t){offsetof(m6502_snapshot_t, ppu_registers),
+                          BUS_PAGE_SIZE,
+                          processor->memory + PPU_REGISTERS_START};
+  regions[2] = (region_t){offsetof(m6502_snapshot_t, io_registers),
+                          BUS_PAGE_SIZE, processor->memory + IO_REGISTERS_START};
+  regions[3] = (region_t){offsetof(m6502_snapshot_t, prg_ram), PRG_RAM_SIZE,
+                          processor->pages[PRG_RAM_START >> 8]};
+  regions[4] = (region_t){offsetof(m6502_snapshot_t, oam), OAM_SIZE,
+                          processor->oam};
+  regions[5] = (region_t){pc, SNAPSHOT_STATE_SIZE - pc,
+                          (const uint8_t *)registers + pc};
+}
+
+static uint64_t hash_block(const frame_hasher_t *hasher, size_t offset,
+                           size_t size) {
+  return hash_lanes((const uint8_t *)&hasher->hashed + offset, size,
+                    offset / BLOCK_SIZE);
+}
+
+/* compares the instance against the hashed state straight from where it
+ * lives and copies and hashes only the blocks that changed. The compare is
+ * a vectorized memcmp, far cheaper than hashing, and in a frame only a few
+ * blocks change */
+static void update_blocks(frame_hasher_t *hasher, const processor_t *processor,
+                          bool all) {
+  save_snapshot_registers(processor, &hasher->registers);
+  region_t regions[REGIONS];
+  find_regions(processor, &hasher->registers, regions);
+
+  uint8_t *hashed = (uint8_t *)&hasher->hashed;
+  if (all) {
+    hasher->sum = 0;
+    memset(hasher->block_hashes, 0, sizeof(hasher->block_hashes));
+  }
+  for (size_t i = 0; i < REGIONS; i++) {
+    const region_t *region = &regions[i];
+    /* most regions are untouched in a frame, one long compare settles that
+     * cheaper than a compare per block */
+    if (!all && memcmp(hashed + region->offset, region->source,
+                       region->size) == 0) {
+      continue;
+    }
+    for (size_t done = 0; done < region->size; done += BLOCK_SIZE) {
+      size_t offset = region->offset + done;
+      size_t size = region->size - done < BLOCK_SIZE ? region->size - done
+                                                     : BLOCK_SIZE;
+      if (all || memcmp(hashed + offset, region->source + done, size) != 0) {
+        uint64_t *block_hash = &hasher->block_hashes[offset / BLOCK_SIZE];
+        memcpy(hashed + offset, region->source + done, size);
+        hasher->sum -= *block_hash;
+        *block_hash = hash_block(hasher, offset, size);
+        hasher->sum += *block_hash;
+      }
+    }
+  }
+  hasher->hash = hash_bytes(&hasher->sum, sizeof(hasher->sum), 0);
+}
+
+extern void update_frame_hash(frame_hasher_t *hasher,
+                              const processor_t *processor) {
+  update_blocks(hasher, processor, false);
+  if (hasher->log != NULL) {
+    fprintf(hasher->log, "frame %llu %016llx\n", processor->frame,
+            (unsigned long long)hasher->hash);
+  }
+}
+
+extern void close_frame_hasher(frame_hasher_t *hasher) { free(hasher); }
+
+extern bool m6502_hash_frames(processor_t *processor, FILE *log) {
+  frame_hasher_t *hasher = malloc(sizeof(frame_hasher_t));
+  if (hasher == NULL) {
+    return false;
+  }
+  hasher->log = log;
+  update_blocks(hasher, processor, true);
+
+  close_frame_hasher(processor->hasher);
+  processor->hasher = hasher;
+  return true;
+}
+
+extern void m6502_stop_hashing(processor_t *processor) {
+  close_frame_hasher(processor->hasher);
+  processor->hasher = NULL;
+}
+
+extern bool m6502_frame_hash(const processor_t *processor, uint64_t *hash) {
+  if (processor->hasher == NULL) {
+    return false;
+  }
+  *hash = processor->hasher->hash;
+  return true;
+}
@@ -0,0 +1,67 @@
+#include <string.h>
+
+#include "../headers/hash.h"
+
+#define HASH_PRIME_1 0x9e3779b97f4a7c15ULL
+#define HASH_PRIME_2 0xc2b2ae3d27d4eb4fULL
+
+static inline uint64_t rotate(uint64_t value, int bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+static inline uint64_t read64(const uint8_t *bytes) {
+  uint64_t word;
+  memcpy(&word, bytes, sizeof(word));
+  return word;
+}
+
+static inline uint64_t mix(uint64_t hash, uint64_t word) {
+  word *= HASH_PRIME_2;
+  word = rotate(word, 31) * HASH_PRIME_1;
+  return rotate(hash ^ word, 27) * HASH_PRIME_1 + HASH_PRIME_2;
+}
+
+extern uint64_t hash_bytes(const void *data, size_t size, uint64_t seed) {
+  const uint8_t *bytes = data;
+  uint64_t hash = seed ^ (size * HASH_PRIME_1);
+  for (; size >= 8; size -= 8, bytes += 8) {
+    uint64_t word;
+    memcpy(&word, bytes, sizeof(word));
+    hash = mix(hash, word);
+  }
+  if (size > 0) {
+    uint64_t word = 0;
+    memcpy(&word, bytes, size);
+    hash = mix(hash, word);
+  }
+
+  /* splitmix64 finaliser so every input bit reaches every output bit */
+  hash ^= hash >> 30;
+  hash *= 0xbf58476d1ce4e5b9ULL;
+  hash ^= hash >> 27;
+  hash *= 0x94d049bb133111ebULL;
+  return hash ^ (hash >> 31);
+}
+
+extern uint64_t hash_lanes(const void *data, size_t size, uint64_t seed) {
+  const uint8_t *bytes = data;
+  uint64_t total = size;
+  /* the lanes don't depend on each other, so their multiplies overlap. Kept
+   * in plain variables, as an array they end up in memory */
+  uint64_t lane0 = seed + HASH_PRIME_1 + HASH_PRIME_2;
+  uint64_t lane1 = seed + HASH_PRIME_2;
+  uint64_t lane2 = seed;
+  uint64_t lane3 = seed - HASH_PRIME_1;
+  for (; size >= 32; size -= 32, bytes += 32) {
+    lane0 = rotate(lane0 + read64(bytes) * HASH_PRIME_2, 31) * HASH_PRIME_1;
+    lane1 = rotate(lane1 + read64(bytes + 8) * HASH_PRIME_2, 31) * HASH_PRIME_1;
+    lane2 =
+        rotate(lane2 + read64(bytes + 16) * HASH_PRIME_2, 31) * HASH_PRIME_1;
+    lane3 =
+        rotate(lane3 + read64(bytes + 24) * HASH_PRIME_2, 31) * HASH_PRIME_1;
+  }
+  uint64_t hash = rotate(lane0, 1) + rotate(lane1, 7) + rotate(lane2, 12) +
+                  rotate(lane3, 18);
+  /* the tail and the finaliser */
+  return hash_bytes(bytes, size, hash ^ total);
+}
@@ -0,0 +1,30 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../headers/inputs.h"
+
+extern uint8_t *read_inputs(const char *path, size_t *frames) {
+  FILE *fp = fopen(path, "rb");
+  if (fp == NULL) {
+    return NULL;
+  }
+  size_t capacity = 4096;
+  uint8_t *inputs = malloc(capacity);
+  *frames = 0;
+  while (inputs != NULL) {
+    *frames += fread(inputs + *frames, 1, capacity - *frames, fp);
+    if (*frames < capacity) {
+      break;
+    }
+    capacity *= 2;
+    uint8_t *grown = realloc(inputs, capacity);
+    if (grown == NULL) {
+      free(inputs);
+      inputs = NULL;
+      break;
+    }
+    inputs = grown;
+  }
+  fclose(fp);
+  return inputs;
+}
@@ -7,9 +7,10 @@
 #include "../headers/logger.h"
 #define UNOFFICIAL_OPCODES
 
-static FILE *fp = NULL;
-
-void init_log(void) {
+bool init_log(processor_t *processor, const char *path) {
+  if (path != NULL) {
+    goto open;
+  }
   time_t now;
   struct tm *t;
   time(&now);
@@ -21,54 +22,38 @@ void init_log(void) {
 #else
   char *buffer = "m6502.log";
 #endif
-  printf("opening: %s\n", buffer);
+  path = buffer;
 
-  fp = fopen(buffer, "w");
-  if (fp == NULL) {
+open:
+  printf("opening: %s\n", path);
+  processor->log = fopen(path, "w");
+  if (processor->log == NULL) {
     printf("Error could not open file: %s", strerror(errno));
+    return false;
   }
+  return true;
 }
 
-static inline uint16_t read_word_at(processor_t *processor, uint16_t address) {
-  switch (address >> 14) {
-  case 1:
-    address &= ~0xffffc000;
-    break;
-  case 2:
-    address &= ~0xffffdff8;
-    break;
-  case 3:
-    address &= ~0xffff4000;
-    break;
-  }
-  uint16_t value =
-      (processor->memory[address] | (processor->memory[address + 1] << 8));
-  return value;
+static inline uint8_t read_byte_at(const processor_t *processor,
+                                   uint16_t address) {
+  return processor->pages[address >> 8][address & 0xff];
 }
 
-static inline uint8_t read_byte_at(processor_t *processor, uint16_t address) {
-  switch (address >> 14) {
-  case 1:
-    address &= ~0xffffc000; /* PRG RAM */
-    break;
-  case 2:
-    address &= ~0xffffdff8; /* APU */
-    break;
-  case 3:
-    address &= ~0xffff4000; /* PRG ROM */
-    break;
-  }
-  uint8_t value = processor->memory[address++];
+static inline uint16_t read_word_at(const processor_t *processor,
+                                    uint16_t address) {
+  uint16_t value = read_byte_at(processor, address) |
+                   (read_byte_at(processor, address + 1) << 8);
   return value;
 }
+
 /**
    @brief writes to a log file, if debug build it also prints to stdio
    this will probably be expanded on, to add the instructions
 
    this is a terribly written function which will probably never be optimized
-   @param reg cpu registers
+   @param processor the cpu about to run the instruction at pc
  */
-void log_cpu(processor_t processor) {
+void log_cpu(const processor_t *processor) {
   typedef struct {
     const char *const format;
     uint8_t len;
@@ -352,26 +337,27 @@ void log_cpu(processor_t processor) {
     return;
   }
   char buffer[516];
-  unsigned char opcode = read_byte_at(&processor, processor.registers.pc++);
+  uint16_t pc = processor->registers.pc;
+  unsigned char opcode = read_byte_at(processor, pc++);
   opcode_t info = ops[opcode];
   uint16_t arg = 0;
   const char *byte_strings[] = {"%.2X        ", "%.2X %.2X     ",
                                 "%.2X %.2X %.2X  "};
 
   if (info.format == NULL) {
-    fprintf(fp, "error: opcode $%x\n", opcode);
-    printf("Error invalid opcode: $%x, pc: $%x\n", opcode,
-           processor.registers.pc - 1);
-    exit(1);
+    /* the cpu reports the invalid opcode itself */
+    fprintf(processor->log, "error: opcode $%x\n", opcode);
+    free(format_buffer);
+    return;
   }
 
   if (info.len == 3) {
-    arg = read_word_at(&processor, processor.registers.pc);
+    arg = read_word_at(processor, pc);
   } else if (info.len == 2) {
-    arg = read_byte_at(&processor, processor.registers.pc);
+    arg = read_byte_at(processor, pc);
   }
 
-  sprintf(buffer, "%.4X\t", processor.registers.pc - 1);
+  sprintf(buffer, "%.4X\t", pc - 1);
   strncat(format_buffer, buffer, 1023);
   sprintf(buffer, byte_strings[info.len - 1], opcode, arg & 0xff, arg >> 8);
   strcat(format_buffer, buffer);
@@ -383,13 +369,13 @@ void log_cpu(processor_t processor) {
   }
   sprintf(buffer,
           "\t\tA: %02X X: %02X Y: %02X SP: %02X P: %.02X CYC: %llu\n",
-          processor.registers.accumulator, processor.registers.x,
-          processor.registers.y, processor.registers._sp,
-          processor.registers.status, processor.clock_ticks);
+          processor->registers.accumulator, processor->registers.x,
+          processor->registers.y, processor->registers._sp,
+          processor->registers.status, processor->clock_ticks);
 
   strcat(format_buffer, buffer);
-  if (fp != NULL) {
-    fprintf(fp, "%s", format_buffer);
+  if (processor->log != NULL) {
+    fprintf(processor->log, "%s", format_buffer);
   }
 #ifdef DEBUG
   printf(format_buffer);
@@ -397,10 +383,10 @@ void log_cpu(processor_t processor) {
   free(format_buffer);
 }
 
-void close_log() {
-  puts("freeing log");
-  if (fp != NULL) {
-    fclose(fp);
-    fp = NULL;
+void close_log(processor_t *processor) {
+  if (processor->log != NULL) {
+    puts("freeing log");
+    fclose(processor->log);
+    processor->log = NULL;
   }
 }
@@ -9,14 +9,23 @@ int main(int argc, char *argv[]) {
     exit(1);
   }
 
-  if (initialize_cpu_filename(argv[1]) == false) {
+  processor_t *processor = m6502_create(argv[1]);
+  if (processor == NULL) {
     fprintf(stderr,
             "Error: could not initialize cpu, file could no be accessed");
     return 1;
   }
+  m6502_open_log(processor, NULL);
 
-  while(1) {
-    interpret_opcode();
+  int error;
+  while ((error = m6502_step(processor)) == SUCCESS) {
   }
-  return 0;
+  fprintf(stderr, "Error: %s at pc: $%x\n", m6502_strerror(error),
+          processor->instruction_pc);
+
+#ifdef M6502_PROFILE
+  m6502_dump_access_profile(processor, "m6502_heatmap.csv");
+#endif
+  m6502_destroy(processor);
+  return 1;
 }
@@ -0,0 +1,262 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../headers/delta.h"
+#include "../headers/hash.h"
+#include "../headers/memo.h"
+
+/* only the part of the snapshot that m6502_snapshot_hash covers goes into the
+ * delta, the lag flags with it. The clock and frame counters are stored as
+ * what the frames added to them so an entry applies at any point in time */
+#define WORDS (SNAPSHOT_STATE_SIZE / sizeof(uint64_t))
+#define MIN_BUCKETS 1024
+
+_Static_assert(SNAPSHOT_STATE_SIZE % sizeof(uint64_t) == 0,
+               "states are xored word by word");
+
+typedef struct _entry {
+  struct _entry *next;  /* in its bucket */
+  struct _entry *newer; /* least recently used list */
+  struct _entry *older;
+
+  /* the key */
+  uint64_t hash;
+  uint64_t phase; /* cycles to the end of the frame when it started */
+  unsigned frames;
+  bool odd; /* the clock parity, oam dma takes a cycle more on odd ones */
+
+  /* what the frames did besides the delta */
+  uint64_t clock_ticks;
+  uint64_t frame_end;
+  size_t size;
+  uint8_t delta[];
+} entry_t;
+
+struct _m6502_memo {
+  pthread_mutex_t lock;
+  entry_t **buckets;
+  size_t bucket_count; /* power of 2 */
+  entry_t *newest;
+  entry_t *oldest;
+  size_t count;
+  size_t memory;
+  size_t limit;
+  unsigned long long hits, misses, evictions;
+};
+
+/* the snapshot as words, to hash, diff and xor */
+typedef union {
+  m6502_snapshot_t snapshot;
+  uint64_t words[sizeof(m6502_snapshot_t) / sizeof(uint64_t)];
+} state_t;
+
+static size_t entry_memory(const entry_t *entry) {
+  return sizeof(entry_t) + entry->size;
+}
+
+static entry_t **bucket(m6502_memo_t *memo, uint64_t hash) {
+  return &memo->buckets[hash & (memo->bucket_count - 1)];
+}
+
+static void unlink_lru(m6502_memo_t *memo, entry_t *entry) {
+  if (entry->newer != NULL) {
+    entry->newer->older = entry->older;
+  } else {
+    memo->newest = entry->older;
+  }
+  if (entry->older != NULL) {
+    entry->older->newer = entry->newer;
+  } else {
+    memo->oldest = entry->newer;
+  }
+}
+
+static void push_newest(m6502_memo_t *memo, entry_t *entry) {
+  entry->newer = NULL;
+  entry->older = memo->newest;
+  if (memo->newest != NULL) {
+    memo->newest->newer = entry;
+  } else {
+    memo->oldest = entry;
+  }
+  memo->newest = entry;
+}
+
+static void evict_oldest(m6502_memo_t *memo) {
+  entry_t *entry = memo->oldest;
+  entry_t **link = bucket(memo, entry->hash);
+  while (*link != entry) {
+    link = &(*link)->next;
+  }
+  *link = entry->next;
+  unlink_lru(memo, entry);
+  memo->count--;
+  memo->memory -= entry_memory(entry);
+  memo->evictions++;
+  free(entry);
+}
+
+/* a table that can't grow just gets longer chains */
+static void grow_buckets(m6502_memo_t *memo) {
+  size_t count = memo->bucket_count * 2;
+  entry_t **buckets = calloc(count, sizeof(entry_t *));
+  if (buckets == NULL) {
+    return;
+  }
+  for (size_t i = 0; i < memo->bucket_count; i++) {
+    for (entry_t *entry = memo->buckets[i], *next; entry != NULL;
+         entry = next) {
+      next = entry->next;
+      entry_t **head = &buckets[entry->hash & (count - 1)];
+      entry->next = *head;
+      *head = entry;
+    }
+  }
+  free(memo->buckets);
+  memo->memory += (count - memo->bucket_count) * sizeof(entry_t *);
+  memo->buckets = buckets;
+  memo->bucket_count = count;
+}
+
+static entry_t *find(m6502_memo_t *memo, const entry_t *key) {
+  for (entry_t *entry = *bucket(memo, key->hash); entry != NULL;
+       entry = entry->next) {
+    if (entry->hash == key->hash && entry->phase == key->phase &&
+        entry->frames == key->frames && entry->odd == key->odd) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+/* takes `entry`, freed if it can't be kept */
+static void insert(m6502_memo_t *memo, entry_t *entry) {
+  size_t table = memo->bucket_count * sizeof(entry_t *);
+  if (table + entry_memory(entry) > memo->limit || find(memo, entry) != NULL) {
+    /* too big, or another thread stored the same frames meanwhile */
+    free(entry);
+    return;
+  }
+  while (memo->count > 0 &&
+         memo->memory + entry_memory(entry) > memo->limit) {
+    evict_oldest(memo);
+  }
+  if (memo->count >= memo->bucket_count) {
+    grow_buckets(memo);
+  }
+  entry_t **head = bucket(memo, entry->hash);
+  entry->next = *head;
+  *head = entry;
+  push_newest(memo, entry);
+  memo->count++;
+  memo->memory += entry_memory(entry);
+}
+
+static bool cacheable(const processor_t *processor) {
+#if defined(M6502_PROFILE) || defined(M6502_UNINIT_CHECK)
+  (void)processor;
+  return false;
+#else
+  return processor->error == SUCCESS && processor->log == NULL &&
+         processor->hasher == NULL && processor->persist == NULL &&
+         processor->shared == NULL && processor->watchpoint_count == 0;
+#endif
+}
+
+extern m6502_memo_t *m6502_memo_create(size_t memory) {
+  m6502_memo_t *memo = calloc(1, sizeof(m6502_memo_t));
+  if (memo == NULL) {
+    return NULL;
+  }
+  memo->bucket_count = MIN_BUCKETS;
+  memo->buckets = calloc(memo->bucket_count, sizeof(entry_t *));
+  if (memo->buckets == NULL) {
+    free(memo);
+    return NULL;
+  }
+  memo->memory = memo->bucket_count * sizeof(entry_t *);
+  memo->limit = memory;
+  pthread_mutex_init(&memo->lock, NULL);
+  return memo;
+}
+
+extern void m6502_memo_destroy(m6502_memo_t *memo) {
+  if (memo == NULL) {
+    return;
+  }
+  for (entry_t *entry = memo->newest, *older; entry != NULL; entry = older) {
+    older = entry->older;
+    free(entry);
+  }
+  pthread_mutex_destroy(&memo->lock);
+  free(memo->buckets);
+  free(memo);
+}
+
+extern int m6502_memo_run_frames(m6502_memo_t *memo, processor_t *processor,
+                                 uint8_t buttons, unsigned frames) {
+  m6502_set_controller(processor, buttons);
+  if (!cacheable(processor)) {
+    return m6502_run_frames(processor, frames);
+  }
+
+  state_t state;
+  m6502_save_snapshot(processor, &state.snapshot);
+  entry_t key;
+  key.hash = hash_lanes(state.words, SNAPSHOT_STATE_SIZE, 0);
+  key.phase = processor->frame_end - processor->clock_ticks;
+  key.frames = frames;
+  key.odd = processor->clock_ticks & 1;
+
+  pthread_mutex_lock(&memo->lock);
+  entry_t *entry = find(memo, &key);
+  if (entry != NULL) {
+    unlink_lru(memo, entry);
+    push_newest(memo, entry);
+    memo->hits++;
+    /* applied under the lock, the entry could be evicted right after */
+    delta_apply(state.words, WORDS, entry->delta, entry->size);
+    state.snapshot.clock_ticks += entry->clock_ticks;
+    state.snapshot.frame += frames;
+    state.snapshot.frame_end += entry->frame_end;
+    pthread_mutex_unlock(&memo->lock);
+
+    m6502_load_snapshot(processor, &state.snapshot);
+    return SUCCESS;
+  }
+  memo->misses++;
+  pthread_mutex_unlock(&memo->lock);
+
+  int error = m6502_run_frames(processor, frames);
+  if (error != SUCCESS) {
+    return error;
+  }
+  state_t after;
+  m6502_save_snapshot(processor, &after.snapshot);
+  entry = malloc(sizeof(entry_t) + DELTA_BOUND(WORDS));
+  if (entry == NULL) {
+    return error;
+  }
+  *entry = key;
+  entry->clock_ticks = after.snapshot.clock_ticks - state.snapshot.clock_ticks;
+  entry->frame_end = after.snapshot.frame_end - state.snapshot.frame_end;
+  entry->size = delta_encode(after.words, state.words, WORDS, entry->delta);
+  entry_t *shrunk = realloc(entry, sizeof(entry_t) + entry->size);
+  entry = shrunk != NULL ? shrunk : entry;
+
+  pthread_mutex_lock(&memo->lock);
+  insert(memo, entry);
+  pthread_mutex_unlock(&memo->lock);
+  return error;
+}
+
+extern void m6502_memo_stats(m6502_memo_t *memo, m6502_memo_stats_t *stats) {
+  pthread_mutex_lock(&memo->lock);
+  stats->hits = memo->hits;
+  stats->misses = memo->misses;
+  stats->evictions = memo->evictions;
+  stats->entries = memo->count;
+  stats->memory = memo->memory;
+  pthread_mutex_unlock(&memo->lock);
+}
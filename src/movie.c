@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../headers/hash.h"
+#include "../headers/movie.h"
+#include "../headers/snapshot.h"
+
+#define MOVIE_MAGIC "M6MV"
+#define HEADER_SIZE 32
+/* over two years at 60 frames a second, a file claiming more is damaged */
+#define MAX_FRAMES (1ULL << 32)
+
+static void put16(uint8_t *bytes, uint16_t value) {
+  bytes[0] = value & 0xff;
+  bytes[1] = value >> 8;
+}
+
+static void put64(uint8_t *bytes, uint64_t value) {
+  for (int i = 0; i < 8; i++) {
+    bytes[i] = (value >> (8 * i)) & 0xff;
+  }
+}
+
+static uint16_t get16(const uint8_t *bytes) {
+  return bytes[0] | (uint16_t)bytes[1] << 8;
+}
+
+static uint64_t get64(const uint8_t *bytes) {
+  uint64_t value = 0;
+  for (int i = 0; i < 8; i++) {
+    value |= (uint64_t)bytes[i] << (8 * i);
+  }
+  return value;
+}
+
+static bool put_varint(FILE *fp, uint64_t value) {
+  for (; value >= 0x80; value >>= 7) {
+    if (fputc((int)(value & 0x7f) | 0x80, fp) == EOF) {
+      return false;
+    }
+  }
+  return fputc((int)value, fp) != EOF;
+}
+
+static bool get_varint(FILE *fp, uint64_t *value) {
+  *value = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    int byte = fgetc(fp);
+    if (byte == EOF) {
+      return false;
+    }
+    *value |= (uint64_t)(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static uint64_t rom_hash(const processor_t *processor) {
+  return hash_bytes(processor->memory + PRG_ROM_START, processor->rom_size, 0);
+}
+
+static uint64_t state_hash(const processor_t *processor) {
+  m6502_snapshot_t snapshot;
+  m6502_save_snapshot(processor, &snapshot);
+  return m6502_snapshot_hash(&snapshot);
+}
+
+static bool reserve(m6502_movie_t *movie, size_t count) {
+  if (count <= movie->capacity) {
+    return true;
+  }
+  size_t capacity = movie->capacity ? movie->capacity : 4096;
+  while (capacity < count) {
+    /* exactly what is needed once doubling would wrap */
+    capacity = capacity <= SIZE_MAX / 2 ? capacity * 2 : count;
+  }
+  uint8_t *inputs = realloc(movie->inputs, capacity);
+  if (inputs == NULL) {
+    return false;
+  }
+  movie->inputs = inputs;
+  uint8_t *lag = realloc(movie->lag, capacity);
+  if (lag == NULL) {
+    return false;
+  }
+  movie->lag = lag;
+  movie->capacity = capacity;
+  return true;
+}
+
+extern void m6502_start_movie(m6502_movie_t *movie, processor_t *processor) {
+  m6502_reset(processor);
+  movie->rom_hash = rom_hash(processor);
+  movie->inputs = NULL;
+  movie->lag = NULL;
+  movie->count = 0;
+  movie->capacity = 0;
+  movie->end_hash = state_hash(processor);
+}
+
+extern bool m6502_record_frame(m6502_movie_t *movie, processor_t *processor,
+                               uint8_t buttons) {
+  if (!reserve(movie, movie->count + 1)) {
+    return false;
+  }
+  m6502_set_controller(processor, buttons);
+  if (m6502_run_frames(processor, 1) != SUCCESS) {
+    return false;
+  }
+  movie->inputs[movie->count] = buttons;
+  movie->lag[movie->count] = m6502_lag_frame(processor);
+  movie->count++;
+  movie->end_hash = state_hash(processor);
+  return true;
+}
+
+extern int m6502_play_movie(const m6502_movie_t *movie,
+                            processor_t *processor, size_t *desync) {
+  m6502_reset(processor);
+  *desync = movie->count;
+  for (size_t frame = 0; frame < movie->count; frame++) {
+    m6502_set_controller(processor, movie->inputs[frame]);
+    int error = m6502_run_frames(processor, 1);
+    if (error != SUCCESS) {
+      *desync = frame;
+      return error;
+    }
+    if (*desync == movie->count &&
+        m6502_lag_frame(processor) != movie->lag[frame]) {
+      *desync = frame;
+    }
+  }
+  if (*desync == movie->count && state_hash(processor) != movie->end_hash) {
+    *desync = movie->count > 0 ? movie->count - 1 : 0;
+  }
+  return SUCCESS;
+}
+
+extern bool m6502_movie_matches(const m6502_movie_t *movie,
+                                const processor_t *processor) {
+  return movie->rom_hash == rom_hash(processor);
+}
+
+extern bool m6502_save_movie(const m6502_movie_t *movie, const char *path) {
+  FILE *fp = fopen(path, "wb");
+  if (fp == NULL) {
+    return false;
+  }
+  uint8_t header[HEADER_SIZE] = {0};
+  memcpy(header, MOVIE_MAGIC, 4);
+  put16(header + 4, MOVIE_VERSION);
+  put64(header + 8, movie->rom_hash);
+  put64(header + 16, movie->end_hash);
+  put64(header + 24, movie->count);
+  bool ok = fwrite(header, 1, HEADER_SIZE, fp) == HEADER_SIZE;
+
+  for (size_t frame = 0; ok && frame < movie->count;) {
+    size_t end = frame + 1;
+    while (end < movie->count && movie->inputs[end] == movie->inputs[frame] &&
+           movie->lag[end] == movie->lag[frame]) {
+      end++;
+    }
+    ok = put_varint(fp, (uint64_t)(end - frame) << 1 | movie->lag[frame]) &&
+         fputc(movie->inputs[frame], fp) != EOF;
+    frame = end;
+  }
+  return (fclose(fp) == 0) && ok;
+}
+
+extern bool m6502_load_movie(const char *path, m6502_movie_t *movie) {
+  FILE *fp = fopen(path, "rb");
+  if (fp == NULL) {
+    return false;
+  }
+  uint8_t header[HEADER_SIZE];
+  memset(movie, 0, sizeof(m6502_movie_t));
+  bool ok = fread(header, 1, HEADER_SIZE, fp) == HEADER_SIZE &&
+            memcmp(header, MOVIE_MAGIC, 4) == 0 &&
+            get16(header + 4) == MOVIE_VERSION;
+  uint64_t count = ok ? get64(header + 24) : 0;
+  ok = ok && count <= MAX_FRAMES && count <= SIZE_MAX;
+  if (ok) {
+    movie->rom_hash = get64(header + 8);
+    movie->end_hash = get64(header + 16);
+  }
+
+  /* grown with the runs actually read, not with what the header claims */
+  while (ok && movie->count < count) {
+    uint64_t run;
+    int buttons;
+    ok = get_varint(fp, &run) && (buttons = fgetc(fp)) != EOF &&
+         run >> 1 != 0 && run >> 1 <= count - movie->count &&
+         reserve(movie, movie->count + (size_t)(run >> 1));
+    if (ok) {
+      memset(movie->inputs + movie->count, buttons, run >> 1);
+      memset(movie->lag + movie->count, run & 1, run >> 1);
+      movie->count += run >> 1;
+    }
+  }
+  fclose(fp);
+  if (!ok) {
+    m6502_free_movie(movie);
+  }
+  return ok;
+}
+
+extern void m6502_free_movie(m6502_movie_t *movie) {
+  free(movie->inputs);
+  free(movie->lag);
+  movie->inputs = NULL;
+  movie->lag = NULL;
+  movie->count = 0;
+  movie->capacity = 0;
+}
@@ -0,0 +1,161 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../headers/cpu.h"
+#include "../headers/framehash.h"
+#include "../headers/inputs.h"
+#include "../headers/movie.h"
+
+/* command line front end of the movies, `record` turns an input file into a
+ * movie, `play` replays one headless as fast as it runs and can log the
+ * frame hashes of the playback */
+
+static void print_help(const char *name) {
+  fprintf(stderr,
+          "usage: %s record rom inputs movie\n"
+          "       %s play [-l hashes] rom movie\n",
+          name, name);
+  fprintf(stderr, "  inputs  one controller byte per frame\n");
+  fprintf(stderr, "  -l      write the hash of every frame here, - for "
+                  "stdout\n");
+}
+
+static double elapsed(const struct timespec *begin) {
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (end.tv_sec - begin->tv_sec) + (end.tv_nsec - begin->tv_nsec) / 1e9;
+}
+
+static size_t count_lag(const m6502_movie_t *movie) {
+  size_t lag = 0;
+  for (size_t frame = 0; frame < movie->count; frame++) {
+    lag += movie->lag[frame];
+  }
+  return lag;
+}
+
+static int record(int argc, char *argv[]) {
+  if (argc != 5) {
+    print_help(argv[0]);
+    return 1;
+  }
+  size_t input_count;
+  uint8_t *inputs = read_inputs(argv[3], &input_count);
+  if (inputs == NULL) {
+    fprintf(stderr, "Error: could not read input %s\n", argv[3]);
+    return 1;
+  }
+  processor_t *processor = m6502_create_headless(argv[2]);
+  if (processor == NULL) {
+    fprintf(stderr, "Error: could not load %s\n", argv[2]);
+    free(inputs);
+    return 1;
+  }
+
+  m6502_movie_t movie;
+  m6502_start_movie(&movie, processor);
+  int status = 0;
+  for (size_t frame = 0; frame < input_count; frame++) {
+    if (!m6502_record_frame(&movie, processor, inputs[frame])) {
+      fprintf(stderr, "Error: stopped in frame %zu, %s\n", frame,
+              processor->error != SUCCESS ? m6502_strerror(processor->error)
+                                          : "out of memory");
+      status = 1;
+      break;
+    }
+  }
+  if (status == 0 && !m6502_save_movie(&movie, argv[4])) {
+    fprintf(stderr, "Error: could not write %s\n", argv[4]);
+    status = 1;
+  }
+  if (status == 0) {
+    printf("recorded %zu frames, %zu lag frames\n", movie.count,
+           count_lag(&movie));
+  }
+  m6502_free_movie(&movie);
+  m6502_destroy(processor);
+  free(inputs);
+  return status;
+}
+
+static int play(int argc, char *argv[]) {
+  const char *hashes = NULL;
+  int option;
+  optind = 2;
+  while ((option = getopt(argc, argv, "l:h")) != -1) {
+    switch (option) {
+    case 'l':
+      hashes = optarg;
+      break;
+    default:
+      print_help(argv[0]);
+      return 1;
+    }
+  }
+  if (argc - optind != 2) {
+    print_help(argv[0]);
+    return 1;
+  }
+  const char *rom = argv[optind], *path = argv[optind + 1];
+
+  m6502_movie_t movie;
+  if (!m6502_load_movie(path, &movie)) {
+    fprintf(stderr, "Error: could not read movie %s\n", path);
+    return 1;
+  }
+  processor_t *processor = m6502_create_headless(rom);
+  FILE *log = NULL;
+  int status = 1;
+  if (processor == NULL) {
+    fprintf(stderr, "Error: could not load %s\n", rom);
+    goto done;
+  }
+  if (!m6502_movie_matches(&movie, processor)) {
+    fprintf(stderr, "Error: %s was recorded on another rom\n", path);
+    goto done;
+  }
+  if (hashes != NULL) {
+    log = strcmp(hashes, "-") == 0 ? stdout : fopen(hashes, "w");
+    if (log == NULL || !m6502_hash_frames(processor, log)) {
+      fprintf(stderr, "Error: could not open %s\n", hashes);
+      goto done;
+    }
+  }
+
+  struct timespec begin;
+  clock_gettime(CLOCK_MONOTONIC, &begin);
+  size_t desync;
+  int error = m6502_play_movie(&movie, processor, &desync);
+  double seconds = elapsed(&begin);
+  if (error != SUCCESS) {
+    printf("stopped in frame %zu, %s\n", desync, m6502_strerror(error));
+  } else if (desync < movie.count) {
+    printf("desync in frame %zu\n", desync);
+  }
+  printf("played %zu frames in %.3fs, %.0f frames/s\n", movie.count, seconds,
+         seconds > 0 ? movie.count / seconds : 0);
+  status = error == SUCCESS && desync == movie.count ? 0 : 2;
+
+done:
+  m6502_destroy(processor);
+  if (log != NULL && log != stdout) {
+    fclose(log);
+  }
+  m6502_free_movie(&movie);
+  return status;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc >= 2 && strcmp(argv[1], "record") == 0) {
+    return record(argc, argv);
+  }
+  if (argc >= 2 && strcmp(argv[1], "play") == 0) {
+    return play(argc, argv);
+  }
+  print_help(argv[0]);
+  return 1;
+}
@@ -0,0 +1,179 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../headers/hash.h"
+#include "../headers/persist.h"
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define NO_FRAME UINT64_MAX
+
+typedef struct {
+  uint64_t checksum; /* hash_lanes of `state` */
+  uint64_t reserved;
+  m6502_snapshot_t state;
+} slot_t;
+
+/* the file, in the byte order of the host that wrote it */
+typedef struct {
+  char magic[4];
+  uint32_t version;
+  uint32_t snapshot_size; /* files of builds with another layout are ignored */
+  uint32_t reserved;
+  uint64_t rom_hash;
+  /* frame << 1 | slot of the last complete frame, NO_FRAME before the
+   * first one */
+  _Atomic uint64_t marker;
+  slot_t slots[2];
+} persist_file_t;
+
+struct _persist {
+  int fd;
+  persist_file_t *file;
+};
+
+static uint64_t rom_hash(const processor_t *processor) {
+  return hash_bytes(processor->memory + PRG_ROM_START, processor->rom_size, 0);
+}
+
+static bool same_layout(const persist_file_t *file,
+                        const processor_t *processor) {
+  return memcmp(file->magic, PERSIST_MAGIC, sizeof(file->magic)) == 0 &&
+         file->version == PERSIST_VERSION &&
+         file->snapshot_size == sizeof(m6502_snapshot_t) &&
+         file->rom_hash == rom_hash(processor);
+}
+
+static bool slot_intact(const slot_t *slot) {
+  return slot->checksum == hash_lanes(&slot->state, sizeof(slot->state), 0);
+}
+
+extern void persist_frame(persist_t *persist, const processor_t *processor) {
+  persist_file_t *file = persist->file;
+  uint64_t marker = atomic_load_explicit(&file->marker, memory_order_relaxed);
+  unsigned slot = marker == NO_FRAME ? 0 : (unsigned)(~marker & 1);
+
+  m6502_save_snapshot(processor, &file->slots[slot].state);
+  file->slots[slot].checksum =
+      hash_lanes(&file->slots[slot].state, sizeof(m6502_snapshot_t), 0);
+  atomic_store_explicit(&file->marker, processor->frame << 1 | slot,
+                        memory_order_release);
+}
+
+extern void close_persist(persist_t *persist) {
+  if (persist == NULL) {
+    return;
+  }
+  msync(persist->file, sizeof(persist_file_t), MS_SYNC);
+  munmap(persist->file, sizeof(persist_file_t));
+  close(persist->fd);
+  free(persist);
+}
+
+extern bool m6502_persist(processor_t *processor, const char *path) {
+  persist_t *persist = calloc(1, sizeof(persist_t));
+  if (persist == NULL) {
+    return false;
+  }
+  persist->fd = open(path, O_RDWR | O_CREAT, 0644);
+  struct stat st;
+  if (persist->fd == -1 || fstat(persist->fd, &st) == -1 ||
+      ((size_t)st.st_size < sizeof(persist_file_t) &&
+       ftruncate(persist->fd, sizeof(persist_file_t)) == -1)) {
+    fprintf(stderr, "Error: could not open %s: %s\n", path, strerror(errno));
+    goto fail;
+  }
+  persist->file = mmap(NULL, sizeof(persist_file_t), PROT_READ | PROT_WRITE,
+                       MAP_SHARED, persist->fd, 0);
+  if (persist->file == MAP_FAILED) {
+    fprintf(stderr, "Error: could not map %s: %s\n", path, strerror(errno));
+    goto fail;
+  }
+
+  persist_file_t *file = persist->file;
+  if (!same_layout(file, processor)) {
+    memcpy(file->magic, PERSIST_MAGIC, sizeof(file->magic));
+    file->version = PERSIST_VERSION;
+    file->snapshot_size = sizeof(m6502_snapshot_t);
+    file->reserved = 0;
+    file->rom_hash = rom_hash(processor);
+    atomic_store_explicit(&file->marker, NO_FRAME, memory_order_relaxed);
+  }
+  persist_frame(persist, processor);
+
+  close_persist(processor->persist);
+  processor->persist = persist;
+  return true;
+
+fail:
+  if (persist->fd != -1) {
+    close(persist->fd);
+  }
+  free(persist);
+  return false;
+}
+
+extern bool m6502_resume(processor_t *processor, const char *path) {
+  int fd = open(path, O_RDONLY);
+  if (fd == -1) {
+    return false;
+  }
+  struct stat st;
+  const persist_file_t *file = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(persist_file_t)) {
+    file = mmap(NULL, sizeof(persist_file_t), PROT_READ, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (file == MAP_FAILED) {
+    return false;
+  }
+
+  bool ok = false;
+  uint64_t marker = atomic_load_explicit(&file->marker, memory_order_acquire);
+  if (same_layout(file, processor) && marker != NO_FRAME) {
+    /* the newer slot first, the older one if the newer didn't make it to
+     * the disk whole */
+    const slot_t *newer = &file->slots[marker & 1];
+    const slot_t *older = &file->slots[~marker & 1];
+    const slot_t *slot = slot_intact(newer)   ? newer
+                         : slot_intact(older) ? older
+                                              : NULL;
+    if (slot != NULL) {
+      m6502_load_snapshot(processor, &slot->state);
+      ok = true;
+    }
+  }
+  munmap((void *)file, sizeof(persist_file_t));
+  return ok;
+}
+
+#else
+/* no shared file mappings, persisting always fails */
+extern void persist_frame(persist_t *persist, const processor_t *processor) {
+  (void)persist;
+  (void)processor;
+}
+
+extern void close_persist(persist_t *persist) { (void)persist; }
+
+extern bool m6502_persist(processor_t *processor, const char *path) {
+  (void)processor;
+  (void)path;
+  fprintf(stderr, "Warning: persisting is not supported on this platform\n");
+  return false;
+}
+
+extern bool m6502_resume(processor_t *processor, const char *path) {
+  (void)processor;
+  (void)path;
+  return false;
+}
+#endif
@@ -0,0 +1,258 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../headers/pool.h"
+
+#define CACHE_LINE 64
+/* how long a thread busy waits for the next pool_run (or for the workers to
+ * finish one) before it goes to sleep, roughly tens of microseconds, back to
+ * back runs never pay for a futex wake up */
+#define SPIN_LIMIT (1 << 14)
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define cpu_relax() _mm_pause()
+#else
+#define cpu_relax()
+#endif
+
+/* the indices a worker has left, packed as begin | end << 32 so the owner
+ * taking from the front and a thief taking from the back race on a single
+ * compare and swap, one per cache line so owners don't false share */
+typedef struct {
+  _Alignas(CACHE_LINE) _Atomic uint64_t range;
+} queue_t;
+
+typedef struct {
+  struct _pool *pool;
+  unsigned id;
+  bool pin;
+} worker_t;
+
+struct _pool {
+  unsigned size;
+  pthread_t *threads;
+  worker_t *workers;
+  queue_t *queues;
+
+  /* the lock and conditions are only used once spinning gave up */
+  pthread_mutex_t lock;
+  pthread_cond_t start;
+  pthread_cond_t done;
+  _Atomic unsigned long generation; /* bumped for every pool_run */
+  _Atomic unsigned active; /* threads still working on this generation */
+  _Atomic bool stopping;
+
+  pool_task task;
+  void *context;
+};
+
+static inline uint64_t pack(uint32_t begin, uint32_t end) {
+  return begin | (uint64_t)end << 32;
+}
+
+static bool take_front(queue_t *queue, size_t *index) {
+  uint64_t range = atomic_load_explicit(&queue->range, memory_order_relaxed);
+  for (;;) {
+    uint32_t begin = (uint32_t)range, end = range >> 32;
+    if (begin >= end) {
+      return false;
+    }
+    if (atomic_compare_exchange_weak(&queue->range, &range,
+                                     pack(begin + 1, end))) {
+      *index = begin;
+      return true;
+    }
+  }
+}
+
+static bool steal_back(queue_t *queue, size_t *index) {
+  uint64_t range = atomic_load_explicit(&queue->range, memory_order_relaxed);
+  for (;;) {
+    uint32_t begin = (uint32_t)range, end = range >> 32;
+    if (begin >= end) {
+      return false;
+    }
+    if (atomic_compare_exchange_weak(&queue->range, &range,
+                                     pack(begin, end - 1))) {
+      *index = end - 1;
+      return true;
+    }
+  }
+}
+
+/* ranges only ever shrink, so once a pass over every queue comes up empty
+ * there is nothing left to do */
+static void work(struct _pool *pool, unsigned self) {
+  size_t index;
+  for (;;) {
+    bool found = take_front(&pool->queues[self], &index);
+    for (unsigned i = 1; i < pool->size && !found; i++) {
+      found = steal_back(&pool->queues[(self + i) % pool->size], &index);
+    }
+    if (!found) {
+      return;
+    }
+    pool->task(pool->context, index, self);
+  }
+}
+
+static void pin_to_core(unsigned id) {
+#ifdef __linux__
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  if (cores <= 0) {
+    return;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(id % cores, &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+  (void)id;
+#endif
+}
+
+static void *worker_loop(void *arg) {
+  worker_t *worker = arg;
+  struct _pool *pool = worker->pool;
+  if (worker->pin) {
+    pin_to_core(worker->id);
+  }
+
+  unsigned long seen = 0;
+  for (;;) {
+    for (unsigned spin = 0; spin < SPIN_LIMIT && !pool->stopping &&
+                            pool->generation == seen;
+         spin++) {
+      cpu_relax();
+    }
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->stopping && pool->generation == seen) {
+      pthread_cond_wait(&pool->start, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    if (pool->stopping) {
+      return NULL;
+    }
+    seen = pool->generation;
+
+    work(pool, worker->id);
+
+    if (atomic_fetch_sub(&pool->active, 1) == 1) {
+      pthread_mutex_lock(&pool->lock);
+      pthread_cond_signal(&pool->done);
+      pthread_mutex_unlock(&pool->lock);
+    }
+  }
+}
+
+extern pool_t *pool_create(unsigned workers, bool pin) {
+  if (workers == 0) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    workers = cores > 0 ? (unsigned)cores : 1;
+  }
+
+  pool_t *pool = calloc(1, sizeof(pool_t));
+  if (pool == NULL) {
+    return NULL;
+  }
+  pool->size = workers;
+  pool->threads = calloc(workers, sizeof(pthread_t));
+  pool->workers = calloc(workers, sizeof(worker_t));
+  pool->queues = aligned_alloc(CACHE_LINE, workers * sizeof(queue_t));
+  if (pool->threads == NULL || pool->workers == NULL || pool->queues == NULL) {
+    goto fail;
+  }
+  for (unsigned i = 0; i < workers; i++) {
+    atomic_init(&pool->queues[i].range, 0);
+  }
+  atomic_init(&pool->generation, 0);
+  atomic_init(&pool->active, 0);
+  atomic_init(&pool->stopping, false);
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->start, NULL);
+  pthread_cond_init(&pool->done, NULL);
+
+  /* worker 0 is whoever calls pool_run, it is left unpinned */
+  for (unsigned i = 1; i < workers; i++) {
+    pool->workers[i] = (worker_t){pool, i, pin};
+    if (pthread_create(&pool->threads[i], NULL, &worker_loop,
+                       &pool->workers[i]) != 0) {
+      pool->size = i; /* only join the ones that started */
+      pool_destroy(pool);
+      return NULL;
+    }
+  }
+  return pool;
+
+fail:
+  free(pool->threads);
+  free(pool->workers);
+  free(pool->queues);
+  free(pool);
+  return NULL;
+}
+
+extern unsigned pool_size(const pool_t *pool) { return pool->size; }
+
+extern void pool_run(pool_t *pool, size_t count, pool_task task,
+                     void *context) {
+  if (count == 0) {
+    return;
+  }
+
+  size_t share = count / pool->size, extra = count % pool->size;
+  size_t begin = 0;
+  for (unsigned i = 0; i < pool->size; i++) {
+    size_t end = begin + share + (i < extra);
+    atomic_store_explicit(&pool->queues[i].range, pack(begin, end),
+                          memory_order_relaxed);
+    begin = end;
+  }
+
+  pool->task = task;
+  pool->context = context;
+  pool->active = pool->size - 1;
+  /* bumped under the lock so a worker about to sleep can't miss it */
+  pthread_mutex_lock(&pool->lock);
+  pool->generation++;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+
+  work(pool, 0);
+
+  /* this is the barrier, nothing returns before every worker is done */
+  for (unsigned spin = 0; spin < SPIN_LIMIT && pool->active != 0; spin++) {
+    cpu_relax();
+  }
+  pthread_mutex_lock(&pool->lock);
+  while (pool->active != 0) {
+    pthread_cond_wait(&pool->done, &pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+}
+
+extern void pool_destroy(pool_t *pool) {
+  if (pool == NULL) {
+    return;
+  }
+  pthread_mutex_lock(&pool->lock);
+  pool->stopping = true;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+  for (unsigned i = 1; i < pool->size; i++) {
+    pthread_join(pool->threads[i], NULL);
+  }
+
+  pthread_cond_destroy(&pool->done);
+  pthread_cond_destroy(&pool->start);
+  pthread_mutex_destroy(&pool->lock);
+  free(pool->threads);
+  free(pool->workers);
+  free(pool->queues);
+  free(pool);
+}
@@ -0,0 +1,63 @@
+#include <stdio.h>
+
+#include "../headers/profile.h"
+
+#define PROFILE_VERSION 1
+
+static bool write_rows(FILE *fp, const char *kind, const uint64_t *reads,
+                       const uint64_t *writes, const uint64_t *executes,
+                       size_t count, unsigned shift) {
+  for (size_t i = 0; i < count; i++) {
+    if (fprintf(fp, "%s,$%04zX,%llu,%llu,%llu\n", kind, i << shift,
+                (unsigned long long)reads[i], (unsigned long long)writes[i],
+                (unsigned long long)executes[i]) < 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool write_counters(FILE *fp, const uint64_t *counters, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    uint8_t bytes[8];
+    for (int b = 0; b < 8; b++) {
+      bytes[b] = (counters[i] >> (b * 8)) & 0xff;
+    }
+    if (fwrite(bytes, 1, sizeof(bytes), fp) != sizeof(bytes)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+extern bool write_profile_csv(const access_profile_t *profile, FILE *fp) {
+  if (fprintf(fp, "kind,address,reads,writes,executes\n") < 0) {
+    return false;
+  }
+  bool ok = write_rows(fp, "page", profile->reads, profile->writes,
+                       profile->executes, PROFILE_PAGES, 8);
+#ifdef M6502_PROFILE_BYTES
+  ok = ok && write_rows(fp, "byte", profile->byte_reads, profile->byte_writes,
+                        profile->byte_executes, PROFILE_BYTES, 0);
+#endif
+  return ok;
+}
+
+extern bool write_profile_binary(const access_profile_t *profile, FILE *fp) {
+#ifdef M6502_PROFILE_BYTES
+  const uint8_t bytes = 1;
+#else
+  const uint8_t bytes = 0;
+#endif
+  const uint8_t header[8] = {'M', '6', 'H', 'P', PROFILE_VERSION, bytes, 0, 0};
+  bool ok = fwrite(header, 1, sizeof(header), fp) == sizeof(header);
+  ok = ok && write_counters(fp, profile->reads, PROFILE_PAGES);
+  ok = ok && write_counters(fp, profile->writes, PROFILE_PAGES);
+  ok = ok && write_counters(fp, profile->executes, PROFILE_PAGES);
+#ifdef M6502_PROFILE_BYTES
+  ok = ok && write_counters(fp, profile->byte_reads, PROFILE_BYTES);
+  ok = ok && write_counters(fp, profile->byte_writes, PROFILE_BYTES);
+  ok = ok && write_counters(fp, profile->byte_executes, PROFILE_BYTES);
+#endif
+  return ok;
+}
@@ -0,0 +1,185 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../headers/delta.h"
+#include "../headers/rewind.h"
+
+/* a record is the state xored with the one before it, see delta.h.
+ * Keyframes are the same against an all zero state */
+
+#define WORDS (sizeof(m6502_snapshot_t) / sizeof(uint64_t))
+#define DEFAULT_KEYFRAME_INTERVAL 60
+
+_Static_assert(sizeof(m6502_snapshot_t) % sizeof(uint64_t) == 0,
+               "snapshots are xored word by word");
+
+typedef struct {
+  size_t offset; /* in the ring */
+  size_t size;
+  bool keyframe;
+} record_t;
+
+struct _m6502_rewind {
+  /* records are never split, one that doesn't fit before the end of the
+   * ring starts over at its beginning */
+  uint8_t *ring;
+  size_t capacity;
+  size_t tail; /* where the newest record ends */
+
+  record_t *records; /* circular, oldest at first */
+  size_t first;
+  size_t count;
+  size_t record_capacity;
+
+  unsigned keyframe_interval;
+  unsigned since_keyframe; /* records since the newest keyframe, itself
+                              included */
+  uint64_t current[WORDS]; /* the newest state */
+  uint8_t scratch[DELTA_BOUND(WORDS)];
+};
+
+static record_t *record(const m6502_rewind_t *rewind, size_t index) {
+  return &rewind->records[(rewind->first + index) % rewind->record_capacity];
+}
+
+/* finds room for `size` bytes after the newest record */
+static bool find_room(m6502_rewind_t *rewind, size_t size, size_t *offset) {
+  if (rewind->count == 0) {
+    *offset = 0;
+    return rewind->capacity >= size;
+  }
+  size_t head = record(rewind, 0)->offset;
+  if (rewind->tail > head) {
+    if (rewind->capacity - rewind->tail >= size) {
+      *offset = rewind->tail;
+      return true;
+    }
+    *offset = 0;
+    return head >= size;
+  }
+  *offset = rewind->tail;
+  return head - rewind->tail >= size;
+}
+
+/* drops the oldest keyframe and the records that depend on it */
+static void drop_oldest(m6502_rewind_t *rewind) {
+  do {
+    rewind->first = (rewind->first + 1) % rewind->record_capacity;
+    rewind->count--;
+  } while (rewind->count > 0 && !record(rewind, 0)->keyframe);
+}
+
+static bool grow_records(m6502_rewind_t *rewind) {
+  size_t capacity = rewind->record_capacity * 2;
+  record_t *records = malloc(capacity * sizeof(record_t));
+  if (records == NULL) {
+    return false;
+  }
+  for (size_t i = 0; i < rewind->count; i++) {
+    records[i] = *record(rewind, i);
+  }
+  free(rewind->records);
+  rewind->records = records;
+  rewind->record_capacity = capacity;
+  rewind->first = 0;
+  return true;
+}
+
+extern m6502_rewind_t *m6502_rewind_create(size_t memory,
+                                           unsigned keyframe_interval) {
+  m6502_rewind_t *rewind = calloc(1, sizeof(m6502_rewind_t));
+  if (rewind == NULL) {
+    return NULL;
+  }
+  rewind->capacity = memory;
+  rewind->ring = malloc(memory ? memory : 1);
+  rewind->record_capacity = 1024;
+  rewind->records = malloc(rewind->record_capacity * sizeof(record_t));
+  rewind->keyframe_interval =
+      keyframe_interval ? keyframe_interval : DEFAULT_KEYFRAME_INTERVAL;
+  if (rewind->ring == NULL || rewind->records == NULL) {
+    m6502_rewind_destroy(rewind);
+    return NULL;
+  }
+  return rewind;
+}
+
+extern void m6502_rewind_destroy(m6502_rewind_t *rewind) {
+  if (rewind == NULL) {
+    return;
+  }
+  free(rewind->ring);
+  free(rewind->records);
+  free(rewind);
+}
+
+extern bool m6502_rewind_push(m6502_rewind_t *rewind,
+                              const m6502_snapshot_t *snapshot) {
+  uint64_t state[WORDS];
+  memcpy(state, snapshot, sizeof(state));
+  bool keyframe = rewind->count == 0 ||
+                  rewind->since_keyframe >= rewind->keyframe_interval;
+  size_t size = delta_encode(state, keyframe ? NULL : rewind->current,
+                           WORDS, rewind->scratch);
+  if (rewind->count == rewind->record_capacity && !grow_records(rewind)) {
+    return false;
+  }
+
+  size_t offset;
+  while (!find_room(rewind, size, &offset)) {
+    if (rewind->count == 0) {
+      return false;
+    }
+    drop_oldest(rewind);
+    if (rewind->count == 0 && !keyframe) {
+      /* nothing left to be a delta against */
+      keyframe = true;
+      size = delta_encode(state, NULL, WORDS, rewind->scratch);
+    }
+  }
+
+  memcpy(rewind->ring + offset, rewind->scratch, size);
+  *record(rewind, rewind->count++) = (record_t){offset, size, keyframe};
+  rewind->tail = offset + size;
+  rewind->since_keyframe = keyframe ? 1 : rewind->since_keyframe + 1;
+  memcpy(rewind->current, state, sizeof(state));
+  return true;
+}
+
+extern bool m6502_rewind_step_back(m6502_rewind_t *rewind,
+                                   m6502_snapshot_t *snapshot) {
+  if (rewind->count < 2) {
+    return false;
+  }
+  const record_t *newest = record(rewind, rewind->count - 1);
+  if (!newest->keyframe) {
+    delta_apply(rewind->current, WORDS, rewind->ring + newest->offset,
+                newest->size);
+  } else {
+    /* the keyframe can't be undone, rebuild from the one before it */
+    size_t keyframe = rewind->count - 2;
+    while (!record(rewind, keyframe)->keyframe) {
+      keyframe--;
+    }
+    memset(rewind->current, 0, sizeof(rewind->current));
+    for (size_t i = keyframe; i < rewind->count - 1; i++) {
+      delta_apply(rewind->current, WORDS,
+                  rewind->ring + record(rewind, i)->offset,
+                  record(rewind, i)->size);
+    }
+  }
+  rewind->count--;
+
+  const record_t *last = record(rewind, rewind->count - 1);
+  rewind->tail = last->offset + last->size;
+  rewind->since_keyframe = 1;
+  for (size_t i = rewind->count - 1; !record(rewind, i)->keyframe; i--) {
+    rewind->since_keyframe++;
+  }
+  memcpy(snapshot, rewind->current, sizeof(rewind->current));
+  return true;
+}
+
+extern size_t m6502_rewind_count(const m6502_rewind_t *rewind) {
+  return rewind->count;
+}
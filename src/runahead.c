@@ -0,0 +1,52 @@
+#include "../headers/framehash.h"
+#include "../headers/persist.h"
+#include "../headers/runahead.h"
+#include "../headers/shared.h"
+
+extern int m6502_run_ahead(processor_t *processor, unsigned frames,
+                           m6502_snapshot_t *ahead) {
+  /* the real frame is published once it is known which frame to show */
+  shared_export_t *shared = processor->shared;
+  processor->shared = NULL;
+  int error = m6502_run_frames(processor, 1);
+  if (error != SUCCESS || frames == 0) {
+    processor->shared = shared;
+    if (shared != NULL) {
+      publish_shared(shared, processor);
+    }
+    if (ahead != NULL) {
+      m6502_save_snapshot(processor, ahead);
+    }
+    return error;
+  }
+
+  m6502_snapshot_t real;
+  m6502_save_snapshot(processor, &real);
+  FILE *log = processor->log;
+  frame_hasher_t *hasher = processor->hasher;
+  persist_t *persist = processor->persist;
+  size_t watchpoint_count = processor->watchpoint_count;
+  watch_hit_t watch_hit = processor->watch_hit;
+  processor->log = NULL;
+  processor->hasher = NULL;
+  processor->persist = NULL;
+  processor->watchpoint_count = 0;
+
+  /* a speculative frame that fails just ends the look ahead early */
+  m6502_run_frames(processor, frames);
+  if (shared != NULL) {
+    publish_shared(shared, processor);
+  }
+  if (ahead != NULL) {
+    m6502_save_snapshot(processor, ahead);
+  }
+
+  m6502_load_snapshot(processor, &real);
+  processor->log = log;
+  processor->hasher = hasher;
+  processor->persist = persist;
+  processor->watchpoint_count = watchpoint_count;
+  processor->watch_hit = watch_hit;
+  processor->shared = shared;
+  return error;
+}
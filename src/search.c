@@ -0,0 +1,267 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../headers/hash.h"
+#include "../headers/pool.h"
+#include "../headers/search.h"
+#include "../headers/snapshot.h"
+
+#define NO_PARENT SIZE_MAX
+
+/* how every kept state was reached, the path is rebuilt from here */
+typedef struct {
+  size_t parent;
+  uint8_t input;
+} step_t;
+
+typedef struct {
+  m6502_snapshot_t snapshot;
+  uint64_t hash;
+  uint32_t score;
+  size_t step; /* step_t that reached it, for children the parent's */
+  size_t order; /* when it was found, keeps the beam sort stable */
+  bool alive;  /* the cpu didn't stop */
+  bool goal;
+} node_t;
+
+/* open addressing set of state hashes, 0 marks a free slot */
+typedef struct {
+  uint64_t *slots;
+  size_t capacity; /* power of 2 */
+  size_t size;
+} visited_t;
+
+typedef struct {
+  const m6502_search_config_t *config;
+  processor_t **instances; /* one per pool worker */
+  node_t *frontier;
+  node_t *children;
+} search_t;
+
+static bool visit(visited_t *visited, uint64_t hash) {
+  hash = hash != 0 ? hash : 1;
+  if ((visited->size + 1) * 2 > visited->capacity) {
+    size_t capacity = visited->capacity ? visited->capacity * 2 : 1024;
+    uint64_t *slots = calloc(capacity, sizeof(uint64_t));
+    if (slots == NULL) {
+      return true; /* can't grow, treat it as new rather than losing it */
+    }
+    for (size_t i = 0; i < visited->capacity; i++) {
+      uint64_t old = visited->slots[i];
+      if (old == 0) {
+        continue;
+      }
+      size_t slot = old & (capacity - 1);
+      while (slots[slot] != 0) {
+        slot = (slot + 1) & (capacity - 1);
+      }
+      slots[slot] = old;
+    }
+    free(visited->slots);
+    visited->slots = slots;
+    visited->capacity = capacity;
+  }
+
+  size_t slot = hash & (visited->capacity - 1);
+  while (visited->slots[slot] != 0) {
+    if (visited->slots[slot] == hash) {
+      return false;
+    }
+    slot = (slot + 1) & (visited->capacity - 1);
+  }
+  visited->slots[slot] = hash;
+  visited->size++;
+  return true;
+}
+
+/* states only count as the same if they also stand at the same point of
+ * their frame and on the same clock parity (oam dma takes a cycle more on
+ * odd ones), otherwise they go on to differ */
+static uint64_t state_key(const m6502_snapshot_t *snapshot) {
+  uint64_t timing[2] = {snapshot->frame_end - snapshot->clock_ticks,
+                        snapshot->clock_ticks & 1};
+  return hash_bytes(timing, sizeof(timing), m6502_snapshot_hash(snapshot));
+}
+
+static bool goal_reached(const m6502_search_config_t *config,
+                         const processor_t *processor) {
+  for (size_t i = 0; i < config->goal_count; i++) {
+    const m6502_condition_t *condition = &config->goal[i];
+    if ((m6502_peek(processor, condition->address) & condition->mask) !=
+        condition->value) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static uint32_t read_score(const m6502_search_config_t *config,
+                           const processor_t *processor) {
+  uint32_t score = 0;
+  for (uint8_t i = 0; i < config->score_bytes && i < 4; i++) {
+    score |= (uint32_t)m6502_peek(processor, config->score_address + i)
+             << (i * 8);
+  }
+  return score;
+}
+
+static void expand(void *context, size_t index, unsigned worker) {
+  search_t *search = context;
+  const m6502_search_config_t *config = search->config;
+  const node_t *parent = &search->frontier[index / config->alphabet_size];
+  node_t *child = &search->children[index];
+  processor_t *processor = search->instances[worker];
+
+  m6502_load_snapshot(processor, &parent->snapshot);
+  m6502_set_controller(processor,
+                       config->alphabet[index % config->alphabet_size]);
+  child->alive =
+      m6502_run_frames(processor, config->frames_per_step) == SUCCESS;
+  m6502_save_snapshot(processor, &child->snapshot);
+  child->hash = state_key(&child->snapshot);
+  child->score = read_score(config, processor);
+  child->goal = goal_reached(config, processor);
+  child->step = parent->step;
+}
+
+/* best score first, ties in the order they were found */
+static int compare_nodes(const void *a, const void *b) {
+  const node_t *left = a, *right = b;
+  if (left->score != right->score) {
+    return left->score < right->score ? 1 : -1;
+  }
+  return left->order < right->order ? -1 : left->order > right->order;
+}
+
+static bool build_path(const step_t *steps, size_t last,
+                       m6502_search_result_t *result) {
+  size_t length = 0;
+  for (size_t step = last; step != NO_PARENT; step = steps[step].parent) {
+    length++;
+  }
+  result->inputs = malloc(length ? length : 1);
+  if (result->inputs == NULL) {
+    return false;
+  }
+  result->length = length;
+  for (size_t step = last; step != NO_PARENT; step = steps[step].parent) {
+    result->inputs[--length] = steps[step].input;
+  }
+  return true;
+}
+
+extern bool m6502_search(const processor_t *start,
+                         const m6502_search_config_t *config,
+                         m6502_search_result_t *result) {
+  memset(result, 0, sizeof(*result));
+  if (config->alphabet_size == 0) {
+    return false;
+  }
+
+  bool ok = false;
+  search_t search = {config, NULL, NULL, NULL};
+  visited_t visited = {NULL, 0, 0};
+  step_t *steps = NULL;
+  size_t step_count = 0, step_capacity = 0;
+  size_t frontier_size = 1;
+
+  pool_t *pool = pool_create(config->workers, true);
+  if (pool == NULL) {
+    return false;
+  }
+  search.instances = calloc(pool_size(pool), sizeof(processor_t *));
+  search.frontier = malloc(sizeof(node_t));
+  if (search.instances == NULL || search.frontier == NULL) {
+    goto done;
+  }
+  for (unsigned i = 0; i < pool_size(pool); i++) {
+    search.instances[i] = m6502_clone(start);
+    if (search.instances[i] == NULL) {
+      goto done;
+    }
+    /* a watchpoint would stop a step half way */
+    while (search.instances[i]->watchpoint_count > 0) {
+      m6502_remove_watchpoint(search.instances[i],
+                              search.instances[i]->watchpoints[0].address);
+    }
+  }
+
+  m6502_save_snapshot(start, &search.frontier[0].snapshot);
+  search.frontier[0].step = NO_PARENT;
+  visit(&visited, state_key(&search.frontier[0].snapshot));
+  if (goal_reached(config, start)) {
+    result->found = true;
+    ok = build_path(steps, NO_PARENT, result);
+    goto done;
+  }
+
+  for (unsigned depth = 0; depth < config->max_depth && frontier_size > 0;
+       depth++) {
+    size_t count = frontier_size * config->alphabet_size;
+    node_t *children = realloc(search.children, count * sizeof(node_t));
+    if (children == NULL) {
+      goto done;
+    }
+    search.children = children;
+    pool_run(pool, count, &expand, &search);
+    result->expanded += count;
+
+    /* serial from here on so the result doesn't depend on the scheduling */
+    if (step_count + count > step_capacity) {
+      step_capacity = (step_count + count) * 2;
+      step_t *grown = realloc(steps, step_capacity * sizeof(step_t));
+      if (grown == NULL) {
+        goto done;
+      }
+      steps = grown;
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+      node_t *child = &children[i];
+      if (!child->alive) {
+        continue;
+      }
+      if (!visit(&visited, child->hash)) {
+        result->duplicates++;
+        continue;
+      }
+      steps[step_count] = (step_t){
+          child->step, config->alphabet[i % config->alphabet_size]};
+      child->step = step_count++;
+      child->order = kept;
+      if (child->goal) {
+        result->found = true;
+        ok = build_path(steps, child->step, result);
+        goto done;
+      }
+      if (kept != i) {
+        children[kept] = *child;
+      }
+      kept++;
+    }
+
+    if (config->beam_width != 0 && kept > config->beam_width) {
+      qsort(children, kept, sizeof(node_t), &compare_nodes);
+      kept = config->beam_width;
+    }
+    /* the kept children are the next frontier, the old frontier's memory
+     * gets reused for their children */
+    search.children = search.frontier;
+    search.frontier = children;
+    frontier_size = kept;
+  }
+  ok = true;
+
+done:
+  for (unsigned i = 0; search.instances != NULL && i < pool_size(pool); i++) {
+    m6502_destroy(search.instances[i]);
+  }
+  pool_destroy(pool);
+  free(search.instances);
+  free(search.frontier);
+  free(search.children);
+  free(visited.slots);
+  free(steps);
+  return ok;
+}
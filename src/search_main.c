@@ -0,0 +1,156 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../headers/cpu.h"
+#include "../headers/search.h"
+
+/* command line front end of m6502_search, finds the shortest input sequence
+ * from the power on state (or a few frames after it) to a ram condition */
+
+#define MAX_ALPHABET 256
+#define MAX_GOAL 64
+
+static void print_help(const char *name) {
+  fprintf(stderr,
+          "usage: %s [-j workers] [-w beam] [-d depth] [-f frames] "
+          "[-a inputs] [-s $addr[:bytes]] [-r frames] rom goal...\n",
+          name);
+  fprintf(stderr, "  -w  states kept per step, 0 for breadth first\n");
+  fprintf(stderr, "  -d  most steps to try, defaults to 60\n");
+  fprintf(stderr, "  -f  frames every input is held, defaults to 1\n");
+  fprintf(stderr, "  -a  comma separated controller bytes to try (hex),\n"
+                  "      defaults to nothing and every single button\n");
+  fprintf(stderr, "  -s  little endian counter to rank states by\n");
+  fprintf(stderr, "  -r  frames to run without input before searching\n");
+  fprintf(stderr, "  goal  $addr=value or $addr&mask=value (hex), all of "
+                  "them have to hold\n");
+}
+
+static size_t parse_alphabet(char *list, uint8_t *alphabet) {
+  size_t size = 0;
+  char *save = NULL;
+  for (char *token = strtok_r(list, ",", &save);
+       token != NULL && size < MAX_ALPHABET;
+       token = strtok_r(NULL, ",", &save)) {
+    alphabet[size++] = (uint8_t)strtoul(token, NULL, 16);
+  }
+  return size;
+}
+
+static bool parse_condition(const char *token, m6502_condition_t *condition) {
+  unsigned address, mask = 0xff, value;
+  int consumed = 0;
+  if (sscanf(token, "$%x&%x=%x%n", &address, &mask, &value, &consumed) != 3 &&
+      sscanf(token, "$%x=%x%n", &address, &value, &consumed) != 2) {
+    return false;
+  }
+  if (token[consumed] != '\0') {
+    return false;
+  }
+  condition->address = address & 0xffff;
+  condition->mask = mask & 0xff;
+  condition->value = value & mask & 0xff;
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  uint8_t alphabet[MAX_ALPHABET] = {0x00, BUTTON_A,     BUTTON_B,
+                                    BUTTON_SELECT, BUTTON_START, BUTTON_UP,
+                                    BUTTON_DOWN,   BUTTON_LEFT,  BUTTON_RIGHT};
+  m6502_condition_t goal[MAX_GOAL];
+  m6502_search_config_t config = {
+      .alphabet = alphabet,
+      .alphabet_size = 9,
+      .frames_per_step = 1,
+      .max_depth = 60,
+      .goal = goal,
+  };
+  unsigned warmup = 0;
+
+  int option;
+  while ((option = getopt(argc, argv, "j:w:d:f:a:s:r:h")) != -1) {
+    switch (option) {
+    case 'j':
+      config.workers = (unsigned)strtoul(optarg, NULL, 10);
+      break;
+    case 'w':
+      config.beam_width = strtoul(optarg, NULL, 10);
+      break;
+    case 'd':
+      config.max_depth = (unsigned)strtoul(optarg, NULL, 10);
+      break;
+    case 'f':
+      config.frames_per_step = (unsigned)strtoul(optarg, NULL, 10);
+      break;
+    case 'a':
+      config.alphabet_size = parse_alphabet(optarg, alphabet);
+      break;
+    case 's': {
+      unsigned address, bytes = 1;
+      if (sscanf(optarg, "$%x:%u", &address, &bytes) < 1) {
+        print_help(argv[0]);
+        return 1;
+      }
+      config.score_address = address & 0xffff;
+      config.score_bytes = bytes > 4 ? 4 : (uint8_t)bytes;
+      break;
+    }
+    case 'r':
+      warmup = (unsigned)strtoul(optarg, NULL, 10);
+      break;
+    default:
+      print_help(argv[0]);
+      return 1;
+    }
+  }
+  if (optind + 1 >= argc) {
+    print_help(argv[0]);
+    return 1;
+  }
+  for (int i = optind + 1; i < argc && config.goal_count < MAX_GOAL; i++) {
+    if (!parse_condition(argv[i], &goal[config.goal_count++])) {
+      fprintf(stderr, "Error: invalid goal %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  processor_t *processor = m6502_create_headless(argv[optind]);
+  if (processor == NULL) {
+    fprintf(stderr, "Error: could not load %s\n", argv[optind]);
+    return 1;
+  }
+  m6502_run_frames(processor, warmup);
+
+  struct timespec begin, end;
+  clock_gettime(CLOCK_MONOTONIC, &begin);
+  m6502_search_result_t result;
+  bool ok = m6502_search(processor, &config, &result);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  m6502_destroy(processor);
+  if (!ok) {
+    fprintf(stderr, "Error: search failed\n");
+    return 1;
+  }
+
+  double seconds =
+      (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+  if (result.found) {
+    printf("found %zu steps (%zu frames):", result.length,
+           result.length * config.frames_per_step);
+    for (size_t i = 0; i < result.length; i++) {
+      printf(" %02X", result.inputs[i]);
+    }
+    putchar('\n');
+  } else {
+    printf("not found\n");
+  }
+  printf("expanded %llu states (%llu duplicates) in %.3fs, %.0f states/s\n",
+         result.expanded, result.duplicates, seconds,
+         seconds > 0 ? result.expanded / seconds : 0.0);
+  free(result.inputs);
+  return result.found ? 0 : 2;
+}
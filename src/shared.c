@@ -0,0 +1,173 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../headers/shared.h"
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct _shared_export {
+  int fd;
+  char *name; /* NULL for memfds */
+  m6502_shared_t *region;
+};
+
+static int create_region(const char *name) {
+#ifdef __linux__
+  if (name == NULL) {
+    return memfd_create("m6502", MFD_CLOEXEC);
+  }
+#endif
+  if (name == NULL) {
+    errno = EINVAL;
+    return -1;
+  }
+  return shm_open(name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+}
+
+extern shared_export_t *open_shared(const char *name) {
+  shared_export_t *shared = calloc(1, sizeof(shared_export_t));
+  if (shared == NULL) {
+    return NULL;
+  }
+  if (name != NULL && (shared->name = strdup(name)) == NULL) {
+    free(shared);
+    return NULL;
+  }
+
+  shared->fd = create_region(name);
+  if (shared->fd == -1 || ftruncate(shared->fd, sizeof(m6502_shared_t)) == -1) {
+    fprintf(stderr, "Error: could not create shared memory %s: %s\n",
+            name != NULL ? name : "(memfd)", strerror(errno));
+    goto fail;
+  }
+  shared->region = mmap(NULL, sizeof(m6502_shared_t), PROT_READ | PROT_WRITE,
+                        MAP_SHARED, shared->fd, 0);
+  if (shared->region == MAP_FAILED) {
+    fprintf(stderr, "Error: could not map shared memory: %s\n",
+            strerror(errno));
+    goto fail;
+  }
+
+  memcpy(shared->region->magic, SHARED_MAGIC, sizeof(shared->region->magic));
+  shared->region->version = SHARED_VERSION;
+  atomic_init(&shared->region->sequence, 0);
+  return shared;
+
+fail:
+  if (shared->fd != -1) {
+    close(shared->fd);
+    if (name != NULL) {
+      shm_unlink(name);
+    }
+  }
+  free(shared->name);
+  free(shared);
+  return NULL;
+}
+
+/* seqlock, readers retry if the sequence was odd or changed under them */
+extern void publish_shared(shared_export_t *shared,
+                           const processor_t *processor) {
+  m6502_shared_t *region = shared->region;
+  uint32_t sequence =
+      atomic_load_explicit(&region->sequence, memory_order_relaxed);
+  atomic_store_explicit(&region->sequence, sequence + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+
+  region->frame = processor->frame;
+  region->clock_ticks = processor->clock_ticks;
+  memcpy(region->ram, processor->pages[0], INTERNAL_RAM_SIZE);
+  memcpy(region->prg_ram, processor->pages[PRG_RAM_START >> 8], PRG_RAM_SIZE);
+  memcpy(region->oam, processor->oam, OAM_SIZE);
+
+  atomic_store_explicit(&region->sequence, sequence + 2, memory_order_release);
+}
+
+extern int shared_fd(const shared_export_t *shared) { return shared->fd; }
+
+extern void close_shared(shared_export_t *shared) {
+  if (shared == NULL) {
+    return;
+  }
+  munmap(shared->region, sizeof(m6502_shared_t));
+  close(shared->fd);
+  if (shared->name != NULL) {
+    shm_unlink(shared->name);
+  }
+  free(shared->name);
+  free(shared);
+}
+
+extern const m6502_shared_t *m6502_shared_map(const char *name) {
+  int fd = shm_open(name, O_RDONLY, 0);
+  if (fd == -1) {
+    return NULL;
+  }
+  const m6502_shared_t *shared =
+      mmap(NULL, sizeof(m6502_shared_t), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (shared == MAP_FAILED) {
+    return NULL;
+  }
+  if (memcmp(shared->magic, SHARED_MAGIC, sizeof(shared->magic)) != 0 ||
+      shared->version != SHARED_VERSION) {
+    munmap((void *)shared, sizeof(m6502_shared_t));
+    return NULL;
+  }
+  return shared;
+}
+
+extern void m6502_shared_unmap(const m6502_shared_t *shared) {
+  munmap((void *)shared, sizeof(m6502_shared_t));
+}
+
+#else
+/* no shared memory, exporting always fails */
+extern shared_export_t *open_shared(const char *name) {
+  (void)name;
+  fprintf(stderr, "Warning: shared memory is not supported on this platform\n");
+  return NULL;
+}
+
+extern void publish_shared(shared_export_t *shared,
+                           const processor_t *processor) {
+  (void)shared;
+  (void)processor;
+}
+
+extern int shared_fd(const shared_export_t *shared) {
+  (void)shared;
+  return -1;
+}
+
+extern void close_shared(shared_export_t *shared) { (void)shared; }
+
+extern const m6502_shared_t *m6502_shared_map(const char *name) {
+  (void)name;
+  return NULL;
+}
+
+extern void m6502_shared_unmap(const m6502_shared_t *shared) {
+  (void)shared;
+}
+#endif
+
+extern bool m6502_share(processor_t *processor, const char *name) {
+  close_shared(processor->shared);
+  processor->shared = open_shared(name);
+  if (processor->shared != NULL) {
+    publish_shared(processor->shared, processor);
+  }
+  return processor->shared != NULL;
+}
+
+extern int m6502_shared_fd(const processor_t *processor) {
+  return processor->shared != NULL ? shared_fd(processor->shared) : -1;
+}
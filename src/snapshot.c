@@ -0,0 +1,72 @@
+#include <string.h>
+
+#include "../headers/hash.h"
+#include "../headers/snapshot.h"
+
+extern void m6502_save_snapshot(const processor_t *processor,
+                                m6502_snapshot_t *snapshot) {
+  memcpy(snapshot->ram, processor->memory, INTERNAL_RAM_SIZE);
+  memcpy(snapshot->ppu_registers, processor->memory + PPU_REGISTERS_START,
+         BUS_PAGE_SIZE);
+  memcpy(snapshot->io_registers, processor->memory + IO_REGISTERS_START,
+         BUS_PAGE_SIZE);
+  memcpy(snapshot->prg_ram, processor->pages[PRG_RAM_START >> 8],
+         PRG_RAM_SIZE);
+  memcpy(snapshot->oam, processor->oam, OAM_SIZE);
+  save_snapshot_registers(processor, snapshot);
+}
+
+extern void save_snapshot_registers(const processor_t *processor,
+                                    m6502_snapshot_t *snapshot) {
+  snapshot->pc = processor->registers.pc;
+  snapshot->sp = processor->registers._sp;
+  snapshot->x = processor->registers.x;
+  snapshot->y = processor->registers.y;
+  snapshot->accumulator = processor->registers.accumulator;
+  snapshot->status = processor->registers.status;
+  snapshot->controller = processor->controller;
+  snapshot->controller_shift = processor->controller_shift;
+  snapshot->controller_strobe = processor->controller_strobe;
+  snapshot->controller_polled = processor->controller_polled;
+  snapshot->lag_frame = processor->lag_frame;
+  memset(snapshot->reserved, 0, sizeof(snapshot->reserved));
+
+  snapshot->error = processor->error;
+  snapshot->reserved2 = 0;
+  snapshot->clock_ticks = processor->clock_ticks;
+  snapshot->frame = processor->frame;
+  snapshot->frame_end = processor->frame_end;
+}
+
+extern void m6502_load_snapshot(processor_t *processor,
+                                const m6502_snapshot_t *snapshot) {
+  memcpy(processor->memory, snapshot->ram, INTERNAL_RAM_SIZE);
+  memcpy(processor->memory + PPU_REGISTERS_START, snapshot->ppu_registers,
+         BUS_PAGE_SIZE);
+  memcpy(processor->memory + IO_REGISTERS_START, snapshot->io_registers,
+         BUS_PAGE_SIZE);
+  memcpy(processor->pages[PRG_RAM_START >> 8], snapshot->prg_ram,
+         PRG_RAM_SIZE);
+  memcpy(processor->oam, snapshot->oam, OAM_SIZE);
+
+  processor->registers.pc = snapshot->pc;
+  processor->registers._sp = snapshot->sp;
+  processor->registers.x = snapshot->x;
+  processor->registers.y = snapshot->y;
+  processor->registers.accumulator = snapshot->accumulator;
+  processor->registers.status = snapshot->status;
+  processor->controller = snapshot->controller;
+  processor->controller_shift = snapshot->controller_shift;
+  processor->controller_strobe = snapshot->controller_strobe;
+  processor->controller_polled = snapshot->controller_polled;
+  processor->lag_frame = snapshot->lag_frame;
+
+  processor->error = snapshot->error;
+  processor->clock_ticks = snapshot->clock_ticks;
+  processor->frame = snapshot->frame;
+  processor->frame_end = snapshot->frame_end;
+}
+
+extern uint64_t m6502_snapshot_hash(const m6502_snapshot_t *snapshot) {
+  return hash_bytes(snapshot, SNAPSHOT_STATE_SIZE, 0);
+}
@@ -0,0 +1,489 @@
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../headers/compress.h"
+#include "../headers/state.h"
+
+#define STATE_MAGIC "M6ST"
+#define HEADER_SIZE 8        /* magic, u16 version, u16 chunk count */
+#define CHUNK_HEADER_SIZE 16 /* tag, u32 encoding, raw size, stored size */
+#define MAX_STATE_FILE (1 << 20)
+
+#define EXTRA_TAG "XTRA"
+#define MAX_EXTRA 4096
+
+#define WRITER_QUEUE 4
+#define WRITER_PATH_MAX 4096
+
+enum chunk_encoding { ENCODING_RAW, ENCODING_LZ };
+
+/* a chunk is either a region of the snapshot copied as it is or a few
+ * fields packed by encode/decode */
+typedef struct {
+  char tag[5];
+  size_t size;
+  size_t offset;
+  void (*encode)(const m6502_snapshot_t *snapshot, uint8_t *bytes);
+  void (*decode)(m6502_snapshot_t *snapshot, const uint8_t *bytes);
+  bool optional; /* added later, files from older writers lack it */
+} chunk_kind_t;
+
+typedef struct {
+  m6502_snapshot_t snapshot;
+  char path[WRITER_PATH_MAX];
+} pending_t;
+
+struct _m6502_state_writer {
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t wake; /* something was queued or the writer is stopping */
+  pthread_cond_t idle; /* the queue ran empty */
+  pthread_cond_t room; /* a queued state was taken off */
+  pending_t queue[WRITER_QUEUE];
+  size_t head;
+  size_t count;
+  bool writing;
+  bool stopping;
+  bool failed;
+};
+
+static void put16(uint8_t *bytes, uint16_t value) {
+  bytes[0] = value & 0xff;
+  bytes[1] = value >> 8;
+}
+
+static void put32(uint8_t *bytes, uint32_t value) {
+  put16(bytes, value & 0xffff);
+  put16(bytes + 2, value >> 16);
+}
+
+static void put64(uint8_t *bytes, uint64_t value) {
+  put32(bytes, value & 0xffffffff);
+  put32(bytes + 4, value >> 32);
+}
+
+static uint16_t get16(const uint8_t *bytes) {
+  return bytes[0] | (uint16_t)bytes[1] << 8;
+}
+
+static uint32_t get32(const uint8_t *bytes) {
+  return get16(bytes) | (uint32_t)get16(bytes + 2) << 16;
+}
+
+static uint64_t get64(const uint8_t *bytes) {
+  return get32(bytes) | (uint64_t)get32(bytes + 4) << 32;
+}
+
+static void encode_cpu(const m6502_snapshot_t *snapshot, uint8_t *bytes) {
+  put16(bytes, snapshot->pc);
+  bytes[2] = snapshot->sp;
+  bytes[3] = snapshot->accumulator;
+  bytes[4] = snapshot->x;
+  bytes[5] = snapshot->y;
+  bytes[6] = snapshot->status;
+  put32(bytes + 7, (uint32_t)snapshot->error);
+}
+
+static void decode_cpu(m6502_snapshot_t *snapshot, const uint8_t *bytes) {
+  snapshot->pc = get16(bytes);
+  snapshot->sp = bytes[2];
+  snapshot->accumulator = bytes[3];
+  snapshot->x = bytes[4];
+  snapshot->y = bytes[5];
+  snapshot->status = bytes[6];
+  snapshot->error = (int32_t)get32(bytes + 7);
+}
+
+static void encode_time(const m6502_snapshot_t *snapshot, uint8_t *bytes) {
+  put64(bytes, snapshot->clock_ticks);
+  put64(bytes + 8, snapshot->frame);
+  put64(bytes + 16, snapshot->frame_end);
+}
+
+static void decode_time(m6502_snapshot_t *snapshot, const uint8_t *bytes) {
+  snapshot->clock_ticks = get64(bytes);
+  snapshot->frame = get64(bytes + 8);
+  snapshot->frame_end = get64(bytes + 16);
+}
+
+static void encode_controller(const m6502_snapshot_t *snapshot,
+                              uint8_t *bytes) {
+  bytes[0] = snapshot->controller;
+  bytes[1] = snapshot->controller_shift;
+  bytes[2] = snapshot->controller_strobe;
+}
+
+static void decode_controller(m6502_snapshot_t *snapshot,
+                              const uint8_t *bytes) {
+  snapshot->controller = bytes[0];
+  snapshot->controller_shift = bytes[1];
+  snapshot->controller_strobe = bytes[2];
+}
+
+static void encode_lag(const m6502_snapshot_t *snapshot, uint8_t *bytes) {
+  bytes[0] = snapshot->controller_polled;
+  bytes[1] = snapshot->lag_frame;
+}
+
+static void decode_lag(m6502_snapshot_t *snapshot, const uint8_t *bytes) {
+  snapshot->controller_polled = bytes[0] != 0;
+  snapshot->lag_frame = bytes[1] != 0;
+}
+
+static const chunk_kind_t chunk_kinds[] = {
+    {"CPU ", 11, 0, &encode_cpu, &decode_cpu, false},
+    {"TIME", 24, 0, &encode_time, &decode_time, false},
+    {"CTRL", 3, 0, &encode_controller, &decode_controller, false},
+    {"RAM ", INTERNAL_RAM_SIZE, offsetof(m6502_snapshot_t, ram), NULL, NULL,
+     false},
+    {"PPUR", BUS_PAGE_SIZE, offsetof(m6502_snapshot_t, ppu_registers), NULL,
+     NULL, false},
+    {"IORG", BUS_PAGE_SIZE, offsetof(m6502_snapshot_t, io_registers), NULL,
+     NULL, false},
+    {"PRGR", PRG_RAM_SIZE, offsetof(m6502_snapshot_t, prg_ram), NULL, NULL,
+     false},
+    {"OAM ", OAM_SIZE, offsetof(m6502_snapshot_t, oam), NULL, NULL, false},
+    {"LAG ", 2, 0, &encode_lag, &decode_lag, true},
+};
+
+#define CHUNK_KINDS (sizeof(chunk_kinds) / sizeof(chunk_kinds[0]))
+
+static size_t state_bound(size_t extra_size) {
+  size_t size = HEADER_SIZE + CHUNK_HEADER_SIZE + extra_size;
+  for (size_t i = 0; i < CHUNK_KINDS; i++) {
+    size += CHUNK_HEADER_SIZE + compress_bound(chunk_kinds[i].size);
+  }
+  return size;
+}
+
+/* `extra` goes last in a chunk of its own, stored raw */
+static size_t encode_state(const m6502_snapshot_t *snapshot, const void *extra,
+                           size_t extra_size, uint8_t *out) {
+  uint8_t raw[PRG_RAM_SIZE]; /* the largest chunk */
+  memcpy(out, STATE_MAGIC, 4);
+  put16(out + 4, STATE_VERSION);
+  put16(out + 6, CHUNK_KINDS + (extra != NULL));
+  size_t size = HEADER_SIZE;
+
+  for (size_t i = 0; i < CHUNK_KINDS; i++) {
+    const chunk_kind_t *kind = &chunk_kinds[i];
+    const uint8_t *bytes = (const uint8_t *)snapshot + kind->offset;
+    if (kind->encode != NULL) {
+      kind->encode(snapshot, raw);
+      bytes = raw;
+    }
+    uint8_t *header = out + size;
+    uint8_t *data = header + CHUNK_HEADER_SIZE;
+    size_t stored = compress_bytes(bytes, kind->size, data);
+    uint32_t encoding = ENCODING_LZ;
+    if (stored >= kind->size) {
+      memcpy(data, bytes, kind->size);
+      stored = kind->size;
+      encoding = ENCODING_RAW;
+    }
+    memcpy(header, kind->tag, 4);
+    put32(header + 4, encoding);
+    put32(header + 8, kind->size);
+    put32(header + 12, stored);
+    size += CHUNK_HEADER_SIZE + stored;
+  }
+
+  if (extra != NULL) {
+    uint8_t *header = out + size;
+    memcpy(header, EXTRA_TAG, 4);
+    put32(header + 4, ENCODING_RAW);
+    put32(header + 8, extra_size);
+    put32(header + 12, extra_size);
+    memcpy(header + CHUNK_HEADER_SIZE, extra, extra_size);
+    size += CHUNK_HEADER_SIZE + extra_size;
+  }
+  return size;
+}
+
+/* `extra` NULL to skip the extra chunk like any other unknown one */
+static bool decode_state(const uint8_t *in, size_t size,
+                         m6502_snapshot_t *snapshot, void *extra,
+                         size_t *extra_size) {
+  if (size < HEADER_SIZE || memcmp(in, STATE_MAGIC, 4) != 0 ||
+      get16(in + 4) > STATE_VERSION) {
+    return false;
+  }
+  size_t count = get16(in + 6);
+  bool seen[CHUNK_KINDS] = {false};
+  bool seen_extra = false;
+  uint8_t raw[PRG_RAM_SIZE];
+  size_t offset = HEADER_SIZE;
+
+  for (size_t chunk = 0; chunk < count; chunk++) {
+    if (size - offset < CHUNK_HEADER_SIZE) {
+      return false;
+    }
+    const uint8_t *header = in + offset;
+    uint32_t encoding = get32(header + 4);
+    uint32_t raw_size = get32(header + 8);
+    uint32_t stored = get32(header + 12);
+    offset += CHUNK_HEADER_SIZE;
+    if (stored > size - offset) {
+      return false;
+    }
+    const uint8_t *data = in + offset;
+    offset += stored;
+
+    if (extra != NULL && memcmp(header, EXTRA_TAG, 4) == 0) {
+      if (encoding != ENCODING_RAW || stored != raw_size ||
+          raw_size > *extra_size) {
+        return false;
+      }
+      memcpy(extra, data, raw_size);
+      *extra_size = raw_size;
+      seen_extra = true;
+      continue;
+    }
+
+    size_t i = 0;
+    while (i < CHUNK_KINDS && memcmp(chunk_kinds[i].tag, header, 4) != 0) {
+      i++;
+    }
+    if (i == CHUNK_KINDS) {
+      continue; /* from a newer writer */
+    }
+    const chunk_kind_t *kind = &chunk_kinds[i];
+    if (raw_size != kind->size) {
+      return false;
+    }
+    if (encoding == ENCODING_RAW && stored == raw_size) {
+      memcpy(raw, data, raw_size);
+    } else if (encoding != ENCODING_LZ ||
+               !decompress_bytes(data, stored, raw, raw_size)) {
+      return false;
+    }
+    if (kind->decode != NULL) {
+      kind->decode(snapshot, raw);
+    } else {
+      memcpy((uint8_t *)snapshot + kind->offset, raw, raw_size);
+    }
+    seen[i] = true;
+  }
+
+  for (size_t i = 0; i < CHUNK_KINDS; i++) {
+    if (!seen[i] && !chunk_kinds[i].optional) {
+      return false;
+    }
+  }
+  return extra == NULL || seen_extra;
+}
+
+extern bool m6502_write_state(const m6502_snapshot_t *snapshot,
+                              const char *path) {
+  return m6502_write_state_extra(snapshot, NULL, 0, path);
+}
+
+/* the rename is only durable once the directory holding the file is synced,
+ * some file systems can't sync a directory and say so with EINVAL */
+static bool sync_directory(const char *path) {
+  const char *slash = strrchr(path, '/');
+  char *directory = malloc(strlen(path) + 2);
+  if (directory == NULL) {
+    return false;
+  }
+  if (slash == NULL) {
+    strcpy(directory, ".");
+  } else {
+    size_t length = slash == path ? 1 : (size_t)(slash - path);
+    memcpy(directory, path, length);
+    directory[length] = '\0';
+  }
+  int fd = open(directory, O_RDONLY);
+  free(directory);
+  if (fd == -1) {
+    return false;
+  }
+  bool ok = fsync(fd) == 0 || errno == EINVAL;
+  close(fd);
+  return ok;
+}
+
+extern bool m6502_write_state_extra(const m6502_snapshot_t *snapshot,
+                                    const void *extra, size_t extra_size,
+                                    const char *path) {
+  if (extra_size > MAX_EXTRA) {
+    return false;
+  }
+  uint8_t *buffer = malloc(state_bound(extra_size));
+  char *temporary = malloc(strlen(path) + 8);
+  if (buffer == NULL || temporary == NULL) {
+    free(buffer);
+    free(temporary);
+    return false;
+  }
+  size_t size = encode_state(snapshot, extra, extra_size, buffer);
+  /* a name of its own, writers of the same path may race */
+  sprintf(temporary, "%s.XXXXXX", path);
+
+  bool ok = false;
+  int fd = mkstemp(temporary);
+  FILE *fp = NULL;
+  if (fd != -1 && (fchmod(fd, 0644) != 0 ||
+                   (fp = fdopen(fd, "wb")) == NULL)) {
+    close(fd);
+    remove(temporary);
+  }
+  if (fp != NULL) {
+    ok = fwrite(buffer, 1, size, fp) == size && fflush(fp) == 0 &&
+         fsync(fileno(fp)) == 0;
+    ok = fclose(fp) == 0 && ok;
+    ok = ok && rename(temporary, path) == 0;
+    if (!ok) {
+      remove(temporary);
+    }
+    ok = ok && sync_directory(path);
+  }
+  free(buffer);
+  free(temporary);
+  return ok;
+}
+
+extern bool m6502_read_state(const char *path, m6502_snapshot_t *snapshot) {
+  return m6502_read_state_extra(path, snapshot, NULL, NULL);
+}
+
+extern bool m6502_read_state_extra(const char *path,
+                                   m6502_snapshot_t *snapshot, void *extra,
+                                   size_t *extra_size) {
+  FILE *fp = fopen(path, "rb");
+  if (fp == NULL) {
+    return false;
+  }
+  uint8_t *buffer = malloc(MAX_STATE_FILE);
+  size_t size = buffer != NULL ? fread(buffer, 1, MAX_STATE_FILE, fp) : 0;
+  fclose(fp);
+
+  m6502_snapshot_t decoded = {0};
+  bool ok = buffer != NULL &&
+            decode_state(buffer, size, &decoded, extra, extra_size);
+  if (ok) {
+    *snapshot = decoded;
+  }
+  free(buffer);
+  return ok;
+}
+
+static void *write_states(void *argument) {
+  m6502_state_writer_t *writer = argument;
+  pending_t *pending = malloc(sizeof(pending_t));
+  pthread_mutex_lock(&writer->lock);
+  for (;;) {
+    while (writer->count == 0 && !writer->stopping) {
+      pthread_cond_wait(&writer->wake, &writer->lock);
+    }
+    if (writer->count == 0) {
+      break;
+    }
+    bool ok = pending != NULL;
+    if (ok) {
+      *pending = writer->queue[writer->head];
+    }
+    writer->head = (writer->head + 1) % WRITER_QUEUE;
+    writer->count--;
+    writer->writing = true;
+    pthread_cond_signal(&writer->room);
+    pthread_mutex_unlock(&writer->lock);
+
+    ok = ok && m6502_write_state(&pending->snapshot, pending->path);
+
+    pthread_mutex_lock(&writer->lock);
+    writer->writing = false;
+    writer->failed |= !ok;
+    if (writer->count == 0) {
+      pthread_cond_broadcast(&writer->idle);
+    }
+  }
+  pthread_mutex_unlock(&writer->lock);
+  free(pending);
+  return NULL;
+}
+
+extern m6502_state_writer_t *m6502_state_writer_create(void) {
+  m6502_state_writer_t *writer = calloc(1, sizeof(m6502_state_writer_t));
+  if (writer == NULL) {
+    return NULL;
+  }
+  pthread_mutex_init(&writer->lock, NULL);
+  pthread_cond_init(&writer->wake, NULL);
+  pthread_cond_init(&writer->idle, NULL);
+  pthread_cond_init(&writer->room, NULL);
+  if (pthread_create(&writer->thread, NULL, &write_states, writer) != 0) {
+    pthread_cond_destroy(&writer->room);
+    pthread_cond_destroy(&writer->idle);
+    pthread_cond_destroy(&writer->wake);
+    pthread_mutex_destroy(&writer->lock);
+    free(writer);
+    return NULL;
+  }
+  return writer;
+}
+
+extern bool m6502_state_writer_submit(m6502_state_writer_t *writer,
+                                      const m6502_snapshot_t *snapshot,
+                                      const char *path) {
+  if (strlen(path) >= WRITER_PATH_MAX) {
+    return false;
+  }
+  pthread_mutex_lock(&writer->lock);
+  /* an older state of the same file would only be overwritten anyway */
+  pending_t *pending = NULL;
+  for (size_t i = 0; i < writer->count && pending == NULL; i++) {
+    pending_t *queued = &writer->queue[(writer->head + i) % WRITER_QUEUE];
+    if (strcmp(queued->path, path) == 0) {
+      pending = queued;
+    }
+  }
+  bool replaced = pending != NULL;
+  if (!replaced) {
+    while (writer->count == WRITER_QUEUE) {
+      pthread_cond_wait(&writer->room, &writer->lock);
+    }
+    writer->count++;
+    pending =
+        &writer->queue[(writer->head + writer->count - 1) % WRITER_QUEUE];
+  }
+  pending->snapshot = *snapshot;
+  strcpy(pending->path, path);
+  pthread_cond_signal(&writer->wake);
+  pthread_mutex_unlock(&writer->lock);
+  return !replaced;
+}
+
+extern bool m6502_state_writer_flush(m6502_state_writer_t *writer) {
+  pthread_mutex_lock(&writer->lock);
+  while (writer->count > 0 || writer->writing) {
+    pthread_cond_wait(&writer->idle, &writer->lock);
+  }
+  bool ok = !writer->failed;
+  writer->failed = false;
+  pthread_mutex_unlock(&writer->lock);
+  return ok;
+}
+
+extern void m6502_state_writer_destroy(m6502_state_writer_t *writer) {
+  if (writer == NULL) {
+    return;
+  }
+  pthread_mutex_lock(&writer->lock);
+  writer->stopping = true;
+  pthread_cond_signal(&writer->wake);
+  pthread_mutex_unlock(&writer->lock);
+  pthread_join(writer->thread, NULL);
+  pthread_cond_destroy(&writer->room);
+  pthread_cond_destroy(&writer->idle);
+  pthread_cond_destroy(&writer->wake);
+  pthread_mutex_destroy(&writer->lock);
+  free(writer);
+}
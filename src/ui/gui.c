@@ -5,43 +5,50 @@
 #include <SDL2/SDL.h>
 #include <stdint.h>
 
-static SDL_Window *g_window = NULL;
-static SDL_Renderer *g_renderer = NULL;
-static SDL_Surface *g_surface = NULL;
+struct _ui {
+  SDL_Window *window;
+  SDL_Renderer *renderer;
+  SDL_Surface *surface;
 
-uint8_t *ppu_memory = NULL;
-processor_t *processor = NULL;
+  uint8_t *ppu_memory;
+  processor_t *processor;
+};
 
-extern void set_processor(processor_t *p) {
-  processor = p;
-}
-
-extern _Bool setup_ppu(void) {
+extern ui_t *setup_ppu(processor_t *processor) {
   if(SDL_Init(SDL_INIT_AUDIO | SDL_INIT_VIDEO) < 0) {
     fprintf(stderr, "Error: %s", SDL_GetError());
-    return 1;
+    return NULL;
+  }
+  ui_t *ui = calloc(1, sizeof(ui_t));
+  if(ui == NULL) {
+    return NULL;
+  }
+  ui->processor = processor;
+  ui->window = SDL_CreateWindow("NES emulator", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 800, 600, 0);
+  if(ui->window == NULL) {
+    fprintf(stderr, "Error: %s", SDL_GetError());
+    free(ui);
+    return NULL;
   }
-  g_window = SDL_CreateWindow("NES emulator", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 800, 600, 0);
-  g_surface = SDL_GetWindowSurface(g_window);
-  SDL_FillRect(g_surface, NULL, SDL_MapRGB(g_surface->format, 0xff, 0xff, 0xff));
-  SDL_UpdateWindowSurface(g_window);
+  ui->surface = SDL_GetWindowSurface(ui->window);
+  SDL_FillRect(ui->surface, NULL, SDL_MapRGB(ui->surface->format, 0xff, 0xff, 0xff));
+  SDL_UpdateWindowSurface(ui->window);
   SDL_Delay(2000);
-  ppu_memory = calloc(0x4000, sizeof(uint8_t));
-  return 0;
+  ui->ppu_memory = calloc(0x4000, sizeof(uint8_t));
+  return ui;
 }
 
 
-extern void free_ui(void) {
-  if(g_window != NULL) {
-    SDL_DestroyWindow(g_window);
-    g_window = NULL;
+extern void free_ui(ui_t *ui) {
+  if(ui == NULL) {
+    return;
   }
-  if(g_renderer != NULL) {
-    SDL_DestroyRenderer(g_renderer);
-    g_renderer = NULL;
+  if(ui->renderer != NULL) {
+    SDL_DestroyRenderer(ui->renderer);
   }
-  if(ppu_memory != NULL) {
-    free(ppu_memory);
-    ppu_memory = NULL;
+  if(ui->window != NULL) {
+    SDL_DestroyWindow(ui->window);
   }
+  free(ui->ppu_memory);
+  free(ui);
 }
@@ -0,0 +1,235 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../headers/hash.h"
+#include "../headers/pool.h"
+#include "../headers/verify.h"
+
+#define CHECKPOINT_MAGIC "M6CK"
+#define CHECKPOINT_VERSION 1
+
+typedef struct {
+  uint8_t magic[4];
+  uint32_t version;
+  uint32_t snapshot_size; /* checkpoints only load into the same layout */
+  uint32_t interval;
+  uint64_t count;
+} checkpoint_header_t;
+
+typedef struct {
+  const m6502_checkpoints_t *checkpoints;
+  const uint8_t *inputs;
+  size_t input_count;
+  processor_t **instances; /* one per pool worker */
+  bool *segment_ok;
+} verification_t;
+
+static uint64_t checkpoint_hash(const m6502_snapshot_t *snapshot) {
+  return hash_bytes(snapshot, sizeof(*snapshot), 0);
+}
+
+static void set_input(processor_t *processor, const uint8_t *inputs,
+                      size_t input_count) {
+  m6502_set_controller(processor, processor->frame < input_count
+                                      ? inputs[processor->frame]
+                                      : 0);
+}
+
+static bool add_checkpoint(const processor_t *processor,
+                           m6502_checkpoints_t *checkpoints,
+                           size_t *capacity) {
+  if (checkpoints->count == *capacity) {
+    *capacity = *capacity ? *capacity * 2 : 64;
+    m6502_snapshot_t *snapshots = realloc(
+        checkpoints->snapshots, *capacity * sizeof(m6502_snapshot_t));
+    if (snapshots == NULL) {
+      return false;
+    }
+    checkpoints->snapshots = snapshots;
+    uint64_t *hashes =
+        realloc(checkpoints->hashes, *capacity * sizeof(uint64_t));
+    if (hashes == NULL) {
+      return false;
+    }
+    checkpoints->hashes = hashes;
+  }
+  m6502_snapshot_t *snapshot = &checkpoints->snapshots[checkpoints->count];
+  m6502_save_snapshot(processor, snapshot);
+  checkpoints->hashes[checkpoints->count++] = checkpoint_hash(snapshot);
+  return true;
+}
+
+extern bool m6502_record_checkpoints(processor_t *processor,
+                                     const uint8_t *inputs,
+                                     size_t input_count,
+                                     unsigned long long frames,
+                                     unsigned interval,
+                                     m6502_checkpoints_t *checkpoints) {
+  memset(checkpoints, 0, sizeof(*checkpoints));
+  checkpoints->interval = interval ? interval : 1;
+  size_t capacity = 0;
+  if (!add_checkpoint(processor, checkpoints, &capacity)) {
+    m6502_free_checkpoints(checkpoints);
+    return false;
+  }
+
+  for (unsigned long long frame = 1; frame <= frames; frame++) {
+    set_input(processor, inputs, input_count);
+    bool stopped = m6502_run_frames(processor, 1) != SUCCESS;
+    if ((stopped || frame % checkpoints->interval == 0 || frame == frames) &&
+        !add_checkpoint(processor, checkpoints, &capacity)) {
+      m6502_free_checkpoints(checkpoints);
+      return false;
+    }
+    if (stopped) {
+      break;
+    }
+  }
+  return true;
+}
+
+/* the segment ends on the frame of the next checkpoint, or earlier if the
+ * cpu stops, exactly where the recording would have stopped. A recording
+ * that stopped on an error did so partway through the frame of its last
+ * checkpoint, so that frame is run as well until the error comes up */
+static void verify_segment(void *context, size_t index, unsigned worker) {
+  verification_t *verification = context;
+  const m6502_checkpoints_t *checkpoints = verification->checkpoints;
+  processor_t *processor = verification->instances[worker];
+
+  m6502_load_snapshot(processor, &checkpoints->snapshots[index]);
+  const m6502_snapshot_t *next = &checkpoints->snapshots[index + 1];
+  unsigned long long end = next->frame + (next->error != SUCCESS);
+  while (processor->frame < end && processor->error == SUCCESS) {
+    set_input(processor, verification->inputs, verification->input_count);
+    m6502_run_frames(processor, 1);
+  }
+
+  m6502_snapshot_t snapshot;
+  m6502_save_snapshot(processor, &snapshot);
+  verification->segment_ok[index] =
+      checkpoint_hash(&snapshot) == checkpoints->hashes[index + 1];
+}
+
+extern size_t m6502_verify_checkpoints(
+    const processor_t *model, const m6502_checkpoints_t *checkpoints,
+    const uint8_t *inputs, size_t input_count, unsigned workers,
+    bool *segment_ok) {
+  size_t segments = checkpoints->count > 0 ? checkpoints->count - 1 : 0;
+  verification_t verification = {checkpoints, inputs, input_count, NULL,
+                                 segment_ok};
+  bool *flags = NULL;
+  if (segment_ok == NULL) {
+    flags = calloc(segments ? segments : 1, sizeof(bool));
+    verification.segment_ok = flags;
+  }
+
+  size_t mismatches = segments;
+  pool_t *pool = pool_create(workers, true);
+  if (pool == NULL || verification.segment_ok == NULL) {
+    goto done;
+  }
+  verification.instances = calloc(pool_size(pool), sizeof(processor_t *));
+  if (verification.instances == NULL) {
+    goto done;
+  }
+  for (unsigned i = 0; i < pool_size(pool); i++) {
+    verification.instances[i] = m6502_clone(model);
+    if (verification.instances[i] == NULL) {
+      goto done;
+    }
+    while (verification.instances[i]->watchpoint_count > 0) {
+      m6502_remove_watchpoint(
+          verification.instances[i],
+          verification.instances[i]->watchpoints[0].address);
+    }
+  }
+
+  pool_run(pool, segments, &verify_segment, &verification);
+  mismatches = 0;
+  for (size_t i = 0; i < segments; i++) {
+    mismatches += !verification.segment_ok[i];
+  }
+
+done:
+  for (unsigned i = 0; verification.instances != NULL && i < pool_size(pool);
+       i++) {
+    m6502_destroy(verification.instances[i]);
+  }
+  free(verification.instances);
+  pool_destroy(pool);
+  free(flags);
+  return mismatches;
+}
+
+extern bool m6502_save_checkpoints(const m6502_checkpoints_t *checkpoints,
+                                   const char *path) {
+  FILE *fp = fopen(path, "wb");
+  if (fp == NULL) {
+    return false;
+  }
+  checkpoint_header_t header = {{0}, CHECKPOINT_VERSION,
+                                sizeof(m6502_snapshot_t),
+                                checkpoints->interval, checkpoints->count};
+  memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+  bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+            fwrite(checkpoints->hashes, sizeof(uint64_t), checkpoints->count,
+                   fp) == checkpoints->count &&
+            fwrite(checkpoints->snapshots, sizeof(m6502_snapshot_t),
+                   checkpoints->count, fp) == checkpoints->count;
+  return fclose(fp) == 0 && ok;
+}
+
+/* whether the rest of the file holds `count` checkpoints, checked before
+ * the count goes anywhere near an allocation size */
+static bool count_fits(FILE *fp, uint64_t count) {
+  const size_t entry = sizeof(uint64_t) + sizeof(m6502_snapshot_t);
+  long start = ftell(fp);
+  if (count > SIZE_MAX / entry || start < 0 || fseek(fp, 0, SEEK_END) != 0) {
+    return false;
+  }
+  long end = ftell(fp);
+  if (end < start || fseek(fp, start, SEEK_SET) != 0) {
+    return false;
+  }
+  return count <= (uint64_t)(end - start) / entry;
+}
+
+extern bool m6502_load_checkpoints(const char *path,
+                                   m6502_checkpoints_t *checkpoints) {
+  memset(checkpoints, 0, sizeof(*checkpoints));
+  FILE *fp = fopen(path, "rb");
+  if (fp == NULL) {
+    return false;
+  }
+  checkpoint_header_t header;
+  bool ok = fread(&header, sizeof(header), 1, fp) == 1 &&
+            memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) == 0 &&
+            header.version == CHECKPOINT_VERSION &&
+            header.snapshot_size == sizeof(m6502_snapshot_t) &&
+            header.interval != 0 && count_fits(fp, header.count);
+  if (ok) {
+    checkpoints->count = header.count;
+    checkpoints->interval = header.interval;
+    checkpoints->hashes = malloc(header.count * sizeof(uint64_t));
+    checkpoints->snapshots = malloc(header.count * sizeof(m6502_snapshot_t));
+    ok = checkpoints->hashes != NULL && checkpoints->snapshots != NULL &&
+         fread(checkpoints->hashes, sizeof(uint64_t), header.count, fp) ==
+             header.count &&
+         fread(checkpoints->snapshots, sizeof(m6502_snapshot_t), header.count,
+               fp) == header.count;
+  }
+  fclose(fp);
+  if (!ok) {
+    m6502_free_checkpoints(checkpoints);
+  }
+  return ok;
+}
+
+extern void m6502_free_checkpoints(m6502_checkpoints_t *checkpoints) {
+  free(checkpoints->snapshots);
+  free(checkpoints->hashes);
+  memset(checkpoints, 0, sizeof(*checkpoints));
+}
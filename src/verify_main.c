@@ -0,0 +1,160 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../headers/cpu.h"
+#include "../headers/inputs.h"
+#include "../headers/verify.h"
+
+/* command line front end of the checkpoint verification, `record` runs a rom
+ * once and stores its checkpoints, `check` replays every segment between
+ * them on all cores */
+
+static void print_help(const char *name) {
+  fprintf(stderr,
+          "usage: %s record rom inputs frames interval checkpoints\n"
+          "       %s check [-j workers] rom inputs checkpoints\n",
+          name, name);
+  fprintf(stderr, "  inputs  one controller byte per frame, - for none\n");
+}
+
+static double elapsed(const struct timespec *begin) {
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return (end.tv_sec - begin->tv_sec) + (end.tv_nsec - begin->tv_nsec) / 1e9;
+}
+
+static bool load_inputs(const char *path, uint8_t **inputs, size_t *count) {
+  *inputs = NULL;
+  *count = 0;
+  if (strcmp(path, "-") == 0) {
+    return true;
+  }
+  if ((*inputs = read_inputs(path, count)) == NULL) {
+    fprintf(stderr, "Error: could not read input %s\n", path);
+    return false;
+  }
+  return true;
+}
+
+static int record(int argc, char *argv[]) {
+  if (argc != 7) {
+    print_help(argv[0]);
+    return 1;
+  }
+  uint8_t *inputs;
+  size_t input_count;
+  if (!load_inputs(argv[3], &inputs, &input_count)) {
+    return 1;
+  }
+  processor_t *processor = m6502_create_headless(argv[2]);
+  if (processor == NULL) {
+    fprintf(stderr, "Error: could not load %s\n", argv[2]);
+    free(inputs);
+    return 1;
+  }
+
+  struct timespec begin;
+  clock_gettime(CLOCK_MONOTONIC, &begin);
+  m6502_checkpoints_t checkpoints;
+  bool ok = m6502_record_checkpoints(
+      processor, inputs, input_count, strtoull(argv[4], NULL, 10),
+      (unsigned)strtoul(argv[5], NULL, 10), &checkpoints);
+  double seconds = elapsed(&begin);
+  if (ok) {
+    printf("recorded %zu checkpoints over %llu frames in %.3fs, %s\n",
+           checkpoints.count, processor->frame, seconds,
+           m6502_strerror(processor->error));
+    ok = m6502_save_checkpoints(&checkpoints, argv[6]);
+    if (!ok) {
+      fprintf(stderr, "Error: could not write %s\n", argv[6]);
+    }
+    m6502_free_checkpoints(&checkpoints);
+  } else {
+    fprintf(stderr, "Error: out of memory\n");
+  }
+  m6502_destroy(processor);
+  free(inputs);
+  return ok ? 0 : 1;
+}
+
+static int check(int argc, char *argv[]) {
+  unsigned workers = 0;
+  int option;
+  optind = 2;
+  while ((option = getopt(argc, argv, "j:h")) != -1) {
+    switch (option) {
+    case 'j':
+      workers = (unsigned)strtoul(optarg, NULL, 10);
+      break;
+    default:
+      print_help(argv[0]);
+      return 1;
+    }
+  }
+  if (argc - optind != 3) {
+    print_help(argv[0]);
+    return 1;
+  }
+  const char *rom = argv[optind], *path = argv[optind + 2];
+
+  m6502_checkpoints_t checkpoints;
+  if (!m6502_load_checkpoints(path, &checkpoints)) {
+    fprintf(stderr, "Error: could not read checkpoints %s\n", path);
+    return 1;
+  }
+  uint8_t *inputs;
+  size_t input_count;
+  processor_t *processor = NULL;
+  bool *segment_ok = calloc(checkpoints.count, sizeof(bool));
+  int status = 1;
+  if (!load_inputs(argv[optind + 1], &inputs, &input_count)) {
+    goto done;
+  }
+  if ((processor = m6502_create_headless(rom)) == NULL) {
+    fprintf(stderr, "Error: could not load %s\n", rom);
+    goto done;
+  }
+  if (segment_ok == NULL) {
+    fprintf(stderr, "Error: out of memory\n");
+    goto done;
+  }
+
+  struct timespec begin;
+  clock_gettime(CLOCK_MONOTONIC, &begin);
+  size_t mismatches = m6502_verify_checkpoints(
+      processor, &checkpoints, inputs, input_count, workers, segment_ok);
+  double seconds = elapsed(&begin);
+  size_t segments = checkpoints.count > 0 ? checkpoints.count - 1 : 0;
+  for (size_t i = 0; i < segments; i++) {
+    if (!segment_ok[i]) {
+      printf("mismatch in segment %zu, frames %llu-%llu\n", i,
+             (unsigned long long)checkpoints.snapshots[i].frame,
+             (unsigned long long)checkpoints.snapshots[i + 1].frame);
+    }
+  }
+  printf("%zu of %zu segments match, checked in %.3fs\n",
+         segments - mismatches, segments, seconds);
+  status = mismatches == 0 ? 0 : 2;
+
+done:
+  m6502_destroy(processor);
+  free(segment_ok);
+  free(inputs);
+  m6502_free_checkpoints(&checkpoints);
+  return status;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc >= 2 && strcmp(argv[1], "record") == 0) {
+    return record(argc, argv);
+  }
+  if (argc >= 2 && strcmp(argv[1], "check") == 0) {
+    return check(argc, argv);
+  }
+  print_help(argv[0]);
+  return 1;
+}
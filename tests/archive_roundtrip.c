@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../headers/archive.h"
+
+/* random inserts, evictions and restores of mostly zero snapshots, every
+ * restore has to give back exactly what was inserted under that id */
+
+#define STATES 64
+#define ITERATIONS 5000
+
+static uint32_t next_random(uint32_t *seed) {
+  *seed = *seed * 1103515245u + 12345u;
+  return *seed >> 8;
+}
+
+int main(void) {
+  static m6502_snapshot_t expected[STATES];
+  uint32_t ids[STATES];
+  bool live[STATES] = {false};
+  m6502_archive_t *archive = m6502_archive_create();
+  if (archive == NULL) {
+    fprintf(stderr, "Error: could not create the archive\n");
+    return 1;
+  }
+
+  uint32_t seed = 1;
+  for (unsigned iteration = 0; iteration < ITERATIONS; iteration++) {
+    size_t slot = next_random(&seed) % STATES;
+    if (!live[slot]) {
+      memset(&expected[slot], 0, sizeof(expected[slot]));
+      for (unsigned i = next_random(&seed) % 4; i > 0; i--) {
+        ((uint8_t *)&expected[slot])[next_random(&seed) %
+                                     sizeof(expected[slot])] =
+            (uint8_t)next_random(&seed);
+      }
+      ids[slot] = m6502_archive_insert(archive, &expected[slot]);
+      if (ids[slot] == ARCHIVE_NONE) {
+        fprintf(stderr, "Error: insert failed at iteration %u\n", iteration);
+        return 1;
+      }
+      live[slot] = true;
+    } else if (next_random(&seed) % 2) {
+      m6502_archive_evict(archive, ids[slot]);
+      live[slot] = false;
+    }
+
+    for (size_t i = 0; i < STATES; i++) {
+      m6502_snapshot_t restored;
+      if (live[i] && (!m6502_archive_restore(archive, ids[i], &restored) ||
+                      memcmp(&restored, &expected[i], sizeof(restored)))) {
+        fprintf(stderr, "Error: state %zu restored wrong at iteration %u\n",
+                i, iteration);
+        return 1;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < STATES; i++) {
+    if (live[i]) {
+      m6502_archive_evict(archive, ids[i]);
+    }
+  }
+  m6502_archive_stats_t stats;
+  m6502_archive_stats(archive, &stats);
+  m6502_archive_destroy(archive);
+  if (stats.states != 0 || stats.chunks != 0) {
+    fprintf(stderr, "Error: %zu chunks left after evicting everything\n",
+            stats.chunks);
+    return 1;
+  }
+  return 0;
+}
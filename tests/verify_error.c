@@ -0,0 +1,72 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../headers/verify.h"
+
+/* a rom that counts down for a few frames and then runs into a jam opcode
+ * partway through a frame, the recording stops there and every
+ * segment, the one that ends in the error too, has to verify */
+
+#define FRAMES 10
+#define PRG_SIZE 0x4000
+
+static const uint8_t program[] = {
+    0xa0, 0x46, /* ldy #70 */
+    0xa2, 0x00, /* ldx #0 */
+    0xca,       /* dex */
+    0xd0, 0xfd, /* bne dex */
+    0x88,       /* dey */
+    0xd0, 0xf8, /* bne ldx */
+    0x02,       /* jam, halts the cpu */
+};
+
+static bool write_rom(int fd) {
+  static uint8_t rom[16 + PRG_SIZE];
+  memcpy(rom, "NES\x1a\x01", 5);
+  memcpy(rom + 16, program, sizeof(program));
+  rom[16 + PRG_SIZE - 4] = 0x00; /* reset vector, $c000 */
+  rom[16 + PRG_SIZE - 3] = 0xc0;
+  return write(fd, rom, sizeof(rom)) == (ssize_t)sizeof(rom);
+}
+
+int main(void) {
+  char path[] = "verify_error_XXXXXX";
+  int fd = mkstemp(path);
+  if (fd == -1 || !write_rom(fd)) {
+    fprintf(stderr, "Error: could not write the test rom\n");
+    return 1;
+  }
+  close(fd);
+  processor_t *recorder = m6502_create_headless(path);
+  processor_t *model = m6502_create_headless(path);
+  remove(path);
+  if (recorder == NULL || model == NULL) {
+    fprintf(stderr, "Error: could not load the test rom\n");
+    return 1;
+  }
+
+  m6502_checkpoints_t checkpoints;
+  if (!m6502_record_checkpoints(recorder, NULL, 0, FRAMES, 1, &checkpoints)) {
+    fprintf(stderr, "Error: could not record the checkpoints\n");
+    return 1;
+  }
+  const m6502_snapshot_t *last = &checkpoints.snapshots[checkpoints.count - 1];
+  if (last->error != HALTED || last->frame >= FRAMES) {
+    fprintf(stderr, "Error: the recording did not stop on the jam\n");
+    return 1;
+  }
+
+  size_t mismatches = m6502_verify_checkpoints(model, &checkpoints, NULL, 0,
+                                               1, NULL);
+  m6502_free_checkpoints(&checkpoints);
+  m6502_destroy(recorder);
+  m6502_destroy(model);
+  if (mismatches != 0) {
+    fprintf(stderr, "Error: %zu segments did not verify\n", mismatches);
+    return 1;
+  }
+  return 0;
+}